@@ -0,0 +1,119 @@
+#include "AllocationTracker.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifdef _DEBUG
+#include <crtdbg.h>
+#endif
+
+static std::atomic<bool> tracking(false);
+static thread_local AllocationCount threadTotals;
+
+AllocationTracker::Scope::Scope() : start(current()) {}
+
+AllocationCount AllocationTracker::Scope::allocated() const {
+    AllocationCount now = current();
+    now.count -= start.count;
+    now.bytes -= start.bytes;
+    return now;
+}
+
+#ifdef _DEBUG
+// The debug CRT reports every block it hands out, whoever asked for it
+static int CountCrtAllocation(int type, void*, std::size_t size, int blockType, long, const unsigned char*, int) {
+    if (type != _HOOK_FREE && blockType != _CRT_BLOCK) // _CRT_BLOCK is the runtime's own bookkeeping
+        AllocationTracker::note(size);
+    return 1;
+}
+#endif
+
+void AllocationTracker::setEnabled(bool enabled) {
+#ifdef _DEBUG
+    if (enabled)
+        _CrtSetAllocHook(CountCrtAllocation);
+#endif
+    tracking.store(enabled, std::memory_order_relaxed);
+}
+
+bool AllocationTracker::isEnabled() {
+    return tracking.load(std::memory_order_relaxed);
+}
+
+AllocationCount AllocationTracker::current() {
+    return threadTotals;
+}
+
+void AllocationTracker::note(std::size_t bytes) {
+    if (!tracking.load(std::memory_order_relaxed))
+        return;
+    ++threadTotals.count;
+    threadTotals.bytes += bytes;
+}
+
+#ifndef _DEBUG
+// Replacement global allocation functions. Every form of new funnels through
+// Allocate and every form of delete through std::free, so the pairs always match.
+static void* Allocate(std::size_t size) {
+    AllocationTracker::note(size);
+    if (size == 0)
+        size = 1;
+    for (;;) {
+        if (void* memory = std::malloc(size))
+            return memory;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* operator new(std::size_t size) {
+    return Allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return Allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return Allocate(size);
+    }
+    catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return Allocate(size);
+    }
+    catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+#endif
@@ -0,0 +1,37 @@
+#ifndef ALLOCATIONTRACKER_H
+#define ALLOCATIONTRACKER_H
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+
+// Heap allocations made and the bytes asked for
+struct AllocationCount {
+    sf::Uint64 count = 0;
+    sf::Uint64 bytes = 0;
+};
+
+// Opt-in count of heap allocations, per thread, so a simulation tick is never
+// charged for what the render thread does. Release builds replace the global
+// operator new to count, so they see only new: malloc and SFML's own
+// allocations go uncounted. Debug builds install a CRT allocation hook, which
+// sees those too. While tracking is off an allocation costs one extra relaxed
+// load.
+class AllocationTracker {
+public:
+    // Allocations on this thread since the scope was opened
+    class Scope {
+    public:
+        Scope();
+        AllocationCount allocated() const;
+
+    private:
+        AllocationCount start;
+    };
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+    static AllocationCount current();  // This thread's totals while tracking was on
+    static void note(std::size_t bytes);
+};
+
+#endif // ALLOCATIONTRACKER_H
@@ -0,0 +1,124 @@
+#include "Animation.h"
+#include <algorithm>
+#include <cmath>
+
+const float PI = 3.14159265f;
+
+const float PLAYER_HURT_DURATION = 1.0f;
+const float PLAYER_HURT_PULSE = 10.0f;      // Radians per second
+const float ENEMY_HIT_DURATION = 0.2f;
+const float ENEMY_TELEGRAPH_PERIOD = 0.25f; // One throb; loops for as long as the wind-up lasts
+const float ENEMY_DEATH_DURATION = 0.5f;
+
+// std::min takes these by reference, so they need a definition as well
+const int AnimationClip::SAMPLES;
+const int AnimationCurve::SAMPLES;
+
+void AnimationPose::apply(sf::Sprite& sprite, const sf::Vector2f& baseScale, float direction, float baseRotation) const {
+    if (frame.width != 0)
+        sprite.setTextureRect(frame);
+    sprite.setScale(direction * baseScale.x * scale.x, baseScale.y * scale.y);
+    sprite.setRotation(baseRotation + rotation);
+    sprite.setColor(color);
+}
+
+AnimationClip::AnimationClip(float duration, bool looping, AnimationPose (*shape)(float t), sf::Vector2i cellSize, int cellCount)
+    : duration(duration), samplesPerSecond(SAMPLES / duration), looping(looping) {
+    for (int i = 0; i <= SAMPLES; ++i) {
+        float t = static_cast<float>(i) / SAMPLES;
+        poses[i] = shape(t);
+        if (cellSize.x > 0) {
+            int cell = std::min(cellCount - 1, static_cast<int>(t * cellCount));
+            poses[i].frame = sf::IntRect(cell * cellSize.x, 0, cellSize.x, cellSize.y);
+        }
+    }
+}
+
+const AnimationPose& AnimationClip::at(float time) const {
+    int index = static_cast<int>(time * samplesPerSecond + 0.5f);
+    if (looping)
+        index %= SAMPLES;
+    return poses[std::max(0, std::min(SAMPLES, index))];
+}
+
+bool AnimationClip::isFinished(float time) const {
+    return !looping && time >= duration;
+}
+
+float AnimationClip::getDuration() const {
+    return duration;
+}
+
+AnimationCurve::AnimationCurve(float (*shape)(float t)) {
+    for (int i = 0; i <= SAMPLES; ++i)
+        values[i] = shape(static_cast<float>(i) / SAMPLES);
+}
+
+float AnimationCurve::at(float t) const {
+    float position = std::max(0.0f, std::min(1.0f, t)) * SAMPLES;
+    int index = std::min(SAMPLES - 1, static_cast<int>(position));
+    float blend = position - index;
+    return values[index] + (values[index + 1] - values[index]) * blend;
+}
+
+float AnimationCurve::looped(float t) const {
+    return at(t - std::floor(t));
+}
+
+// Pose shapes. These run only while the tables are built.
+static AnimationPose PlayerHurtShape(float t) {
+    float wave = std::sin(t * PLAYER_HURT_DURATION * PLAYER_HURT_PULSE);
+    float fade = 0.5f + 0.5f * wave;
+    AnimationPose pose;
+    pose.color = sf::Color(255, static_cast<sf::Uint8>(255 * (1.0f - fade)), static_cast<sf::Uint8>(255 * (1.0f - fade)));
+    pose.scale = sf::Vector2f(1.0f, 1.0f) * (1.0f + 0.2f * wave);
+    return pose;
+}
+
+static AnimationPose EnemyHitShape(float t) {
+    // White-hot at the hit, easing back to normal
+    float intensity = 1.0f - t;
+    AnimationPose pose;
+    pose.color = sf::Color(255, static_cast<sf::Uint8>(255 - 155 * intensity), static_cast<sf::Uint8>(255 - 155 * intensity));
+    return pose;
+}
+
+static AnimationPose EnemyTelegraphShape(float t) {
+    float throb = 0.5f - 0.5f * std::cos(t * 2 * PI);
+    AnimationPose pose;
+    pose.color = sf::Color(255, static_cast<sf::Uint8>(200 - 60 * throb), static_cast<sf::Uint8>(200 - 60 * throb));
+    pose.scale = sf::Vector2f(1.0f + 0.05f * throb, 1.0f - 0.05f * throb);
+    return pose;
+}
+
+static AnimationPose EnemyDeathShape(float t) {
+    AnimationPose pose;
+    pose.color = sf::Color(255, 255, 255, static_cast<sf::Uint8>(255 * (1.0f - t)));
+    pose.scale = sf::Vector2f(1.0f, 1.0f) * (1.0f - 0.3f * t);
+    return pose;
+}
+
+const AnimationClip& GetClip(Clip clip) {
+    static const AnimationClip clips[] = {
+        AnimationClip(PLAYER_HURT_DURATION, false, PlayerHurtShape),
+        AnimationClip(ENEMY_HIT_DURATION, false, EnemyHitShape),
+        AnimationClip(ENEMY_TELEGRAPH_PERIOD, true, EnemyTelegraphShape),
+        AnimationClip(ENEMY_DEATH_DURATION, false, EnemyDeathShape)
+    };
+    static_assert(sizeof(clips) / sizeof(clips[0]) == static_cast<int>(Clip::Count), "Bake every clip");
+    return clips[static_cast<int>(clip)];
+}
+
+const AnimationCurve& GetCurve(Curve curve) {
+    static const AnimationCurve curves[] = {
+        AnimationCurve([](float t) { return std::sin(t * 2 * PI); }),
+        AnimationCurve([](float t) { return std::sin(t * PI); })
+    };
+    static_assert(sizeof(curves) / sizeof(curves[0]) == static_cast<int>(Curve::Count), "Bake every curve");
+    return curves[static_cast<int>(curve)];
+}
+
+const AnimationPose& RestPose() {
+    static const AnimationPose pose;
+    return pose;
+}
@@ -0,0 +1,78 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <SFML/Graphics.hpp>
+
+// How a sprite looks at one moment of an animation, on top of its base scale
+// and rotation
+struct AnimationPose {
+    sf::Vector2f scale{ 1.0f, 1.0f };
+    float rotation = 0.0f;
+    sf::Color color = sf::Color::White;
+    sf::IntRect frame;   // Sprite-sheet cell; empty leaves the texture rect alone
+
+    // direction is 1, or -1 to mirror the sprite horizontally
+    void apply(sf::Sprite& sprite, const sf::Vector2f& baseScale, float direction, float baseRotation) const;
+};
+
+// A pose track baked into a table when the clip is built. Playing it back is
+// one index into the table: no trig, no blending, whatever the clip does.
+class AnimationClip {
+public:
+    static const int SAMPLES = 128;
+
+    // shape gives the pose at t in [0, 1]. A sprite sheet is a strip of cellCount
+    // cells of cellSize, played evenly across the clip; a zero cellSize means no sheet.
+    AnimationClip(float duration, bool looping, AnimationPose (*shape)(float t),
+        sf::Vector2i cellSize = sf::Vector2i(0, 0), int cellCount = 1);
+
+    // Member functions
+    const AnimationPose& at(float time) const;
+    bool isFinished(float time) const;
+    float getDuration() const;
+
+private:
+    float duration;
+    float samplesPerSecond;
+    bool looping;
+    AnimationPose poses[SAMPLES + 1];  // One extra so the last sample lands exactly on the end
+};
+
+// A single value over t in [0, 1], baked the same way. Sampling interpolates
+// between neighbours, since these drive movement rather than looks.
+class AnimationCurve {
+public:
+    static const int SAMPLES = 256;
+
+    explicit AnimationCurve(float (*shape)(float t));
+
+    // Member functions
+    float at(float t) const;        // Clamped to [0, 1]
+    float looped(float t) const;    // Wraps, one cycle per unit of t
+
+private:
+    float values[SAMPLES + 1];
+};
+
+enum class Clip {
+    PlayerHurt,
+    EnemyHit,
+    EnemyTelegraph,
+    EnemyDeath,
+    Count
+};
+
+enum class Curve {
+    Hover,       // One sine cycle
+    HitBounce,   // Half a sine: up and back down
+    Count
+};
+
+// Every clip and curve is baked on first use and shared by all entities
+const AnimationClip& GetClip(Clip clip);
+const AnimationCurve& GetCurve(Curve curve);
+
+// The rest pose: no offset, untinted
+const AnimationPose& RestPose();
+
+#endif // ANIMATION_H
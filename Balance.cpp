@@ -0,0 +1,378 @@
+#include "Balance.h"
+#include "World.h"
+#include "Snapshot.h"
+#include "Particles.h"
+#include "Levels.cpp"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+
+const float SIM_STEP = 1.0f / 60.0f;   // Fixed tick, so a run plays the same on any machine
+const float ROOM_TIMEOUT = 60.0f;      // Seconds in one room before the bot is considered stuck
+const float ATTACK_RANGE = 150.0f;
+const float HOLD_DISTANCE = 90.0f;     // Bot stops closing in at this horizontal distance
+const float LOW_HEALTH = 5.0f;         // At or below this the bot shops for potions first
+
+sf::Texture& TextureManager(const std::string& texturePath);
+
+// Scripted player. Opens any chest in the room, fights the nearest enemy,
+// then walks out the right-hand side.
+struct BalanceBot {
+    float stuckTimer = 0.0f;
+    float lastX = 0.0f;
+
+    PlayerInput next(Player& player, std::vector<Enemy>& enemies, std::vector<Object>& objects, sf::Uint32 sequence) {
+        PlayerInput input;
+        input.sequence = sequence;
+
+        sf::Vector2f position = player.position();
+        sf::Vector2f target(WorldBounds().left + WorldBounds().width + 50, position.y);
+        bool fighting = false;
+
+        for (Object& object : objects) {
+            if (!object.isInteracted()) {
+                sf::FloatRect bounds = object.getBounds();
+                target = sf::Vector2f(bounds.left + bounds.width / 2, bounds.top + bounds.height / 2);
+                break;
+            }
+        }
+        if (objects.empty()) {
+            float nearest = 0.0f;
+            for (Enemy& enemy : enemies) {
+                if (!enemy.isAlive() || enemy.isDying())
+                    continue;
+                sf::FloatRect bounds = enemy.getBounds();
+                sf::Vector2f centre(bounds.left + bounds.width / 2, bounds.top + bounds.height / 2);
+                float distance = std::abs(centre.x - position.x) + std::abs(centre.y - position.y);
+                if (!fighting || distance < nearest) {
+                    nearest = distance;
+                    target = centre;
+                    fighting = true;
+                }
+            }
+        }
+
+        float dx = target.x - position.x;
+        float dy = target.y - position.y;
+        bool wantsToMove = !fighting || std::abs(dx) > HOLD_DISTANCE;
+        if (wantsToMove)
+            input.buttons |= dx > 0 ? PlayerInput::Right : PlayerInput::Left;
+        else if ((dx > 0) != player.facingRight)
+            input.buttons |= dx > 0 ? PlayerInput::Right : PlayerInput::Left; // Turn to face the target
+
+        if (fighting) {
+            if (std::abs(dx) + std::abs(dy) < ATTACK_RANGE)
+                input.buttons |= PlayerInput::Attack;
+            input.buttons |= PlayerInput::Throw;
+        }
+
+        // Jump towards targets above, or out of whatever is blocking the way
+        stuckTimer = (wantsToMove && std::abs(position.x - lastX) < 0.5f) ? stuckTimer + SIM_STEP : 0.0f;
+        lastX = position.x;
+        if (dy < -80.0f || stuckTimer > 0.5f)
+            input.buttons |= PlayerInput::Jump;
+        return input;
+    }
+};
+
+static void ScaleEnemies(std::vector<Enemy>& enemies, const BalanceConfig& config) {
+    EnemyState state;
+    for (Enemy& enemy : enemies) {
+        enemy.saveState(state);
+        state.health *= config.enemyHealthScale;
+        state.maxHealth *= config.enemyHealthScale;
+        state.speed *= config.enemySpeedScale;
+        enemy.loadState(state);
+    }
+}
+
+// Greedy shopper: potions when low, otherwise the most expensive thing it can afford
+static void Shop(Object& chest, Player& player, int& currency, BalanceReport& report) {
+    for (ItemId id : chest.stock())
+        ++report.itemsOffered[id];
+
+    for (;;) {
+        const std::vector<ItemId>& stock = chest.stock();
+        bool lowHealth = player.getHealth() <= LOW_HEALTH;
+        int choice = -1;
+        int bestScore = 0;
+        for (size_t i = 0; i < stock.size(); ++i) {
+            const Item& item = GetItem(stock[i]);
+            bool potion = item.getHealth() > 0;
+            if (item.getPrice() > currency || (potion && !lowHealth))
+                continue;
+            int score = item.getPrice() + (potion ? 1000 : 0);
+            if (choice < 0 || score > bestScore) {
+                choice = static_cast<int>(i);
+                bestScore = score;
+            }
+        }
+        if (choice < 0)
+            break;
+
+        ItemId id = stock[choice];
+        if (!chest.buy(choice, player, currency))
+            break;
+        ++report.itemsBought[id];
+    }
+    chest.close();
+}
+
+static void UpdateHorde(std::vector<Enemy>& enemies, Level& level, ProjectilePool& projectiles, Player& player, int& currency) {
+    level.flowField.setTarget(player.position());
+    level.navGraph.setGoal(player.position() + sf::Vector2f(0, player.getBounds().height / 2));
+    Enemy* enemyData = enemies.data();
+    for (size_t first = 0; first < enemies.size();) {
+        size_t last = first + 1;
+        while (last < enemies.size() && enemies[last].archetype() == enemies[first].archetype())
+            ++last;
+
+        switch (enemies[first].archetype()) {
+        case EnemyArchetype::Walker:
+            Enemy::updateGroup<WalkerBehaviour>(enemyData + first, enemyData + last, SIM_STEP, level.terrain,
+                level.flowField, level.navGraph, projectiles, player.position(), currency);
+            break;
+        case EnemyArchetype::Flyer:
+            Enemy::updateGroup<FlyerBehaviour>(enemyData + first, enemyData + last, SIM_STEP, level.terrain,
+                level.flowField, level.navGraph, projectiles, player.position(), currency);
+            break;
+        case EnemyArchetype::Charger:
+            Enemy::updateGroup<ChargerBehaviour>(enemyData + first, enemyData + last, SIM_STEP, level.terrain,
+                level.flowField, level.navGraph, projectiles, player.position(), currency);
+            break;
+        }
+        first = last;
+    }
+}
+
+// One game from room 0 until the player dies, survives maxRunTime or gets stuck.
+// Mirrors LevelManager and enforceBounds, without drawing.
+static void PlayRun(int run, const BalanceConfig& config, Player& player, const PlayerState& freshPlayer,
+    ProjectilePool& projectiles, BalanceReport& report) {
+    SeedGameRandom(config.seed + run); // Per thread, like the runs
+    player.clearItems();
+    player.loadState(freshPlayer);
+    projectiles.clear();
+
+    int levelNumber = 0;
+    bool loadRoom = true;
+    Level level(levelNumber, SCREEN_WIDTH, SCREEN_HEIGHT);
+    std::vector<Enemy> enemies;
+    std::vector<Object> objects;
+    int currency = 0;
+    float time = 0.0f;
+    float roomTime = 0.0f;
+    size_t bucket = 0;
+    BalanceBot bot;
+    sf::Uint32 sequence = 0;
+
+    for (;;) {
+        if (loadRoom) {
+            level = Level(levelNumber, SCREEN_WIDTH, SCREEN_HEIGHT);
+            WorldBounds() = level.bounds;
+            player.SetPosition(level.spawnPosition);
+            level.populate(enemies, objects, SCREEN_WIDTH, SCREEN_HEIGHT);
+            ScaleEnemies(enemies, config);
+            GroupByArchetype(enemies);
+            projectiles.clear();
+            roomTime = 0.0f;
+            loadRoom = false;
+        }
+
+        // Sample the currency curve on bucket boundaries
+        if (bucket < report.aliveCounts.size() && time >= bucket * BalanceReport::BUCKET_SECONDS) {
+            ++report.aliveCounts[bucket];
+            report.currencyTotals[bucket] += currency;
+            ++bucket;
+        }
+
+        if (player.getHealth() <= 0) {
+            ++report.deathsByLevel[std::min(std::max(levelNumber, 0), BalanceReport::LEVEL_COUNT - 1)];
+            break;
+        }
+        if (time >= config.maxRunTime) {
+            ++report.survived;
+            break;
+        }
+        if (roomTime >= ROOM_TIMEOUT) {
+            ++report.stalled;
+            break;
+        }
+
+        if (level.updateStream(player.position(), enemies))
+            GroupByArchetype(enemies);
+
+        PlayerInput input = bot.next(player, enemies, objects, ++sequence);
+        player.update(SIM_STEP, level.terrain, input);
+        player.handleCollision(enemies, SIM_STEP);
+        player.throwProjectiles(projectiles, SIM_STEP, input);
+
+        for (Object& object : objects) {
+            if (!object.isInteracted() && player.getBounds().intersects(object.getBounds()))
+                Shop(object, player, currency, report);
+        }
+
+        UpdateHorde(enemies, level, projectiles, player, currency);
+        projectiles.update(SIM_STEP);
+        projectiles.resolveCollisions(enemies, level.terrain, player);
+        Particles().clear(); // Nothing is drawn, don't let effects pile up
+
+        enemies.erase(std::remove_if(enemies.begin(), enemies.end(), [](Enemy& enemy) {
+            return !enemy.isAlive();
+            }), enemies.end());
+        objects.erase(std::remove_if(objects.begin(), objects.end(), [](Object& object) {
+            return object.isInteracted();
+            }), objects.end());
+
+        // Room exits and falls, as in enforceBounds
+        sf::Vector2f position = player.position();
+        float right = level.bounds.left + level.bounds.width;
+        if (position.x > right) {
+            if (enemies.empty()) {
+                levelNumber = NextLevelNumber();
+                loadRoom = true;
+                ++report.roomsCleared;
+            }
+            else {
+                position.x = right;
+                player.SetPosition(position);
+            }
+        }
+        if (position.x < level.bounds.left) {
+            position.x = level.bounds.left;
+            player.SetPosition(position);
+        }
+        if (position.y > level.bounds.top + level.bounds.height) {
+            player.ChangeHealth(-1);
+            sf::Vector2f respawn = level.respawnPosition(position);
+            player.SetPosition(respawn);
+        }
+
+        time += SIM_STEP;
+        roomTime += SIM_STEP;
+    }
+
+    ++report.runs;
+    report.survivalTimes.push_back(time);
+}
+
+static void ResetReport(BalanceReport& report, const BalanceConfig& config) {
+    size_t buckets = static_cast<size_t>(config.maxRunTime / BalanceReport::BUCKET_SECONDS) + 1;
+    report.currencyTotals.assign(buckets, 0.0);
+    report.aliveCounts.assign(buckets, 0);
+    report.itemsOffered.assign(ItemCatalog().size(), 0);
+    report.itemsBought.assign(ItemCatalog().size(), 0);
+}
+
+// Pulls run numbers until none are left. Everything a run touches is owned by
+// this worker, so workers share nothing but the run counter.
+static void BalanceWorker(const BalanceConfig& config, sf::Texture& playerTexture, sf::Texture& weaponTexture,
+    std::atomic<int>& nextRun, BalanceReport& report) {
+    ResetReport(report, config);
+    report.survivalTimes.reserve(config.runs);
+
+    std::unique_ptr<ProjectilePool> projectiles(new ProjectilePool()); // Large, keep it off the stack
+    Player player(sf::Vector2f(0, 0), playerTexture, weaponTexture, config.playerSpeed);
+    PlayerState freshPlayer;
+    player.saveState(freshPlayer);
+
+    for (int run = nextRun++; run < config.runs; run = nextRun++)
+        PlayRun(run, config, player, freshPlayer, *projectiles, report);
+}
+
+static float Percentile(const std::vector<float>& sorted, float fraction) {
+    if (sorted.empty())
+        return 0.0f;
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5f);
+    return sorted[index];
+}
+
+void BalanceReport::merge(const BalanceReport& other) {
+    runs += other.runs;
+    survived += other.survived;
+    stalled += other.stalled;
+    roomsCleared += other.roomsCleared;
+    survivalTimes.insert(survivalTimes.end(), other.survivalTimes.begin(), other.survivalTimes.end());
+    for (int i = 0; i < LEVEL_COUNT; ++i)
+        deathsByLevel[i] += other.deathsByLevel[i];
+    for (size_t i = 0; i < currencyTotals.size() && i < other.currencyTotals.size(); ++i) {
+        currencyTotals[i] += other.currencyTotals[i];
+        aliveCounts[i] += other.aliveCounts[i];
+    }
+    for (size_t i = 0; i < itemsOffered.size() && i < other.itemsOffered.size(); ++i) {
+        itemsOffered[i] += other.itemsOffered[i];
+        itemsBought[i] += other.itemsBought[i];
+    }
+}
+
+void BalanceReport::write(std::ostream& out) const {
+    std::vector<float> sorted = survivalTimes;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (float time : sorted)
+        total += time;
+
+    out << std::fixed << std::setprecision(1);
+    out << "Runs: " << runs << " in " << wallSeconds << " s (" << (wallSeconds > 0 ? runs / wallSeconds : 0.0) << " runs/s)\n";
+    out << "Survived: " << survived << ", stalled: " << stalled << "\n";
+    out << "Survival time (s): mean " << (runs ? total / runs : 0.0) << ", p10 " << Percentile(sorted, 0.1f)
+        << ", median " << Percentile(sorted, 0.5f) << ", p90 " << Percentile(sorted, 0.9f) << "\n";
+    out << "Rooms cleared per run: " << (runs ? static_cast<double>(roomsCleared) / runs : 0.0) << "\n";
+
+    out << "\nDeaths by level:\n";
+    for (int i = 0; i < LEVEL_COUNT; ++i) {
+        if (deathsByLevel[i])
+            out << "  " << std::setw(2) << i << ": " << deathsByLevel[i] << "\n";
+    }
+
+    out << "\nCurrency curve (time, % alive, mean currency of the living):\n";
+    for (size_t i = 0; i < aliveCounts.size(); ++i) {
+        out << "  " << std::setw(4) << i * BUCKET_SECONDS << " s  " << std::setw(5)
+            << (runs ? 100.0 * aliveCounts[i] / runs : 0.0) << "%  "
+            << (aliveCounts[i] ? currencyTotals[i] / aliveCounts[i] : 0.0) << "\n";
+    }
+
+    out << "\nItems (offered, bought, pick rate):\n";
+    const std::vector<Item>& catalog = ItemCatalog();
+    for (size_t i = 0; i < itemsOffered.size() && i < catalog.size(); ++i) {
+        out << "  " << std::left << std::setw(22) << catalog[i].getName() << std::right << std::setw(8) << itemsOffered[i]
+            << std::setw(8) << itemsBought[i] << std::setw(7)
+            << (itemsOffered[i] ? 100.0 * itemsBought[i] / itemsOffered[i] : 0.0) << "%\n";
+    }
+}
+
+BalanceReport RunBalanceSweep(const BalanceConfig& config) {
+    // Every texture a run can touch is loaded here, so workers only ever read the cache
+    sf::Texture& playerTexture = TextureManager("Textures/Player.png");
+    sf::Texture& weaponTexture = TextureManager("Textures/Weapon1.png");
+    TextureManager("Textures/Chest.png");
+    for (int id = 0; id < ENEMY_TEXTURE_COUNT; ++id)
+        EnemyTexture(id);
+
+    int threadCount = config.threads > 0 ? config.threads : static_cast<int>(std::thread::hardware_concurrency());
+    threadCount = std::max(1, std::min(threadCount, config.runs));
+
+    std::atomic<int> nextRun(0);
+    std::vector<BalanceReport> partials(threadCount);
+    std::vector<std::thread> workers;
+    sf::Clock clock;
+    for (int i = 0; i < threadCount; ++i) {
+        workers.push_back(std::thread(BalanceWorker, std::cref(config), std::ref(playerTexture), std::ref(weaponTexture),
+            std::ref(nextRun), std::ref(partials[i])));
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+
+    BalanceReport report;
+    ResetReport(report, config);
+    report.survivalTimes.reserve(config.runs);
+    for (const BalanceReport& partial : partials)
+        report.merge(partial);
+    report.wallSeconds = clock.getElapsedTime().asSeconds();
+    return report;
+}
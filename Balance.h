@@ -0,0 +1,45 @@
+#ifndef BALANCE_H
+#define BALANCE_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+// What to sweep. The scales are applied to every enemy as its room spawns.
+struct BalanceConfig {
+    int runs = 10000;
+    int threads = 0;                  // 0 uses every hardware thread
+    unsigned int seed = 1;            // Run i seeds GameRandom with seed + i
+    float maxRunTime = 300.0f;        // Game seconds before a run counts as survived
+    float enemyHealthScale = 1.0f;
+    float enemySpeedScale = 1.0f;
+    float playerSpeed = 500.0f;
+    std::string reportPath = "balance_report.txt";
+};
+
+// Totals over a batch of runs. Each worker fills its own, merged once at the end.
+struct BalanceReport {
+    static const int BUCKET_SECONDS = 10;  // Width of the currency curve buckets
+    static const int LEVEL_COUNT = 12;
+
+    int runs = 0;
+    int survived = 0;                 // Still alive at maxRunTime
+    int stalled = 0;                  // Bot got stuck in a room and the run was cut short
+    long long roomsCleared = 0;
+    std::vector<float> survivalTimes;
+    int deathsByLevel[LEVEL_COUNT] = {};
+    std::vector<double> currencyTotals;  // Summed currency of the runs alive at each bucket
+    std::vector<int> aliveCounts;        // Runs alive at each bucket
+    std::vector<int> itemsOffered;       // By ItemCatalog index
+    std::vector<int> itemsBought;
+    double wallSeconds = 0.0;
+
+    void merge(const BalanceReport& other);
+    void write(std::ostream& out) const;
+};
+
+// Plays config.runs headless games with a scripted bot, spread over worker threads.
+// Textures are loaded on the calling thread first; workers never touch GL.
+BalanceReport RunBalanceSweep(const BalanceConfig& config);
+
+#endif // BALANCE_H
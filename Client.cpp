@@ -0,0 +1,335 @@
+#include "Client.h"
+#include "World.h"
+#include "Snapshot.h"
+#include "Levels.cpp"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+
+const float HELLO_INTERVAL = 0.5f;
+
+sf::Texture& TextureManager(const std::string& texturePath);
+
+GameClient::GameClient(float playerSpeed)
+    : serverPort(0), playerSpeed(playerSpeed), connected(false), slot(-1), helloTimer(0.0f),
+    inputSequence(0), latestTick(0), assembling(false), pendingLastInput(0), pendingReceived(0),
+    pendingSelf(), pendingHasSelf(false), bot(false), botSeed(1), botTimer(0.0f), botButtons(0) {}
+
+bool GameClient::connect(const sf::IpAddress& address, unsigned short port) {
+    if (socket.bind(sf::Socket::AnyPort) != sf::Socket::Done)
+        return false;
+    socket.setBlocking(false);
+    serverAddress = address;
+    serverPort = port;
+    helloTimer = 0.0f; // Say hello on the first tick
+    return true;
+}
+
+void GameClient::disconnect() {
+    if (!connected)
+        return;
+    outgoing.clear();
+    outgoing.write(NET_PROTOCOL_ID);
+    outgoing.write(NetMessage::Bye);
+    socket.send(outgoing.bytes.data(), outgoing.size(), serverAddress, serverPort);
+    connected = false;
+}
+
+void GameClient::setBot(sf::Uint32 seed) {
+    bot = true;
+    botSeed = seed ? seed : 1;
+}
+
+void GameClient::tick() {
+    receive();
+
+    if (!connected) {
+        helloTimer -= NET_TICK;
+        if (helloTimer <= 0.0f) {
+            helloTimer = HELLO_INTERVAL;
+            outgoing.clear();
+            outgoing.write(NET_PROTOCOL_ID);
+            outgoing.write(NetMessage::Hello);
+            socket.send(outgoing.bytes.data(), outgoing.size(), serverAddress, serverPort);
+        }
+        return;
+    }
+
+    // Predict: run this tick's input locally straight away, then tell the server
+    PlayerInput input = sampleInput();
+    input.sequence = ++inputSequence;
+    inputs[input.sequence % INPUT_HISTORY] = input;
+    NetStepPlayer(*player, terrain, noEnemies, input, SCREEN_WIDTH);
+    sendInput();
+}
+
+void GameClient::receive() {
+    sf::IpAddress address;
+    unsigned short port;
+    std::size_t received;
+    while (true) {
+        incoming.bytes.resize(NET_MAX_PACKET);
+        if (socket.receive(incoming.bytes.data(), incoming.bytes.size(), received, address, port) != sf::Socket::Done)
+            break;
+        if (port != serverPort || address != serverAddress)
+            continue;
+        incoming.bytes.resize(received);
+        incoming.cursor = 0;
+        counters.bytesReceived += received;
+
+        sf::Uint32 protocol;
+        NetMessage message;
+        if (!incoming.read(protocol) || protocol != NET_PROTOCOL_ID || !incoming.read(message))
+            continue;
+
+        if (message == NetMessage::Welcome)
+            handleWelcome(incoming);
+        else if (message == NetMessage::State && connected)
+            handleState(incoming);
+    }
+}
+
+void GameClient::handleWelcome(NetBuffer& packet) {
+    sf::Uint8 assignedSlot;
+    sf::Int32 levelNumber;
+    sf::Uint32 serverTick;
+    if (connected || !packet.read(assignedSlot) || !packet.read(levelNumber) || !packet.read(serverTick))
+        return;
+
+    Level arena(levelNumber, SCREEN_WIDTH, SCREEN_HEIGHT);
+    grounds = arena.grounds;
+    terrain = arena.terrain;
+    player.reset(new Player(NetSpawnPosition(arena.spawnPosition, assignedSlot), TextureManager("Textures/Player.png"),
+        TextureManager("Textures/Weapon1.png"), playerSpeed));
+    slot = assignedSlot;
+    latestTick = 0;
+    connected = true;
+}
+
+void GameClient::handleState(NetBuffer& packet) {
+    sf::Uint32 tick;
+    sf::Uint32 baselineTick;
+    sf::Uint32 lastInput;
+    sf::Uint8 index;
+    sf::Uint8 count;
+    if (!packet.read(tick) || !packet.read(baselineTick) || !packet.read(lastInput) ||
+        !packet.read(index) || !packet.read(count) || index >= count)
+        return;
+    if (tick <= latestTick || (assembling && tick < pending.tick))
+        return; // Older than what we already have
+
+    if (!assembling || tick != pending.tick) {
+        // First fragment of a newer frame: start from its baseline, dropping any half-built frame
+        const NetFrame* baseline = nullptr;
+        if (baselineTick != 0) {
+            baseline = frameAt(baselineTick);
+            if (!baseline)
+                return; // Can't decode; the server falls back to a full frame once our ack ages out
+        }
+        pending.tick = tick;
+        if (baseline)
+            pending.entities = baseline->entities;
+        else
+            pending.entities.clear();
+        pending.projectiles.clear();
+        pendingFragments.assign(count, false);
+        pendingReceived = 0;
+        pendingLastInput = lastInput;
+        pendingHasSelf = false;
+        assembling = true;
+    }
+    if (index >= pendingFragments.size() || pendingFragments[index])
+        return;
+    pendingFragments[index] = true;
+    ++pendingReceived;
+
+    // Fragments touch disjoint entities, so they can be applied in any order
+    while (!packet.atEnd()) {
+        NetEntry entry;
+        bool ok = packet.read(entry);
+        if (ok && entry == NetEntry::Self) {
+            ok = packet.read(pendingSelf);
+            pendingHasSelf = ok;
+        }
+        else if (ok && entry == NetEntry::Entity) {
+            ok = ReadEntityDelta(packet, pending);
+        }
+        else if (ok && entry == NetEntry::Projectiles) {
+            sf::Uint8 projectileCount;
+            ok = packet.read(projectileCount);
+            for (int i = 0; ok && i < projectileCount; ++i) {
+                NetProjectile projectile;
+                ok = packet.read(projectile.x) && packet.read(projectile.y) &&
+                    packet.read(projectile.velocityX) && packet.read(projectile.velocityY) &&
+                    packet.read(projectile.owner);
+                if (ok)
+                    pending.projectiles.push_back(projectile);
+            }
+        }
+        else {
+            ok = false;
+        }
+
+        if (!ok) {
+            assembling = false; // Corrupt fragment, wait for the next frame
+            return;
+        }
+    }
+
+    if (pendingReceived == static_cast<int>(pendingFragments.size()))
+        completeFrame();
+}
+
+void GameClient::completeFrame() {
+    NetFrame& frame = frames[pending.tick % NET_HISTORY];
+    frame.tick = pending.tick;
+    frame.entities = pending.entities;       // Copy-assign keeps the slot's capacity
+    frame.projectiles = pending.projectiles;
+    latestTick = pending.tick;
+    assembling = false;
+    counters.framesCompleted++;
+
+    if (pendingHasSelf)
+        reconcile();
+}
+
+void GameClient::reconcile() {
+    sf::Vector2f predicted = player->position();
+
+    // Rewind to the server's state after its last processed input, then replay
+    // every input it hasn't seen yet
+    player->loadState(pendingSelf);
+    sf::Uint32 first = pendingLastInput + 1;
+    if (inputSequence >= INPUT_HISTORY && first <= inputSequence - INPUT_HISTORY)
+        first = inputSequence - INPUT_HISTORY + 1;
+    for (sf::Uint32 sequence = first; sequence <= inputSequence; ++sequence)
+        NetStepPlayer(*player, terrain, noEnemies, inputs[sequence % INPUT_HISTORY], SCREEN_WIDTH);
+
+    // A state that arrives before anything was predicted only places the player
+    sf::Vector2f offset = player->position() - predicted;
+    float correction = std::sqrt(offset.x * offset.x + offset.y * offset.y);
+    if (inputSequence > 0 && correction > 0.01f) {
+        counters.corrections++;
+        counters.totalCorrection += correction;
+        counters.maxCorrection = std::max(counters.maxCorrection, correction);
+    }
+}
+
+void GameClient::sendInput() {
+    // Repeat the last few inputs so a lost packet costs nothing
+    sf::Uint32 count = std::min<sf::Uint32>(NET_INPUT_REDUNDANCY, inputSequence);
+    sf::Uint32 first = inputSequence - count + 1;
+
+    outgoing.clear();
+    outgoing.write(NET_PROTOCOL_ID);
+    outgoing.write(NetMessage::Input);
+    outgoing.write(latestTick);
+    outgoing.write(first);
+    outgoing.write(static_cast<sf::Uint8>(count));
+    for (sf::Uint32 sequence = first; sequence <= inputSequence; ++sequence)
+        outgoing.write(inputs[sequence % INPUT_HISTORY].buttons);
+    socket.send(outgoing.bytes.data(), outgoing.size(), serverAddress, serverPort);
+}
+
+PlayerInput GameClient::sampleInput() {
+    if (!bot)
+        return PlayerInput::poll(0);
+
+    // Bots hold a random set of buttons for a random fraction of a second
+    botTimer -= NET_TICK;
+    if (botTimer <= 0.0f) {
+        botSeed ^= botSeed << 13;
+        botSeed ^= botSeed >> 17;
+        botSeed ^= botSeed << 5;
+        sf::Uint32 roll = botSeed;
+        botButtons = 0;
+        switch (roll % 3) {
+        case 0: botButtons |= PlayerInput::Left; break;
+        case 1: botButtons |= PlayerInput::Right; break;
+        default: break;
+        }
+        if ((roll >> 2) % 10 < 3) botButtons |= PlayerInput::Jump;
+        if ((roll >> 6) % 10 < 1) botButtons |= PlayerInput::Dash;
+        if ((roll >> 10) % 10 < 6) botButtons |= PlayerInput::Attack;
+        if ((roll >> 14) % 10 < 4) botButtons |= PlayerInput::Throw;
+        botTimer = 0.3f + ((roll >> 18) % 10) * 0.1f;
+    }
+
+    PlayerInput input;
+    input.buttons = botButtons;
+    return input;
+}
+
+void GameClient::draw(sf::RenderWindow& window) {
+    window.clear(sf::Color(18, 32, 32));
+    if (!connected) {
+        window.display();
+        return;
+    }
+
+    renderQueue.begin(window.getView());
+    for (Ground& ground : grounds)
+        ground.draw(renderQueue);
+
+    const NetFrame* frame = frameAt(latestTick);
+    if (frame) {
+        sprites.resize(frame->entities.size());
+        for (size_t i = 0; i < frame->entities.size(); ++i) {
+            const NetEntity& entity = frame->entities[i];
+            if (entity.id == slot)
+                continue; // Drawn from the prediction instead
+
+            sf::Sprite& sprite = sprites[i];
+            bool facingRight = (entity.flags & NET_FACING_RIGHT) != 0;
+            if (entity.id < NET_MAX_CLIENTS) {
+                sprite.setTexture(TextureManager("Textures/Player.png"), true);
+                sprite.setScale(facingRight ? 1.0f : -1.0f, 1.0f);
+                sprite.setColor(entity.health ? sf::Color::White : sf::Color(255, 255, 255, 80));
+            }
+            else {
+                sprite.setTexture(EnemyTexture((entity.flags >> NET_TEXTURE_SHIFT) & 3), true);
+                sprite.setScale(facingRight ? -1.0f : 1.0f, 1.0f);
+                sprite.setColor((entity.flags & NET_DYING) ? sf::Color(255, 255, 255, 100) : sf::Color::White);
+            }
+            sf::FloatRect bounds = sprite.getLocalBounds();
+            sprite.setOrigin(bounds.width / 2, bounds.height / 2);
+            sprite.setPosition(DequantizePosition(entity.x), DequantizePosition(entity.y));
+            renderQueue.submit(entity.id < NET_MAX_CLIENTS ? RenderLayer::Player : RenderLayer::Enemies, sprite);
+        }
+
+        // All projectiles in one draw call
+        projectileVertices.resize(frame->projectiles.size() * 4);
+        for (size_t i = 0; i < frame->projectiles.size(); ++i) {
+            const NetProjectile& projectile = frame->projectiles[i];
+            float x = DequantizePosition(projectile.x);
+            float y = DequantizePosition(projectile.y);
+            float half = projectile.owner == static_cast<sf::Uint8>(ProjectileOwner::Player) ? 7.0f : 5.0f;
+            sf::Color color = projectile.owner == static_cast<sf::Uint8>(ProjectileOwner::Player) ?
+                sf::Color(200, 200, 220) : sf::Color(255, 90, 60);
+            sf::Vertex* quad = &projectileVertices[i * 4];
+            quad[0] = sf::Vertex(sf::Vector2f(x - half, y - half), color);
+            quad[1] = sf::Vertex(sf::Vector2f(x + half, y - half), color);
+            quad[2] = sf::Vertex(sf::Vector2f(x + half, y + half), color);
+            quad[3] = sf::Vertex(sf::Vector2f(x - half, y + half), color);
+        }
+        renderQueue.submit(RenderLayer::Projectiles, projectileVertices.data(), projectileVertices.size(), sf::Quads);
+    }
+
+    player->draw(renderQueue);
+    renderQueue.flush(window);
+    hud.drawStats(window, player->getStatsSummary());
+    window.display();
+}
+
+const NetFrame* GameClient::frameAt(sf::Uint32 tick) const {
+    const NetFrame& frame = frames[tick % NET_HISTORY];
+    return tick != 0 && frame.tick == tick ? &frame : nullptr;
+}
+
+bool GameClient::isConnected() const {
+    return connected;
+}
+
+ClientStats& GameClient::stats() {
+    return counters;
+}
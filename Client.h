@@ -0,0 +1,98 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Network.hpp>
+#include <vector>
+#include <memory>
+#include "NetProtocol.h"
+#include "RenderQueue.h"
+#include "Hud.h"
+
+// Running totals a host can print and reset
+struct ClientStats {
+    int framesCompleted = 0;
+    int corrections = 0;          // Reconciliations that moved the predicted player
+    float totalCorrection = 0.0f; // Pixels
+    float maxCorrection = 0.0f;
+    size_t bytesReceived = 0;
+};
+
+// Connects to a GameServer. The local player is predicted every tick from
+// local input and corrected when the server's state for that input arrives;
+// everything else is drawn straight from the newest complete frame. A bot
+// client makes up its own input and never needs a window.
+class GameClient {
+public:
+    static const int INPUT_HISTORY = 128;  // Inputs kept for replay after a correction
+
+    explicit GameClient(float playerSpeed);
+
+    // Member functions
+    bool connect(const sf::IpAddress& address, unsigned short port);
+    void disconnect();
+    void setBot(sf::Uint32 seed);
+    void tick();
+    void draw(sf::RenderWindow& window);
+
+    bool isConnected() const;
+    ClientStats& stats();
+
+private:
+    void receive();
+    void handleWelcome(NetBuffer& packet);
+    void handleState(NetBuffer& packet);
+    void completeFrame();
+    void reconcile();
+    void sendInput();
+    PlayerInput sampleInput();
+    const NetFrame* frameAt(sf::Uint32 tick) const;
+
+    sf::UdpSocket socket;
+    sf::IpAddress serverAddress;
+    unsigned short serverPort;
+    float playerSpeed;
+    bool connected;
+    int slot;
+    float helloTimer;
+
+    // Prediction
+    std::vector<Ground> grounds;           // Drawn
+    Terrain terrain;                       // Collided with
+    std::unique_ptr<Player> player;
+    std::vector<Enemy> noEnemies;          // Combat is left to the server
+    PlayerInput inputs[INPUT_HISTORY];     // Ring by sequence
+    sf::Uint32 inputSequence;
+
+    // Complete frames by tick, the baselines the server deltas against
+    NetFrame frames[NET_HISTORY];
+    sf::Uint32 latestTick;
+
+    // Frame being assembled from fragments
+    NetFrame pending;
+    bool assembling;
+    sf::Uint32 pendingLastInput;
+    std::vector<bool> pendingFragments;
+    int pendingReceived;
+    PlayerState pendingSelf;
+    bool pendingHasSelf;
+
+    NetBuffer incoming;
+    NetBuffer outgoing;
+
+    // Bot input
+    bool bot;
+    sf::Uint32 botSeed;
+    float botTimer;
+    sf::Uint8 botButtons;
+
+    // Drawing
+    RenderQueue renderQueue;
+    Hud hud;
+    std::vector<sf::Sprite> sprites;  // One per remote entity, alive until the queue is flushed
+    std::vector<sf::Vertex> projectileVertices;
+
+    ClientStats counters;
+};
+
+#endif // CLIENT_H
@@ -1,23 +1,37 @@
 #include "Enemy.h"
+#include "World.h"
+#include "Projectile.h"
+#include "Particles.h"
+#include "Animation.h"
+#include "Tuning.h"
+#include "Snapshot.h"
+#include "Physics.h"
+#include "GameRandom.h"
 #include <SFML/Graphics.hpp>
 #include <iostream>
 
-const float SCREEN_WIDTH = 1280;
-const float SCREEN_HEIGHT = 720;
 const float DETECTION_RANGE = 300.0f; // Range at which enemy detects target
 const float GROUND_CHECK_DISTANCE = 50.0f; // Distance to check for ground ahead
 const float WALL_CHECK_DISTANCE = 20.0f; // Distance to check for walls ahead
+const float CHASE_RANGE = DETECTION_RANGE * 4; // Range at which enemy paths to the target's platform
+const float NAV_ARRIVE_DISTANCE = 8.0f; // How close to a takeoff point counts as there
 
-const float CHARGE_SPEED_MULTIPLIER = 4.0f; // Enemy moves faster during charge
-const float CHARGE_DURATION = 1.0f; // How long the charge lasts
-const float CHARGE_COOLDOWN = 2.0f; // Time between charges
-const float CHARGE_TELEGRAPH_DURATION = 1.0f; // How long to pause before charging
+// AI level of detail, by distance from the target
+const float FULL_DETAIL_RANGE = DETECTION_RANGE * 2; // Every tick
+const float HALF_DETAIL_RANGE = CHASE_RANGE;         // Every other tick
+const int HALF_DETAIL_INTERVAL = 2;
+const int MIN_FAR_INTERVAL = 4;                      // Beyond that, stretched so far enemies cost
+const int MAX_FAR_INTERVAL = 16;                     // about FAR_UPDATES_PER_TICK AI ticks per tick
+const int FAR_UPDATES_PER_TICK = 32;
+
+// Charge, hit, and ranged attack tuning is in Tuning/enemy.cfg
+
+const float DEATH_ROTATION_SPEED = 720.0f; // Degrees per second
+const float DEATH_FALL_SPEED = 500.0f;
 
 // Add new constants for hit animation
-const float HIT_FLASH_DURATION = 0.2f;
-const float HIT_ROTATION_SPEED = 720.0f; // Degrees per second
-const float HIT_BOUNCE_HEIGHT = 50.0f;
 const float HIT_BOUNCE_DURATION = 0.3f;
+const float HOVER_CYCLES_PER_RADIAN = 1.0f / 6.2831853f;
 const float WALL_BUFFER = 50.0f; // Minimum distance from walls
 
 // Health bar constants
@@ -25,6 +39,42 @@ const float HEALTH_BAR_WIDTH = 50.0f;
 const float HEALTH_BAR_HEIGHT = 5.0f;
 const float HEALTH_BAR_OFFSET = 10.0f;
 
+// Steps of the charge script, in order
+enum class ChargePhase : int {
+    Ready,       // Until the target comes close
+    Telegraph,   // Winding up, facing the target
+    Charging,
+    Cooldown
+};
+
+// A wall or ledge interrupts the wind-up or the charge, which goes straight to
+// the cooldown. Durations are read at each step, so tuning reloads apply.
+static PhasedScript ChargeSequence(int start, float elapsed) {
+    ChargePhase phase = static_cast<ChargePhase>(start);
+    for (;;) {
+        const EnemyTuning& tuning = GameTuning().enemy;
+        switch (phase) {
+        case ChargePhase::Ready:
+            co_await PhasedScript::wait(static_cast<int>(phase), PhasedScript::FOREVER, elapsed);
+            phase = ChargePhase::Telegraph;
+            break;
+        case ChargePhase::Telegraph:
+            phase = co_await PhasedScript::wait(static_cast<int>(phase), tuning.chargeTelegraphDuration, elapsed) ?
+                ChargePhase::Cooldown : ChargePhase::Charging;
+            break;
+        case ChargePhase::Charging:
+            co_await PhasedScript::wait(static_cast<int>(phase), tuning.chargeDuration, elapsed);
+            phase = ChargePhase::Cooldown;
+            break;
+        case ChargePhase::Cooldown:
+            co_await PhasedScript::wait(static_cast<int>(phase), tuning.chargeCooldown, elapsed);
+            phase = ChargePhase::Ready;
+            break;
+        }
+        elapsed = 0.0f;
+    }
+}
+
 sf::Vector2f normalize(const sf::Vector2f& vector) {
     float length = std::sqrt(vector.x * vector.x + vector.y * vector.y);
     if (length != 0) {
@@ -34,79 +84,67 @@ sf::Vector2f normalize(const sf::Vector2f& vector) {
 }
 
 
-Enemy::Enemy(sf::Vector2f spawnPosition, sf::Texture& texture, float speed, float health, bool flying, bool canCharge)
-    : gravity(5), OnGround(false), velocity(0, 0), speed(speed), texture(texture),
-    health(health), maxHealth(health), following(false), facingRight(false), isFlying(flying),
-    canCharge(canCharge), isCharging(false), chargeTimer(0.0f), chargeCooldown(0.0f),
-    isTelegraphing(false), telegraphTimer(0.0f), hitFlashTimer(0.0f), hitRotation(0.0f),
-    hitBounceTimer(0.0f), originalY(spawnPosition.y)
+Enemy::Enemy(sf::Vector2f spawnPosition, EnemyKindId kind)
+    : kind(kind), OnGround(false), velocity(0, 0), health(GetEnemyKind(kind).maxHealth),
+    following(false), facingRight(false), hitFlashTimer(0.0f), hitRotation(0.0f),
+    hitBounceTimer(0.0f), originalY(spawnPosition.y), lodAnchor(spawnPosition)
 {
-    sprite.setTexture(texture);
+    sprite.setTexture(EnemyTexture(GetEnemyKind(kind).textureId));
     // Set origin to center
     sprite.setOrigin(sprite.getGlobalBounds().width / 2.f, sprite.getGlobalBounds().height / 2.f);
     sprite.setPosition(spawnPosition);
-
-    // Initialize health bars
-    healthBarBackground.setSize(sf::Vector2f(HEALTH_BAR_WIDTH, HEALTH_BAR_HEIGHT));
-    healthBarBackground.setFillColor(sf::Color(100, 100, 100));
-    healthBarBackground.setOrigin(HEALTH_BAR_WIDTH / 2.f, 0); // Center horizontally
-
-    healthBarFill.setSize(sf::Vector2f(HEALTH_BAR_WIDTH, HEALTH_BAR_HEIGHT));
-    healthBarFill.setFillColor(sf::Color::Red);
-    healthBarFill.setOrigin(HEALTH_BAR_WIDTH / 2.f, 0); // Center horizontally
+    if (GetEnemyKind(kind).archetype == EnemyArchetype::Charger)
+        charge = PhasedScript::start(&ChargeSequence, static_cast<int>(ChargePhase::Ready), 0.0f);
 }
 
-void Enemy::draw(sf::RenderWindow& window) {
-
-    // Hit flash
-    if (hitFlashTimer > 0) {
-        float flashIntensity = (hitFlashTimer / HIT_FLASH_DURATION);
-        sprite.setColor(sf::Color(255,
-            255 - (155 * flashIntensity),
-            255 - (155 * flashIntensity),
-            255));
-    }
-    else if (!isDeathAnimating) {
-        sprite.setColor(isTelegraphing ? sf::Color(255, 200, 200) : sf::Color::White);
-    }
-
-    // Apply hit rotation
-    if ((knockbackActive && isFlying) || isDeathAnimating) {
-        sprite.setRotation(hitRotation);
-    }
-    else {
-        sprite.setRotation(0);
-    }
-
+void Enemy::draw(RenderQueue& queue) {
+    // Dying beats a fresh hit, which beats winding up a charge
+    const AnimationPose* pose = &RestPose();
+    if (isDeathAnimating)
+        pose = &GetClip(Clip::EnemyDeath).at(deathTimer);
+    else if (hitFlashTimer > 0)
+        pose = &GetClip(Clip::EnemyHit).at(GetClip(Clip::EnemyHit).getDuration() - hitFlashTimer);
+    else if (isTelegraphing())
+        pose = &GetClip(Clip::EnemyTelegraph).at(charge.elapsed());
+
+    // Spin while dying or knocked back through the air
+    bool flying = archetype() == EnemyArchetype::Flyer;
+    float rotation = isDeathAnimating ? deathRotation : knockbackActive && flying ? hitRotation : 0.0f;
+    pose->apply(sprite, sf::Vector2f(1.0f, 1.0f), facingRight ? -1.0f : 1.0f, rotation);
+
+    if (!queue.submit(RenderLayer::Enemies, sprite) || isDeathAnimating)
+        return;
 
-    // Simply flip the sprite scale for direction
-    sprite.setScale(facingRight ? -1.0f : 1.0f, 1.0f);
+    // Health bar centered above the sprite, as two untextured quads built on the spot
+    float left = sprite.getPosition().x - HEALTH_BAR_WIDTH / 2;
+    float top = sprite.getPosition().y - sprite.getGlobalBounds().height / 2 - HEALTH_BAR_OFFSET;
+    float fill = HEALTH_BAR_WIDTH * health / GetEnemyKind(kind).maxHealth;
+    const sf::Color background(100, 100, 100);
+    sf::Vertex bar[8] = {
+        sf::Vertex(sf::Vector2f(left, top), background),
+        sf::Vertex(sf::Vector2f(left + HEALTH_BAR_WIDTH, top), background),
+        sf::Vertex(sf::Vector2f(left + HEALTH_BAR_WIDTH, top + HEALTH_BAR_HEIGHT), background),
+        sf::Vertex(sf::Vector2f(left, top + HEALTH_BAR_HEIGHT), background),
+        sf::Vertex(sf::Vector2f(left, top), sf::Color::Red),
+        sf::Vertex(sf::Vector2f(left + fill, top), sf::Color::Red),
+        sf::Vertex(sf::Vector2f(left + fill, top + HEALTH_BAR_HEIGHT), sf::Color::Red),
+        sf::Vertex(sf::Vector2f(left, top + HEALTH_BAR_HEIGHT), sf::Color::Red)
+    };
+    queue.submit(RenderLayer::EnemyBars, bar, 8, sf::Quads);
+}
 
-    // Set telegraph color
-    if (isTelegraphing) {
-        sprite.setColor(sf::Color(255, 200, 200));
-    }
-    else {
-        sprite.setColor(sf::Color::White);
+template <class Behaviour>
+bool Enemy::think(float deltaTime, const Terrain& terrain, const FlowField& flowField, NavGraph& navGraph) {
+    // Death animation: spin and fall, then remove the enemy
+    if (isDeathAnimating) {
+        deathTimer += deltaTime;
+        deathRotation += DEATH_ROTATION_SPEED * deltaTime;
+        sprite.move(0, DEATH_FALL_SPEED * deltaTime);
+        if (GetClip(Clip::EnemyDeath).isFinished(deathTimer))
+            alive = false;
+        return false;
     }
 
-    window.draw(sprite);
-
-    // Update health bar position (centered above sprite)
-    sf::Vector2f healthBarPos = sprite.getPosition();
-    healthBarPos.y -= sprite.getGlobalBounds().height / 2 + HEALTH_BAR_OFFSET;
-
-    float healthPercent = health / maxHealth;
-    healthBarFill.setSize(sf::Vector2f(HEALTH_BAR_WIDTH * healthPercent, HEALTH_BAR_HEIGHT));
-
-    healthBarBackground.setPosition(healthBarPos);
-    healthBarFill.setPosition(healthBarPos);
-
-    window.draw(healthBarBackground);
-    window.draw(healthBarFill);
-}
-
-void Enemy::update(float deltaTime, std::vector<Ground>& grounds, int& currency) {
     // Update hit flash timer
     if (hitFlashTimer > 0) {
         hitFlashTimer -= deltaTime;
@@ -128,26 +166,21 @@ void Enemy::update(float deltaTime, std::vector<Ground>& grounds, int& currency)
             }
             else {
                 // Apply rotation during knockback
-                hitRotation += HIT_ROTATION_SPEED * deltaTime;
+                hitRotation += GameTuning().enemy.hitRotationSpeed * deltaTime;
 
                 // Calculate new position with bounce effect
-                float bounceHeight = HIT_BOUNCE_HEIGHT * std::sin(t * 3.1415);
+                float bounceHeight = GameTuning().enemy.hitBounceHeight * GetCurve(Curve::HitBounce).at(t);
                 sf::Vector2f newPos = knockbackStartPosition + knockbackDirection * knockbackDistance * t;
                 newPos.y -= bounceHeight;
 
                 // Check if new position would be inside any ground
-                bool positionValid = true;
-                for (const auto& ground : grounds) {
-                    if (ground.getBounds().contains(newPos)) {
-                        positionValid = false;
-                        break;
-                    }
-                }
+                bool positionValid = !terrain.isSolid(newPos);
 
-                // Check screen bounds with buffer
+                // Check world bounds with buffer
+                const sf::FloatRect& world = WorldBounds();
                 sf::Vector2f halfSize(sprite.getGlobalBounds().width / 2, sprite.getGlobalBounds().height / 2);
-                if (newPos.x < WALL_BUFFER + halfSize.x ||
-                    newPos.x > SCREEN_WIDTH - WALL_BUFFER - halfSize.x) {
+                if (newPos.x < world.left + WALL_BUFFER + halfSize.x ||
+                    newPos.x > world.left + world.width - WALL_BUFFER - halfSize.x) {
                     positionValid = false;
                 }
 
@@ -162,27 +195,32 @@ void Enemy::update(float deltaTime, std::vector<Ground>& grounds, int& currency)
                     hitRotation = 0.0f;
                     sprite.setRotation(0.0f);
                 }
-                return;
+                return false;
             }
     }
 
-    if (chargeCooldown > 0.0f) {
-        chargeCooldown -= deltaTime;
-    }
+    // Only resumes the charge script when its current step is over
+    if (Behaviour::charges)
+        charge.advance(deltaTime);
 
-    if (isFlying) {
+    const float speed = GetEnemyKind(kind).speed;
+
+    if (Behaviour::flying) {
         hoverTime += deltaTime * 2.0f;
-        hoverOffset = std::sin(hoverTime);
+        hoverOffset = GetCurve(Curve::Hover).looped(hoverTime * HOVER_CYCLES_PER_RADIAN);
 
-        float distanceToTarget = std::sqrt(
-            std::pow(targetPosition.x - sprite.getPosition().x, 2) +
-            std::pow(targetPosition.y - sprite.getPosition().y, 2)
-        );
+        sf::Vector2f toTarget = targetPosition - sprite.getPosition();
+        float distanceSquared = toTarget.x * toTarget.x + toTarget.y * toTarget.y;
 
-        following = distanceToTarget < DETECTION_RANGE * 10;
+        following = distanceSquared < (DETECTION_RANGE * 10) * (DETECTION_RANGE * 10);
         sf::Vector2f direction;
-        if (following)
-            direction = normalize(targetPosition - sprite.getPosition());
+        if (following) {
+            // Steer along the shared flow field around platforms, going straight
+            // for the target once in its cell or off the grid
+            direction = flowField.directionAt(sprite.getPosition());
+            if (direction.x == 0 && direction.y == 0)
+                direction = normalize(toTarget);
+        }
         else
             direction = sf::Vector2f{ 1,1 };
         sprite.setPosition(
@@ -198,47 +236,51 @@ void Enemy::update(float deltaTime, std::vector<Ground>& grounds, int& currency)
 
         following = distanceToTarget < DETECTION_RANGE;
 
-        if (isTelegraphing) {
+        // Track the platform underfoot and look up the next move towards the target's platform
+        if (OnGround)
+            currentNode = navGraph.nodeAt(sprite.getPosition() + sf::Vector2f(0, sprite.getGlobalBounds().height / 2));
+        const NavEdge* route = nullptr;
+        if (distanceToTarget < CHASE_RANGE)
+            route = navGraph.nextEdge(currentNode, navGraph.goal());
+
+        if (Behaviour::charges && isTelegraphing()) {
             velocity.x = 0;
             facingRight = targetPosition.x > sprite.getPosition().x;
-
-            telegraphTimer += deltaTime;
-            if (telegraphTimer >= CHARGE_TELEGRAPH_DURATION) {
-                isTelegraphing = false;
-                isCharging = true;
-                chargeTimer = 0.0f;
-            }
         }
-        else if (isCharging) {
+        else if (Behaviour::charges && isCharging()) {
             // Ground check during charging
             sf::Vector2f groundCheckPos = sprite.getPosition();
             groundCheckPos.x += (facingRight ? GROUND_CHECK_DISTANCE : -GROUND_CHECK_DISTANCE);
             groundCheckPos.y += sprite.getGlobalBounds().height / 2 + 5.0f;
 
-            bool groundAhead = false;
-            for (const auto& ground : grounds) {
-                if (ground.getBounds().contains(groundCheckPos)) {
-                    groundAhead = true;
-                    break;
-                }
-            }
-
-            if (!groundAhead) {
+            if (!terrain.isSolid(groundCheckPos)) {
                 // Stop charging if no ground ahead
-                isCharging = false;
-                chargeTimer = 0.0f;
-                chargeCooldown = CHARGE_COOLDOWN;
+                charge.interrupt();
                 velocity.x = 0;
             }
             else {
-                // Continue charging
-                chargeTimer += deltaTime;
-                if (chargeTimer >= CHARGE_DURATION) {
-                    isCharging = false;
-                    chargeTimer = 0.0f;
-                    chargeCooldown = CHARGE_COOLDOWN;
+                velocity.x = (facingRight ? 1 : -1) * speed * GameTuning().enemy.chargeSpeedMultiplier;
+            }
+        }
+        else if (route) {
+            // Target is on another platform: walk to the takeoff point, then walk, drop or jump across.
+            // Velocity is left alone in the air so the arc carries through.
+            following = true;
+            if (OnGround) {
+                float toTakeoff = route->takeoffX - sprite.getPosition().x;
+                if (std::abs(toTakeoff) > NAV_ARRIVE_DISTANCE) {
+                    velocity.x = (toTakeoff > 0 ? 1 : -1) * speed;
                 }
-                velocity.x = (facingRight ? 1 : -1) * speed * CHARGE_SPEED_MULTIPLIER;
+                else {
+                    float toLanding = route->landingX - sprite.getPosition().x;
+                    velocity.x = std::abs(toLanding) > NAV_ARRIVE_DISTANCE ? (toLanding > 0 ? 1 : -1) * speed : 0;
+                    if (route->type == NavEdgeType::Jump) {
+                        velocity.y = -NAV_JUMP_SPEED;
+                        OnGround = false;
+                    }
+                }
+                if (velocity.x != 0)
+                    facingRight = velocity.x > 0;
             }
         }
         else if (following) {
@@ -246,9 +288,8 @@ void Enemy::update(float deltaTime, std::vector<Ground>& grounds, int& currency)
             velocity.x = direction * speed;
             facingRight = direction > 0;
 
-            if (canCharge && distanceToTarget < DETECTION_RANGE && chargeCooldown <= 0.0f) {
-                isTelegraphing = true;
-                telegraphTimer = 0.0f;
+            if (Behaviour::charges && distanceToTarget < DETECTION_RANGE && charge.phase() == static_cast<int>(ChargePhase::Ready)) {
+                charge.interrupt();
                 velocity.x = 0;
             }
         }
@@ -266,117 +307,219 @@ void Enemy::update(float deltaTime, std::vector<Ground>& grounds, int& currency)
             sf::Vector2f wallCheckPos = sprite.getPosition();
             wallCheckPos.x += (facingRight ? WALL_CHECK_DISTANCE : -WALL_CHECK_DISTANCE);
 
-            bool groundAhead = false;
-            bool wallAhead = false;
-
-            for (const auto& ground : grounds) {
-                if (ground.getBounds().contains(groundCheckPos)) {
-                    groundAhead = true;
-                }
-                if (ground.getBounds().contains(wallCheckPos)) {
-                    wallAhead = true;
-                }
-            }
+            bool groundAhead = terrain.isSolid(groundCheckPos);
+            bool wallAhead = terrain.isSolid(wallCheckPos);
 
             if (!groundAhead || wallAhead ||
-                (facingRight && sprite.getPosition().x >= SCREEN_WIDTH - spriteBounds.x / 2) ||
-                (!facingRight && sprite.getPosition().x <= spriteBounds.x / 2)) {
+                (facingRight && sprite.getPosition().x >= WorldBounds().left + WorldBounds().width - spriteBounds.x / 2) ||
+                (!facingRight && sprite.getPosition().x <= WorldBounds().left + spriteBounds.x / 2)) {
                 facingRight = !facingRight;
                 velocity.x = -velocity.x;
-                if (isCharging || isTelegraphing) {
-                    isCharging = false;
-                    isTelegraphing = false;
-                    chargeTimer = 0.0f;
-                    chargeCooldown = CHARGE_COOLDOWN;
-                }
-            }
-        }
-
-        if (!OnGround)
-            velocity.y += gravity;
-
-        OnGround = false;
-        for (auto& ground : grounds) {
-            if (sprite.getGlobalBounds().intersects(ground.getBounds())) {
-                sf::FloatRect groundBounds = ground.getBounds();
-                sf::FloatRect spriteBounds = sprite.getGlobalBounds();
-
-                // Adjust sprite bounds based on origin offset
-                sf::Vector2f originOffset(sprite.getOrigin().x, sprite.getOrigin().y);
-                spriteBounds.left -= originOffset.x;
-                spriteBounds.top -= originOffset.y;
-
-                float spriteBottom = spriteBounds.top + spriteBounds.height;
-                float groundTop = groundBounds.top;
-                float spriteRight = spriteBounds.left + spriteBounds.width;
-                float groundLeft = groundBounds.left;
-                float spriteLeft = spriteBounds.left;
-                float groundRight = groundBounds.left + groundBounds.width;
-
-                float overlapTop = spriteBottom - groundTop;
-                float overlapBottom = groundBounds.top + groundBounds.height - spriteBounds.top;
-                float overlapLeft = spriteRight - groundLeft;
-                float overlapRight = groundRight - spriteLeft;
-
-                float minOverlap = std::min({ overlapTop, overlapBottom, overlapLeft, overlapRight });
-
-                if (minOverlap == overlapTop && velocity.y > 0) {
-                    sprite.setPosition(sprite.getPosition().x,
-                        groundTop - (spriteBounds.height - originOffset.y));
-                    velocity.y = 0;
-                    OnGround = true;
-                }
-                else if (minOverlap == overlapLeft && velocity.x > 0) {
-                    sprite.setPosition(groundLeft - (spriteBounds.width - originOffset.x),
-                        sprite.getPosition().y);
-                    velocity.x = 0;
-                    if (isCharging || isTelegraphing) {
-                        isCharging = false;
-                        isTelegraphing = false;
-                        chargeTimer = 0.0f;
-                        chargeCooldown = CHARGE_COOLDOWN;
-                    }
-                }
-                else if (minOverlap == overlapRight && velocity.x < 0) {
-                    sprite.setPosition(groundRight + originOffset.x,
-                        sprite.getPosition().y);
-                    velocity.x = 0;
-                    if (isCharging || isTelegraphing) {
-                        isCharging = false;
-                        isTelegraphing = false;
-                        chargeTimer = 0.0f;
-                        chargeCooldown = CHARGE_COOLDOWN;
-                    }
-                }
+                if (Behaviour::charges && (isCharging() || isTelegraphing()))
+                    charge.interrupt();
             }
         }
     }
 
-    sprite.move(velocity * deltaTime);
+    return true;
+}
+
+KinematicBody Enemy::makeBody(float deltaTime, bool flying) const {
+    KinematicBody body = KinematicBody::fromSprite(sprite, velocity, OnGround);
+    body.gravity = ENEMY_GRAVITY;
+    body.deltaTime = deltaTime;
+    body.moves = true;
+    body.collides = !flying;
+    return body;
+}
+
+void Enemy::onContact(ContactSide side) {
+    // Running into a wall ends a charge or its wind-up
+    if (side != ContactSide::Top && (isCharging() || isTelegraphing()))
+        charge.interrupt();
+}
+
+void Enemy::settle(const KinematicBody& body, int& currency) {
+    sprite.setPosition(body.position);
+    velocity = body.velocity;
+    OnGround = body.onGround;
 
     if (health <= 0) {
-        alive = false;
-        srand(time(0));
-        currency += std::rand() % 11 + 20;
+        isDeathAnimating = true;
+        deathTimer = 0.0f;
+        Particles().burst(sprite.getPosition(), 48, 350.0f, 0.8f, 6.0f, sf::Color(200, 40, 40), 600.0f);
+        currency += GameRandom(11) + 20;
     }
 
-    // Screen bounds checking with centered origin
-    sf::Vector2f halfSize(sprite.getGlobalBounds().width / 2, sprite.getGlobalBounds().height / 2);
-    if (sprite.getPosition().x < halfSize.x)
-        sprite.setPosition(halfSize.x, sprite.getPosition().y);
-    else if (sprite.getPosition().x > SCREEN_WIDTH - halfSize.x)
-        sprite.setPosition(SCREEN_WIDTH - halfSize.x, sprite.getPosition().y);
-    if (sprite.getPosition().y > SCREEN_HEIGHT)
+    // World bounds checking with centered origin
+    const sf::FloatRect& world = WorldBounds();
+    sf::Vector2f halfSize(body.bounds.width / 2, body.bounds.height / 2);
+    if (sprite.getPosition().x < world.left + halfSize.x)
+        sprite.setPosition(world.left + halfSize.x, sprite.getPosition().y);
+    else if (sprite.getPosition().x > world.left + world.width - halfSize.x)
+        sprite.setPosition(world.left + world.width - halfSize.x, sprite.getPosition().y);
+    if (sprite.getPosition().y > world.top + world.height)
         health = 0;
 }
 
+template <class Behaviour>
+void Enemy::updateAs(float deltaTime, const Terrain& terrain, const FlowField& flowField, NavGraph& navGraph, int& currency) {
+    if (!think<Behaviour>(deltaTime, terrain, flowField, navGraph))
+        return;
+
+    KinematicBody body = makeBody(deltaTime, Behaviour::flying);
+    PhysicsWorld::stepBody(body, terrain);
+    for (sf::Uint8 side = 1; side <= 4; side <<= 1) {
+        if (body.contacts & side)
+            onContact(static_cast<ContactSide>(side));
+    }
+    settle(body, currency);
+}
+
+void Enemy::update(float deltaTime, const Terrain& terrain, const FlowField& flowField, NavGraph& navGraph, int& currency) {
+    // Single-enemy entry point; hordes should go through updateGroup instead
+    switch (archetype()) {
+    case EnemyArchetype::Walker:
+        updateAs<WalkerBehaviour>(deltaTime, terrain, flowField, navGraph, currency);
+        break;
+    case EnemyArchetype::Flyer:
+        updateAs<FlyerBehaviour>(deltaTime, terrain, flowField, navGraph, currency);
+        break;
+    case EnemyArchetype::Charger:
+        updateAs<ChargerBehaviour>(deltaTime, terrain, flowField, navGraph, currency);
+        break;
+    }
+}
+
+// Reused by every group, one set per thread, so a steady horde doesn't allocate
+static thread_local PhysicsWorld groupWorld;
+static thread_local std::vector<Enemy*> groupStepped;
+
+void Enemy::reserveGroups(size_t enemyCount) {
+    groupWorld.reserve(static_cast<int>(enemyCount));
+    groupStepped.reserve(enemyCount);
+}
+
+template <class Behaviour>
+void Enemy::updateGroup(Enemy* first, Enemy* last, float deltaTime, const Terrain& terrain,
+    const FlowField& flowField, NavGraph& navGraph, ProjectilePool& projectiles,
+    const sf::Vector2f& target, int& currency) {
+    // Each enemy's AI rate comes from its distance to the target. The far rate
+    // stretches with the far count, so a bigger horde doesn't cost more per tick.
+    const float fullRange = FULL_DETAIL_RANGE * FULL_DETAIL_RANGE;
+    const float halfRange = HALF_DETAIL_RANGE * HALF_DETAIL_RANGE;
+    int farCount = 0;
+    for (Enemy* enemy = first; enemy != last; ++enemy) {
+        if (enemy->alive && enemy->distanceSquaredTo(target) >= halfRange)
+            ++farCount;
+    }
+    int farInterval = std::max(MIN_FAR_INTERVAL, std::min(MAX_FAR_INTERVAL,
+        (farCount + FAR_UPDATES_PER_TICK - 1) / FAR_UPDATES_PER_TICK));
+
+    PhysicsWorld& world = groupWorld;
+    std::vector<Enemy*>& stepped = groupStepped;
+    world.clear();
+    stepped.clear();
+
+    int slot = 0;
+    for (Enemy* enemy = first; enemy != last; ++enemy, ++slot) {
+        if (!enemy->alive)
+            continue;
+
+        float distanceSquared = enemy->distanceSquaredTo(target);
+        int interval = distanceSquared < fullRange || enemy->needsFullDetail() ? 1 :
+            distanceSquared < halfRange ? HALF_DETAIL_INTERVAL : farInterval;
+        if (interval != enemy->lodInterval) {
+            enemy->lodInterval = interval;
+            enemy->lodWait = slot % interval; // Spread the group's AI ticks across the interval
+        }
+
+        // Between AI ticks, only glide along
+        enemy->lodElapsed += deltaTime;
+        if (interval > 1 && ++enemy->lodWait < interval) {
+            enemy->sprite.setPosition(enemy->lodAnchor + enemy->lodVelocity * enemy->lodElapsed);
+            continue;
+        }
+
+        // AI now; the ones that move go into the world to be stepped together
+        enemy->sprite.setPosition(enemy->lodAnchor);
+        if (enemy->think<Behaviour>(enemy->lodElapsed, terrain, flowField, navGraph)) {
+            world.add(enemy->makeBody(enemy->lodElapsed, Behaviour::flying));
+            stepped.push_back(enemy);
+        }
+        else
+            enemy->finishTick<Behaviour>(projectiles, target);
+    }
+
+    world.step(terrain);
+    for (const Contact& contact : world.getContacts())
+        stepped[contact.body]->onContact(contact.side);
+    for (int i = 0; i < world.size(); ++i) {
+        stepped[i]->settle(world.body(i), currency);
+        stepped[i]->finishTick<Behaviour>(projectiles, target);
+    }
+}
+
+template <class Behaviour>
+void Enemy::finishTick(ProjectilePool& projectiles, const sf::Vector2f& target) {
+    float elapsed = lodElapsed;
+    setTarget(target);
+    if (Behaviour::flying)
+        shoot(projectiles, elapsed);
+
+    if (elapsed > 0)
+        lodVelocity = (sprite.getPosition() - lodAnchor) / elapsed;
+    lodAnchor = sprite.getPosition();
+    lodElapsed = 0.0f;
+    lodWait = 0;
+}
+
+float Enemy::distanceSquaredTo(const sf::Vector2f& point) const {
+    sf::Vector2f offset = sprite.getPosition() - point;
+    return offset.x * offset.x + offset.y * offset.y;
+}
+
+bool Enemy::needsFullDetail() const {
+    // Anything mid-air or mid-move runs every tick, wherever it is
+    return isDeathAnimating || knockbackActive || isCharging() || isTelegraphing() ||
+        (archetype() != EnemyArchetype::Flyer && !OnGround);
+}
+
+bool Enemy::isTelegraphing() const {
+    return charge.phase() == static_cast<int>(ChargePhase::Telegraph);
+}
+
+bool Enemy::isCharging() const {
+    return charge.phase() == static_cast<int>(ChargePhase::Charging);
+}
+
+void Enemy::resetDetail() {
+    // Moved from outside the update: start the next AI tick from here
+    lodAnchor = sprite.getPosition();
+    lodVelocity = sf::Vector2f(0, 0);
+    lodElapsed = 0.0f;
+    lodWait = 0;
+    lodInterval = 1;
+}
+
+// One kernel per archetype; add a line here along with a new behaviour policy
+template void Enemy::updateGroup<WalkerBehaviour>(Enemy*, Enemy*, float, const Terrain&,
+    const FlowField&, NavGraph&, ProjectilePool&, const sf::Vector2f&, int&);
+template void Enemy::updateGroup<FlyerBehaviour>(Enemy*, Enemy*, float, const Terrain&,
+    const FlowField&, NavGraph&, ProjectilePool&, const sf::Vector2f&, int&);
+template void Enemy::updateGroup<ChargerBehaviour>(Enemy*, Enemy*, float, const Terrain&,
+    const FlowField&, NavGraph&, ProjectilePool&, const sf::Vector2f&, int&);
+
 void Enemy::takeDamage(float damage, const sf::Vector2f& hitDirection, float knockbackDistance) {
-    if(knockbackActive || damageCooldownTimer > 0) return;
+    if(isDeathAnimating || knockbackActive || damageCooldownTimer > 0) return;
 
-    if (isCharging || isTelegraphing) {
+    // Sparks fly off in the direction of the hit
+    Particles().spray(sprite.getPosition(), hitDirection, 1.2f, 12, 400.0f, 0.3f, 4.0f, sf::Color(255, 230, 150), 900.0f);
+
+    if (isCharging() || isTelegraphing()) {
         health -= damage;
         damageCooldownTimer = 0.2f;
-        hitFlashTimer = HIT_FLASH_DURATION;
+        hitFlashTimer = GetClip(Clip::EnemyHit).getDuration();
         return;
     }
 
@@ -389,9 +532,24 @@ void Enemy::takeDamage(float damage, const sf::Vector2f& hitDirection, float kno
     knockbackTimer = 0.0f;
     knockbackDuration = 0.3f; // Increased duration for better effect
     damageCooldownTimer = 0.2f;
-    hitFlashTimer = HIT_FLASH_DURATION;
+    hitFlashTimer = GetClip(Clip::EnemyHit).getDuration();
     hitRotation = 0.0f; // Reset rotation
     hitBounceTimer = 0.0f; // Reset bounce timer
+    resetDetail();
+}
+
+void Enemy::shoot(ProjectilePool& projectiles, float deltaTime) {
+    if (archetype() != EnemyArchetype::Flyer || !following || knockbackActive)
+        return;
+
+    shootCooldown -= deltaTime;
+    if (shootCooldown > 0.0f)
+        return;
+
+    sf::Vector2f direction = normalize(targetPosition - sprite.getPosition());
+    projectiles.spawn(sprite.getPosition(), direction * GameTuning().enemy.projectileSpeed, 1.0f,
+        GameTuning().enemy.projectileLifetime, 10.0f, ProjectileOwner::Enemy, sf::Color(255, 90, 60));
+    shootCooldown = GameTuning().enemy.shootInterval;
 }
 
 void Enemy::setTarget(const sf::Vector2f& target) {
@@ -402,6 +560,10 @@ bool Enemy::isAlive() {
     return alive;
 }
 
+bool Enemy::isDying() const {
+    return isDeathAnimating;
+}
+
 bool Enemy::hit() {
     return knockbackActive;
 }
@@ -414,6 +576,120 @@ sf::FloatRect Enemy::getBounds() {
     return sprite.getGlobalBounds();
 }
 
+void Enemy::saveState(EnemyState& state) const {
+    state.position = sprite.getPosition();
+    state.velocity = velocity;
+    state.targetPosition = targetPosition;
+    state.knockbackStartPosition = knockbackStartPosition;
+    state.knockbackDirection = knockbackDirection;
+    const EnemyKind& shared = GetEnemyKind(kind);
+    state.speed = shared.speed;
+    state.health = health;
+    state.maxHealth = shared.maxHealth;
+    state.textureId = shared.textureId;
+    state.damageCooldownTimer = damageCooldownTimer;
+    state.hoverTime = hoverTime;
+    state.hoverOffset = hoverOffset;
+    state.shootCooldown = shootCooldown;
+    // The charge script saves as the step it is on and its time there
+    state.telegraphTimer = isTelegraphing() ? charge.elapsed() : 0.0f;
+    state.chargeTimer = isCharging() ? charge.elapsed() : 0.0f;
+    state.chargeCooldown = charge.phase() == static_cast<int>(ChargePhase::Cooldown) ? charge.remaining() : 0.0f;
+    state.knockbackDistance = knockbackDistance;
+    state.knockbackTimer = knockbackTimer;
+    state.knockbackDuration = knockbackDuration;
+    state.hitFlashTimer = hitFlashTimer;
+    state.hitRotation = hitRotation;
+    state.hitBounceTimer = hitBounceTimer;
+    state.originalY = originalY;
+    state.deathRotation = deathRotation;
+    state.deathTimer = deathTimer;
+    state.currentNode = currentNode;
+    state.flying = shared.archetype == EnemyArchetype::Flyer;
+    state.charging = shared.archetype == EnemyArchetype::Charger;
+    state.onGround = OnGround;
+    state.alive = alive;
+    state.facingRight = facingRight;
+    state.telegraphing = isTelegraphing();
+    state.chargingNow = isCharging();
+    state.knockbackActive = knockbackActive;
+    state.following = following;
+    state.deathAnimating = isDeathAnimating;
+}
+
+void Enemy::loadState(const EnemyState& state) {
+    // The archetype and texture are fixed by the constructor's kind; speed and
+    // max health may differ, e.g. when a balance run scales them
+    sprite.setPosition(state.position);
+    resetDetail();
+    const EnemyKind& shared = GetEnemyKind(kind);
+    if (state.speed != shared.speed || state.maxHealth != shared.maxHealth) {
+        EnemyKind scaled = shared;
+        scaled.speed = state.speed;
+        scaled.maxHealth = state.maxHealth;
+        kind = RegisterEnemyKind(scaled);
+    }
+    velocity = state.velocity;
+    targetPosition = state.targetPosition;
+    knockbackStartPosition = state.knockbackStartPosition;
+    knockbackDirection = state.knockbackDirection;
+    health = state.health;
+    damageCooldownTimer = state.damageCooldownTimer;
+    hoverTime = state.hoverTime;
+    hoverOffset = state.hoverOffset;
+    shootCooldown = state.shootCooldown;
+    knockbackDistance = state.knockbackDistance;
+    knockbackTimer = state.knockbackTimer;
+    knockbackDuration = state.knockbackDuration;
+    hitFlashTimer = state.hitFlashTimer;
+    hitRotation = state.hitRotation;
+    hitBounceTimer = state.hitBounceTimer;
+    originalY = state.originalY;
+    deathRotation = state.deathRotation;
+    deathTimer = state.deathTimer;
+    currentNode = state.currentNode;
+    OnGround = state.onGround;
+    alive = state.alive;
+    facingRight = state.facingRight;
+    knockbackActive = state.knockbackActive;
+    following = state.following;
+    isDeathAnimating = state.deathAnimating;
+
+    if (archetype() == EnemyArchetype::Charger) {
+        ChargePhase phase = state.telegraphing ? ChargePhase::Telegraph : state.chargingNow ? ChargePhase::Charging :
+            state.chargeCooldown > 0.0f ? ChargePhase::Cooldown : ChargePhase::Ready;
+        float elapsed = phase == ChargePhase::Telegraph ? state.telegraphTimer : phase == ChargePhase::Charging ? state.chargeTimer :
+            phase == ChargePhase::Cooldown ? GameTuning().enemy.chargeCooldown - state.chargeCooldown : 0.0f;
+        charge = PhasedScript();  // Frees the old frame for the new one
+        charge = PhasedScript::start(&ChargeSequence, static_cast<int>(phase), elapsed);
+    }
+}
+
+const sf::Texture* Enemy::getTexture() const {
+    return sprite.getTexture();
+}
+
+EnemyKindId Enemy::kindOf(const EnemyState& state) {
+    EnemyKind kind;
+    kind.archetype = state.flying ? EnemyArchetype::Flyer : state.charging ? EnemyArchetype::Charger : EnemyArchetype::Walker;
+    kind.textureId = state.textureId < ENEMY_TEXTURE_COUNT ? state.textureId : 0;
+    kind.speed = state.speed;
+    kind.maxHealth = state.maxHealth;
+    return RegisterEnemyKind(kind);
+}
+
+EnemyArchetype Enemy::archetype() const {
+    return GetEnemyKind(kind).archetype;
+}
+
+EnemyKindId Enemy::getKind() const {
+    return kind;
+}
+
+bool Enemy::isFacingRight() const {
+    return facingRight;
+}
+
 sf::Vector2f Enemy::position() {
     return sprite.getPosition();
 }
@@ -2,51 +2,145 @@
 #define ENEMY_H
 
 #include <SFML/Graphics.hpp>
-#include "Ground.h"
+#include "Terrain.h"
+#include "FlowField.h"
+#include "NavGraph.h"
+#include "RenderQueue.h"
+#include "EnemyKind.h"
+#include "Script.h"
+
+class ProjectilePool;
+struct KinematicBody;
+enum class ContactSide : sf::Uint8;
+
+// Compile-time behaviour policies. The update kernel is instantiated once per
+// archetype, so these flags fold away instead of branching per enemy.
+struct WalkerBehaviour {
+    static const bool flying = false;
+    static const bool charges = false;
+};
+
+struct FlyerBehaviour {
+    static const bool flying = true;
+    static const bool charges = false;
+};
+
+struct ChargerBehaviour {
+    static const bool flying = false;
+    static const bool charges = true;
+};
+
+// Plain copy of an enemy's simulation state, used by world snapshots. The kind
+// is stored by value, since registry ids aren't the same from run to run.
+struct EnemyState {
+    sf::Vector2f position;
+    sf::Vector2f velocity;
+    sf::Vector2f targetPosition;
+    sf::Vector2f knockbackStartPosition;
+    sf::Vector2f knockbackDirection;
+    float speed;
+    float health;
+    float maxHealth;
+    float damageCooldownTimer;
+    float hoverTime;
+    float hoverOffset;
+    float shootCooldown;
+    float telegraphTimer;
+    float chargeTimer;
+    float chargeCooldown;
+    float knockbackDistance;
+    float knockbackTimer;
+    float knockbackDuration;
+    float hitFlashTimer;
+    float hitRotation;
+    float hitBounceTimer;
+    float originalY;
+    float deathRotation;
+    float deathTimer;
+    sf::Int32 currentNode;
+    sf::Uint8 textureId;
+    bool flying;
+    bool charging;
+    bool onGround;
+    bool alive;
+    bool facingRight;
+    bool telegraphing;
+    bool chargingNow;
+    bool knockbackActive;
+    bool following;
+    bool deathAnimating;
+};
 
 // Base Enemy class
 class Enemy {
 public:
-    Enemy(sf::Vector2f spawnPosition, sf::Texture& texture, float speed, float health, bool flying, bool charging);
+    Enemy(sf::Vector2f spawnPosition, EnemyKindId kind);
 
-    void update(float deltaTime, std::vector<Ground>& grounds, int& currency);
-    void draw(sf::RenderWindow& window);
+    void update(float deltaTime, const Terrain& terrain, const FlowField& flowField, NavGraph& navGraph, int& currency);
+
+    // Updates a contiguous run of enemies that all share Behaviour's archetype
+    template <class Behaviour>
+    static void updateGroup(Enemy* first, Enemy* last, float deltaTime, const Terrain& terrain,
+        const FlowField& flowField, NavGraph& navGraph, ProjectilePool& projectiles,
+        const sf::Vector2f& target, int& currency);
+    static void reserveGroups(size_t enemyCount);  // Scratch for groups of up to this many, on this thread
+    void draw(RenderQueue& queue);
     void takeDamage(float damage, const sf::Vector2f& hitDirection, float knockbackDistance);
     void setTarget(const sf::Vector2f& target);
+    void shoot(ProjectilePool& projectiles, float deltaTime);
+    void saveState(EnemyState& state) const;
+    void loadState(const EnemyState& state);
+    static EnemyKindId kindOf(const EnemyState& state);
 
     sf::FloatRect getBounds();
     sf::Vector2f position();
+    EnemyArchetype archetype() const;
+    EnemyKindId getKind() const;
+    const sf::Texture* getTexture() const;
     float getHealth();
     bool hit();
     bool isAlive();
+    bool isDying() const;
+    bool isFacingRight() const;
 
 private:
-    sf::Sprite sprite;
-    sf::Texture texture;
+    // A tick is split so hordes can batch the physics: AI first, then the body is
+    // stepped, then contacts and the result are applied
+    template <class Behaviour>
+    void updateAs(float deltaTime, const Terrain& terrain, const FlowField& flowField, NavGraph& navGraph, int& currency);
+    template <class Behaviour>
+    bool think(float deltaTime, const Terrain& terrain, const FlowField& flowField, NavGraph& navGraph);  // False when there's nothing to step
+    KinematicBody makeBody(float deltaTime, bool flying) const;
+    void onContact(ContactSide side);
+    void settle(const KinematicBody& body, int& currency);
+    template <class Behaviour>
+    void finishTick(ProjectilePool& projectiles, const sf::Vector2f& target);  // Aim, shoot, and pick up the glide from here
+    float distanceSquaredTo(const sf::Vector2f& point) const;
+    bool needsFullDetail() const;
+    void resetDetail();
+    bool isTelegraphing() const;
+    bool isCharging() const;
+
+    sf::Sprite sprite;                 // Shares its kind's texture, so copying an Enemy is cheap
     sf::Vector2f velocity;
-    float gravity;
-    float speed;
+    sf::Vector2f targetPosition;
+    float health;
     float damageCooldownTimer = 0;
+    int currentNode = -1;              // Platform last stood on
+    EnemyKindId kind;                  // Speed, max health, archetype and texture live in the registry
     bool OnGround;
     bool alive = true;
     bool facingRight;
-    float health;
-    float maxHealth; // Store initial health for health bar calculations
-    sf::RectangleShape healthBarBackground;
-    sf::RectangleShape healthBarFill;
+    bool following;
 
     // Flying-specific variables
-    bool isFlying;
     float hoverTime = 0.0f;
     float hoverOffset = 0.0f;
+    float shootCooldown = 0.0f;
 
-    // Charging variables
-    bool isTelegraphing;     
-    float telegraphTimer;
-    bool isCharging;
-    bool canCharge;
-    float chargeTimer;
-    float chargeCooldown;
+    // Chargers wind up, charge and cool down in a script, which a copy or
+    // loadState restarts at the same point
+    PhasedScript charge;
 
     // Knockback variables
     bool knockbackActive = false;
@@ -60,18 +154,19 @@ private:
     float hitBounceTimer;
     float originalY;
 
-    // Pathfinding
-    bool following;
-    sf::Vector2f targetPosition;
+    // AI level of detail. Between AI ticks the enemy glides on from where the
+    // last one left it; the next AI tick starts back there and covers all the
+    // time since, so skipped ticks never add up to extra movement.
+    sf::Vector2f lodAnchor;      // Position after the last AI tick
+    sf::Vector2f lodVelocity;    // Average velocity over the last AI tick
+    float lodElapsed = 0.0f;     // Time since the last AI tick
+    int lodInterval = 1;         // Ticks between AI ticks at the current detail
+    int lodWait = 0;             // Ticks since the last AI tick
 
     // Death animation
     bool isDeathAnimating = false;
     float deathRotation = 0.0f;
     float deathTimer = 0.0f;
-    float DEATH_ANIMATION_DURATION = 0.5f;
-    float DEATH_ROTATION_SPEED = 720.0f; // Degrees per second
-    float DEATH_FALL_SPEED = 500.0f;
-
 };
 
 #endif //ENEMY_H
\ No newline at end of file
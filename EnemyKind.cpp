@@ -0,0 +1,87 @@
+#include "EnemyKind.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <mutex>
+
+// Entries sit in a fixed array and the count is only bumped once an entry is
+// written, so reads need no lock even while another thread registers.
+struct EnemyKindRegistry {
+    EnemyKind kinds[MAX_ENEMY_KINDS];
+    std::atomic<int> count;
+    std::mutex mutex;
+
+    EnemyKindRegistry() : count(0) {
+        const EnemyKind stock[] = {
+            { EnemyArchetype::Walker, 0, 100.0f, 10.0f },
+            { EnemyArchetype::Walker, 2, 100.0f, 3.0f },
+            { EnemyArchetype::Flyer, 3, 150.0f, 3.0f },
+            { EnemyArchetype::Charger, 1, 150.0f, 20.0f }
+        };
+        for (const EnemyKind& kind : stock)
+            kinds[count++] = kind;
+    }
+};
+
+static EnemyKindRegistry& Registry() {
+    static EnemyKindRegistry registry;
+    return registry;
+}
+
+const EnemyKind& GetEnemyKind(EnemyKindId id) {
+    return Registry().kinds[id];
+}
+
+static bool SameKind(const EnemyKind& a, const EnemyKind& b) {
+    return a.archetype == b.archetype && a.textureId == b.textureId && a.speed == b.speed && a.maxHealth == b.maxHealth;
+}
+
+EnemyKindId RegisterEnemyKind(const EnemyKind& kind) {
+    EnemyKindRegistry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    int count = registry.count;
+    for (int id = 0; id < count; ++id) {
+        if (SameKind(registry.kinds[id], kind))
+            return static_cast<EnemyKindId>(id);
+    }
+
+    if (count == MAX_ENEMY_KINDS) {
+        static bool reported = false;
+        if (!reported) {
+            std::cerr << "Enemy kind registry is full (" << MAX_ENEMY_KINDS
+                << " kinds); new variants use the closest existing one" << std::endl;
+            reported = true;
+        }
+
+        // Closest stats by ratio, so a late wave keeps roughly its scaling
+        int nearest = -1;
+        float nearestDistance = std::numeric_limits<float>::max();
+        for (int id = 0; id < count; ++id) {
+            const EnemyKind& existing = registry.kinds[id];
+            if (existing.archetype != kind.archetype || existing.textureId != kind.textureId)
+                continue;
+            float distance = std::abs(std::log(existing.speed / kind.speed)) +
+                std::abs(std::log(existing.maxHealth / kind.maxHealth));
+            if (nearest < 0 || distance < nearestDistance) {
+                nearest = id;
+                nearestDistance = distance;
+            }
+        }
+        return static_cast<EnemyKindId>(std::max(nearest, 0));
+    }
+
+    registry.kinds[count] = kind;
+    registry.count = count + 1;
+    return static_cast<EnemyKindId>(count);
+}
+
+EnemyKindId ScaledEnemyKind(EnemyKindId base, float speedScale, float healthScale) {
+    if (speedScale == 1.0f && healthScale == 1.0f)
+        return base;
+    EnemyKind kind = GetEnemyKind(base);
+    kind.speed *= speedScale;
+    kind.maxHealth *= healthScale;
+    return RegisterEnemyKind(kind);
+}
@@ -0,0 +1,44 @@
+#ifndef ENEMYKIND_H
+#define ENEMYKIND_H
+
+#include <SFML/Graphics.hpp>
+
+enum class EnemyArchetype : sf::Uint8 {
+    Walker,
+    Flyer,
+    Charger
+};
+
+// What every enemy of one kind shares. Entries never change once registered,
+// so each enemy holds only the small index of its kind.
+struct EnemyKind {
+    EnemyArchetype archetype;
+    sf::Uint8 textureId;   // EnemyTexture index
+    float speed;
+    float maxHealth;
+};
+
+typedef sf::Uint16 EnemyKindId;
+
+const int MAX_ENEMY_KINDS = 1024;
+
+const float ENEMY_GRAVITY = 300.0f; // px/s^2, the same for every kind that falls
+
+// The campaign's kinds, registered first so their ids are fixed
+const EnemyKindId WALKER_KIND = 0;       // Enemy1, slow and tough
+const EnemyKindId WEAK_WALKER_KIND = 1;  // Enemy3
+const EnemyKindId FLYER_KIND = 2;        // Enemy4, shoots
+const EnemyKindId CHARGER_KIND = 3;      // Enemy2
+
+const EnemyKind& GetEnemyKind(EnemyKindId id);
+
+// Returns the id of an identical kind, adding it if there isn't one yet. Safe
+// from any thread. Once the registry is full, which is reported once, new
+// stats get the kind with the same archetype and texture whose speed and
+// health are closest.
+EnemyKindId RegisterEnemyKind(const EnemyKind& kind);
+
+// A tougher or quicker variant of an existing kind, e.g. for later waves
+EnemyKindId ScaledEnemyKind(EnemyKindId base, float speedScale, float healthScale);
+
+#endif // ENEMYKIND_H
@@ -0,0 +1,129 @@
+#include "FlowField.h"
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <algorithm>
+
+const float OBSTACLE_MARGIN = 24.0f; // Keeps flyer sprites from clipping platform edges
+
+FlowField::FlowField() : columns(0), rows(0), targetCell(-1), origin(0, 0) {}
+
+void FlowField::build(const std::vector<Ground>& grounds, float width, float height) {
+    build(grounds, sf::FloatRect(0, 0, width, height));
+}
+
+void FlowField::build(const std::vector<Ground>& grounds, const sf::FloatRect& area) {
+    origin = sf::Vector2f(area.left, area.top);
+    columns = static_cast<int>(std::ceil(area.width / CELL_SIZE));
+    rows = static_cast<int>(std::ceil(area.height / CELL_SIZE));
+    blocked.assign(columns * rows, 0);
+    cost.assign(columns * rows, -1);
+    direction.assign(columns * rows, sf::Vector2f(0, 0));
+    frontier.reserve(columns * rows);
+    targetCell = -1;
+
+    // Rasterise the grounds, grown by a margin, into the blocked mask
+    for (const Ground& ground : grounds) {
+        sf::FloatRect bounds = ground.getBounds();
+        bounds.left -= origin.x;
+        bounds.top -= origin.y;
+        int left = std::max(0, static_cast<int>(std::floor((bounds.left - OBSTACLE_MARGIN) / CELL_SIZE)));
+        int top = std::max(0, static_cast<int>(std::floor((bounds.top - OBSTACLE_MARGIN) / CELL_SIZE)));
+        int right = std::min(columns - 1, static_cast<int>(std::floor((bounds.left + bounds.width + OBSTACLE_MARGIN) / CELL_SIZE)));
+        int bottom = std::min(rows - 1, static_cast<int>(std::floor((bounds.top + bounds.height + OBSTACLE_MARGIN) / CELL_SIZE)));
+        for (int y = top; y <= bottom; ++y)
+            for (int x = left; x <= right; ++x)
+                blocked[y * columns + x] = 1;
+    }
+}
+
+void FlowField::setTarget(const sf::Vector2f& target) {
+    int cell = cellIndex(target);
+    if (cell == targetCell)
+        return; // Target is still in the same cell, the field is still valid
+
+    targetCell = cell;
+    rebuild();
+}
+
+void FlowField::rebuild() {
+    std::fill(cost.begin(), cost.end(), -1);
+    std::fill(direction.begin(), direction.end(), sf::Vector2f(0, 0));
+    if (targetCell < 0)
+        return;
+
+    // Breadth-first search outwards from the target. The target cell is always
+    // seeded, even when the player stands inside the inflated ground margin.
+    frontier.clear();
+    frontier.push_back(targetCell);
+    cost[targetCell] = 0;
+    for (size_t head = 0; head < frontier.size(); ++head) {
+        int cell = frontier[head];
+        int x = cell % columns;
+        int y = cell / columns;
+        const int offsets[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+        for (const auto& offset : offsets) {
+            int nx = x + offset[0];
+            int ny = y + offset[1];
+            if (nx < 0 || ny < 0 || nx >= columns || ny >= rows)
+                continue;
+            int next = ny * columns + nx;
+            if (blocked[next] || cost[next] != -1)
+                continue;
+            cost[next] = cost[cell] + 1;
+            frontier.push_back(next);
+        }
+    }
+
+    // Point every reached cell at its cheapest neighbour, diagonals included
+    // as long as they don't cut a blocked corner
+    const float diagonal = 1.0f / std::sqrt(2.0f);
+    for (int cell : frontier) {
+        if (cell == targetCell)
+            continue;
+        int x = cell % columns;
+        int y = cell / columns;
+        int best = cost[cell];
+        sf::Vector2f bestDirection(0, 0);
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int nx = x + dx;
+                int ny = y + dy;
+                if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= columns || ny >= rows)
+                    continue;
+                int next = ny * columns + nx;
+                if (cost[next] < 0 || cost[next] >= best)
+                    continue;
+                if (dx != 0 && dy != 0 && (blocked[y * columns + nx] || blocked[ny * columns + x]))
+                    continue;
+                best = cost[next];
+                bestDirection = (dx != 0 && dy != 0)
+                    ? sf::Vector2f(dx * diagonal, dy * diagonal)
+                    : sf::Vector2f(static_cast<float>(dx), static_cast<float>(dy));
+            }
+        }
+        direction[cell] = bestDirection;
+    }
+}
+
+sf::Vector2f FlowField::directionAt(const sf::Vector2f& position) const {
+    int cell = cellIndex(position);
+    if (cell < 0)
+        return sf::Vector2f(0, 0);
+    return direction[cell];
+}
+
+bool FlowField::isBlocked(const sf::Vector2f& position) const {
+    int cell = cellIndex(position);
+    return cell >= 0 && blocked[cell];
+}
+
+int FlowField::cellIndex(const sf::Vector2f& position) const {
+    sf::Vector2f local = position - origin;
+    if (columns == 0 || local.x < 0 || local.y < 0)
+        return -1;
+    int x = static_cast<int>(local.x / CELL_SIZE);
+    int y = static_cast<int>(local.y / CELL_SIZE);
+    if (x >= columns || y >= rows)
+        return -1;
+    return y * columns + x;
+}
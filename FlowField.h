@@ -0,0 +1,39 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "Ground.h"
+
+// Coarse grid over a level that stores, for every open cell, the direction
+// of the shortest obstacle-free path to the target. It is rebuilt only when
+// the target moves into a different cell, and any number of flyers can
+// sample it in O(1).
+class FlowField {
+public:
+    static const int CELL_SIZE = 32;
+
+    FlowField();
+
+    // Member functions
+    void build(const std::vector<Ground>& grounds, float width, float height);
+    void build(const std::vector<Ground>& grounds, const sf::FloatRect& area); // Area need not start at 0,0
+    void setTarget(const sf::Vector2f& target);
+    sf::Vector2f directionAt(const sf::Vector2f& position) const;
+    bool isBlocked(const sf::Vector2f& position) const;
+
+private:
+    int cellIndex(const sf::Vector2f& position) const;
+    void rebuild();
+
+    int columns;
+    int rows;
+    int targetCell;
+    std::vector<sf::Uint8> blocked;      // 1 where a cell overlaps (inflated) ground
+    std::vector<int> cost;               // Steps to the target cell, -1 if unreachable
+    std::vector<sf::Vector2f> direction; // Unit vector towards the next cell on the path
+    std::vector<int> frontier;           // BFS queue, kept around to avoid reallocating
+    sf::Vector2f origin;                 // World position of cell 0
+};
+
+#endif // FLOWFIELD_H
@@ -0,0 +1,32 @@
+#include "GameRandom.h"
+
+thread_local sf::Uint64 randomState = 0x9E3779B97F4A7C15ull;
+
+void SeedGameRandom(sf::Uint32 seed) {
+    // splitmix64 spreads small seeds over the state; xorshift must never hold zero
+    sf::Uint64 z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    randomState = z ? z : 1;
+}
+
+sf::Uint32 GameRandom() {
+    // xorshift64*
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    return static_cast<sf::Uint32>((randomState * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+int GameRandom(int count) {
+    return static_cast<int>(GameRandom() % static_cast<sf::Uint32>(count));
+}
+
+sf::Uint64 GameRandomState() {
+    return randomState;
+}
+
+void SetGameRandomState(sf::Uint64 state) {
+    randomState = state ? state : 1;
+}
@@ -0,0 +1,16 @@
+#ifndef GAMERANDOM_H
+#define GAMERANDOM_H
+
+#include <SFML/Graphics.hpp>
+
+// Gameplay randomness: chest contents, drops, waves and room order. Each
+// thread has its own generator, since balance runs whole games side by side.
+// The full 64-bit state goes into snapshots, so a restore replays exactly.
+void SeedGameRandom(sf::Uint32 seed);
+sf::Uint32 GameRandom();
+int GameRandom(int count);  // 0 to count - 1
+
+sf::Uint64 GameRandomState();
+void SetGameRandomState(sf::Uint64 state);
+
+#endif // GAMERANDOM_H
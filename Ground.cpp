@@ -6,16 +6,16 @@ using namespace sf;
 Ground::Ground(float x, float y, float width, float height) {
     shape.setSize(sf::Vector2f(width, height));
     shape.setPosition(x, y);
-    shape.setFillColor(sf::Color(21,21,28));  
+    shape.setFillColor(GROUND_COLOR);
 }
 Ground::Ground(float y, float width, float height) {
     shape.setSize(sf::Vector2f(width, height));
     shape.setPosition(0, y);
-    shape.setFillColor(sf::Color(21, 21, 28));
+    shape.setFillColor(GROUND_COLOR);
 }
 
-void Ground::draw(sf::RenderWindow& window) {
-    window.draw(shape);
+void Ground::draw(RenderQueue& queue) {
+    queue.submit(RenderLayer::Ground, shape);
 }
 
 sf::FloatRect Ground::getBounds() const {
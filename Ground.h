@@ -2,12 +2,15 @@
 #define GROUND_H
 
 #include <SFML/Graphics.hpp>
+#include "RenderQueue.h"
+
+const sf::Color GROUND_COLOR(21, 21, 28);
 
 class Ground {
 public:
     Ground(float x, float y, float width, float height);  
     Ground(float y, float width, float height);
-    void draw(sf::RenderWindow& window);                  
+    void draw(RenderQueue& queue);                  
     sf::FloatRect getBounds() const;                     
 
 private:
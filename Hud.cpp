@@ -0,0 +1,93 @@
+#include "Hud.h"
+#include "World.h"
+#include <iostream>
+
+const float HEALTH_BAR_WIDTH = 200.0f;
+const float HEALTH_BAR_HEIGHT = 20.0f;
+
+Hud::Hud() : shownCurrency(-1), shownWave(0) {
+    if (!font.loadFromFile("Textures/font.ttf")) {
+        std::cerr << "Failed to load font!" << std::endl;
+    }
+
+    currencyText.setFont(font);
+    currencyText.setCharacterSize(24);
+    currencyText.setFillColor(sf::Color::White);
+    currencyText.setStyle(sf::Text::Bold);
+
+    healthBarText.setFont(font);
+    healthBarText.setCharacterSize(24);
+    healthBarText.setFillColor(sf::Color::White);
+    healthBarText.setStyle(sf::Text::Bold);
+    healthBarText.setString("Health:");
+    healthBarText.setPosition(0, 0);
+
+    healthBarBackground.setSize(sf::Vector2f(HEALTH_BAR_WIDTH, HEALTH_BAR_HEIGHT));
+    healthBarBackground.setFillColor(sf::Color(50, 50, 50));
+    healthBarBackground.setPosition(20, 40);
+
+    healthBar.setSize(sf::Vector2f(HEALTH_BAR_WIDTH, HEALTH_BAR_HEIGHT));
+    healthBar.setFillColor(sf::Color::Red);
+    healthBar.setPosition(20, 40);
+
+    statsText.setFont(font);
+    statsText.setCharacterSize(20);
+    statsText.setFillColor(sf::Color::Red);
+    statsText.setPosition(10, SCREEN_HEIGHT / 8);
+
+    waveText.setFont(font);
+    waveText.setCharacterSize(32);
+    waveText.setFillColor(sf::Color::Yellow);
+    waveText.setStyle(sf::Text::Bold);
+
+    controlsText.setFont(font);
+    controlsText.setCharacterSize(24);
+    controlsText.setFillColor(sf::Color::White);
+    controlsText.setString(
+        "Controls:\n"
+        "WASD / Arrow Keys - Move\n"
+        "Space - Jump\n"
+        "Left Mouse Click / J / X - Swing Weapon\n"
+        "K - Throw Shuriken\n"
+        "Backspace - Rewind\n"
+        "E - Open Chest/Shop\n"
+        "Shift - Dash"
+    );
+    sf::FloatRect controlsBounds = controlsText.getLocalBounds();
+    controlsText.setPosition(SCREEN_WIDTH / 2 - controlsBounds.width / 2, SCREEN_HEIGHT / 4);
+}
+
+void Hud::draw(sf::RenderTarget& target, const HudState& state) {
+    target.setView(target.getDefaultView());
+
+    if (state.currency != shownCurrency) {
+        shownCurrency = state.currency;
+        currencyText.setString("Currency: " + std::to_string(state.currency));
+        currencyText.setPosition(SCREEN_WIDTH - currencyText.getLocalBounds().width - 10, 10);
+    }
+    if (state.wave != shownWave) {
+        shownWave = state.wave;
+        waveText.setString("Wave " + std::to_string(state.wave));
+        waveText.setPosition(SCREEN_WIDTH / 2 - waveText.getLocalBounds().width / 2, 10);
+    }
+    healthBar.setSize(sf::Vector2f(HEALTH_BAR_WIDTH * state.health / 10, HEALTH_BAR_HEIGHT));
+
+    if (state.showControls)
+        target.draw(controlsText);
+    drawStats(target, state.stats);
+    target.draw(currencyText);
+    if (state.wave)
+        target.draw(waveText);
+    target.draw(healthBarText);
+    target.draw(healthBarBackground);
+    target.draw(healthBar);
+}
+
+void Hud::drawStats(sf::RenderTarget& target, const std::string& stats) {
+    if (stats != shownStats) {
+        shownStats = stats;
+        statsText.setString(stats);
+    }
+    target.setView(target.getDefaultView());
+    target.draw(statsText);
+}
@@ -0,0 +1,41 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <SFML/Graphics.hpp>
+#include <string>
+
+// What the HUD shows, copied out of the game each frame
+struct HudState {
+    int currency;
+    float health;
+    std::string stats;
+    bool showControls;   // Level 0 teaches the controls
+    int wave;            // Survivor wave, 0 outside survivor mode
+};
+
+// Screen-space overlay: health bar, currency, player stats and the controls
+// panel. It owns its font and texts, so it can live on whichever thread
+// draws the frame.
+class Hud {
+public:
+    Hud();
+
+    // Member functions
+    void draw(sf::RenderTarget& target, const HudState& state);
+    void drawStats(sf::RenderTarget& target, const std::string& stats);
+
+private:
+    sf::Font font;
+    sf::Text currencyText;
+    sf::Text healthBarText;
+    sf::Text statsText;
+    sf::Text controlsText;
+    sf::Text waveText;
+    sf::RectangleShape healthBarBackground;
+    sf::RectangleShape healthBar;
+    int shownCurrency;   // Texts are only rebuilt when their value changes
+    int shownWave;
+    std::string shownStats;
+};
+
+#endif // HUD_H
@@ -0,0 +1,27 @@
+#include "Input.h"
+#include <SFML/Window.hpp>
+
+PlayerInput PlayerInput::poll(sf::Uint32 sequence) {
+    PlayerInput input;
+    input.sequence = sequence;
+
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::A) || sf::Keyboard::isKeyPressed(sf::Keyboard::Left))
+        input.buttons |= Left;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::D) || sf::Keyboard::isKeyPressed(sf::Keyboard::Right))
+        input.buttons |= Right;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::W) || sf::Keyboard::isKeyPressed(sf::Keyboard::Up))
+        input.buttons |= Up;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::S) || sf::Keyboard::isKeyPressed(sf::Keyboard::Down))
+        input.buttons |= Down;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space))
+        input.buttons |= Jump;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::LShift))
+        input.buttons |= Dash;
+    if (sf::Mouse::isButtonPressed(sf::Mouse::Left) || sf::Keyboard::isKeyPressed(sf::Keyboard::J) ||
+        sf::Keyboard::isKeyPressed(sf::Keyboard::X))
+        input.buttons |= Attack;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::K))
+        input.buttons |= Throw;
+
+    return input;
+}
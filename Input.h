@@ -0,0 +1,30 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <SFML/Graphics.hpp>
+
+// Buttons held by a player during one simulation tick. The player code only
+// ever reads this, never the keyboard, so the same simulation runs from local
+// keys, network packets or bots.
+struct PlayerInput {
+    enum Button : sf::Uint8 {
+        Left = 1 << 0,
+        Right = 1 << 1,
+        Up = 1 << 2,
+        Down = 1 << 3,
+        Jump = 1 << 4,
+        Dash = 1 << 5,
+        Attack = 1 << 6,
+        Throw = 1 << 7
+    };
+
+    sf::Uint32 sequence = 0; // Increases by one per tick, used to acknowledge inputs over the network
+    sf::Uint8 buttons = 0;
+
+    bool held(Button button) const { return (buttons & button) != 0; }
+
+    // Reads the local keyboard and mouse
+    static PlayerInput poll(sf::Uint32 sequence);
+};
+
+#endif // INPUT_H
@@ -2,6 +2,7 @@
 #define ITEM_H
 
 #include <string>
+#include <vector>
 
 class Item
 {
@@ -9,19 +10,21 @@ public:
     // Default constructor
     Item()
         : name("Unknown"), damage(0), health(0),
-        damageMultiplier(1.0f), price(0) {}
+        damageMultiplier(1.0f), price(0), projectiles(0), duration(0.0f) {}
 
     // Parameterized constructor
     Item(const std::string& name, int damage, int health,
-        float damageMultiplier, int price)
+        float damageMultiplier, int price, int projectiles = 0, float duration = 0.0f)
         : name(name), damage(damage), health(health),
-        damageMultiplier(damageMultiplier), price(price){}
+        damageMultiplier(damageMultiplier), price(price), projectiles(projectiles), duration(duration){}
 
     // Getters for the properties
-    std::string getName() const { return name; }
+    const std::string& getName() const { return name; }
     int getDamage() const { return damage; }
     int getHealth() const { return health; }
     int getPrice() const { return price; }
+    int getProjectiles() const { return projectiles; }
+    float getDuration() const { return duration; }
 
     float getDamageMultiplier() const { return damageMultiplier; }
 
@@ -31,6 +34,51 @@ private:
     int damage;                // Damage value of the item (if it's a weapon)
     int health;                // Health value (if it's a healing item)
     float damageMultiplier;    // Damage multiplier
+    int projectiles;           // Extra shuriken thrown per volley
+    float duration;            // Seconds its modifiers last once bought, 0 for good
 };
 
+// Index of an item in ItemCatalog. Inventories, chests and saves hold these
+// instead of Item copies, so each item's name exists exactly once.
+typedef unsigned char ItemId;
+
+// An inventory entry: one item and how many of it are owned
+struct ItemStack {
+    ItemId id;
+    unsigned char count;
+};
+
+// Every item that can show up in a chest, built once on first use. Tuning
+// files may rewrite entries between ticks but never add or remove one, so
+// ItemIds stay valid.
+inline std::vector<Item>& EditableItemCatalog()
+{
+    static std::vector<Item> catalog = {
+        Item("Flaming Sword", 5, 0, 1.5f, 100),
+        Item("Small Health Potion", 0, 2, 1.0f, 20),
+        Item("Full Health Potion", 0, 9, 1.0f, 50),
+        Item("Sword of Shadows", 0, 0, 1.2f, 100),
+        Item("Enchanted Sword", 4, 0, 1.1f, 75),
+        Item("Totem of Undying", 1, 0, 1.5f, 150),
+        Item("Shuriken Pouch", 0, 0, 1.0f, 60, 2),
+        Item("Rage Potion", 0, 0, 2.0f, 40, 0, 10.0f),
+    };
+    return catalog;
+}
+
+inline const std::vector<Item>& ItemCatalog()
+{
+    return EditableItemCatalog();
+}
+
+inline const Item& GetItem(ItemId id)
+{
+    return ItemCatalog()[id];
+}
+
+inline bool IsValidItem(int id)
+{
+    return id >= 0 && id < static_cast<int>(ItemCatalog().size());
+}
+
 #endif // !ITEM_H
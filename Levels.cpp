@@ -3,22 +3,71 @@
 #include <Windows.h>
 #include <iostream>
 #include <vector>
+#include <cstdlib>
+#include <algorithm>
 
 #include "PlayerCharacter.h"
 #include "Ground.h"
+#include "World.h"
 #include "Enemy.h"
+#include "Terrain.h"
+#include "FlowField.h"
+#include "NavGraph.h"
+#include "Object.h"
+#include "WorldStream.h"
+#include "WaveDirector.h"
+#include "GameRandom.h"
+
+sf::Texture& TextureManager(const std::string& texturePath);
+
+const int ROOM_COUNT = 10;                   // Rooms 1..ROOM_COUNT come up at random on each exit
+const int STREAMED_LEVEL = ROOM_COUNT + 1;   // The long scrolling level, in the same rotation
+const int STREAMED_CHUNKS = 24;              // Screens it is wide
+const sf::Uint32 STREAMED_SEED = 0x5EED0B1Eu; // Fixed, so the long level is the same every time
+const int SURVIVOR_LEVEL = ROOM_COUNT + 2;    // Endless waves in one arena, picked from the main menu
+
+// Level behind the right-hand exit of a cleared room
+inline int NextLevelNumber()
+{
+	return GameRandom(ROOM_COUNT + 1) + 1;
+}
+
+// Groups enemies by archetype so each group runs one specialised update loop.
+// New enemies arrive a few at a time behind an already grouped list, so each
+// one out of place is rotated to the end of its group: stable, like the
+// snapshot deltas need, and in place, so nothing is allocated.
+inline void GroupByArchetype(std::vector<Enemy>& enemies)
+{
+	auto byArchetype = [](const Enemy& a, const Enemy& b) { return a.archetype() < b.archetype(); };
+	std::vector<Enemy>::iterator grouped = std::is_sorted_until(enemies.begin(), enemies.end(), byArchetype);
+	for (; grouped != enemies.end(); ++grouped)
+		std::rotate(std::upper_bound(enemies.begin(), grouped, *grouped, byArchetype), grouped, grouped + 1);
+}
+
 class Level
 {
 public:
 	// Constructor
-	Level(int level, float width, float height) : levelNumber(level)
+	Level(int level, float width, float height) : levelNumber(level), bounds(0, 0, width, height)
 	{
 		switch (levelNumber)
 		{
+		case STREAMED_LEVEL:
+			// Grounds and enemies arrive chunk by chunk as the player moves, see updateStream
+			spawnPosition = sf::Vector2f(40, height * 7 / 8);
+			stream.reset(STREAMED_SEED, STREAMED_CHUNKS, width, height);
+			bounds = stream.worldArea();
+			return;
 		case 0:
 			spawnPosition = sf::Vector2f(width / 2, height * 7 / 8);
 			grounds = std::vector<Ground>{ Ground(height * 7 / 8,width,height) };
 			break;
+		case SURVIVOR_LEVEL:
+			spawnPosition = sf::Vector2f(width / 2, height * 7 / 8);
+			grounds = std::vector<Ground>{ Ground(height * 7 / 8,width,height),
+				Ground(width / 8, height / 2, width / 4, height / 16),
+				Ground(width * 5 / 8, height / 2, width / 4, height / 16) };
+			break; // The director starts in populate, or picks up a restored snapshot's waves
 		case 1:
 			spawnPosition = sf::Vector2f(0, height / 2);
 			grounds = std::vector<Ground>{ Ground(height / 2,width / 2,height),
@@ -68,13 +117,120 @@ public:
 			grounds = std::vector<Ground>{ Ground(height * 7 / 8,width,height) };
 			break;
 		}
+
+		// Collision probes, and pathfinding for flying and ground enemies
+		terrain.build(grounds, bounds);
+		flowField.build(grounds, width, height);
+		navGraph.build(grounds);
+	}
+
+	// Loads the chunks around focus on a streamed level, freezing enemies that fall
+	// outside them. True when the loaded set changed (enemies may have been added).
+	bool updateStream(const sf::Vector2f& focus, std::vector<Enemy>& enemies)
+	{
+		if (!stream.update(focus, grounds, enemies))
+			return false;
+		terrain.build(grounds, stream.activeArea());
+		flowField.build(grounds, stream.activeArea());
+		navGraph.build(grounds);
+		return true;
+	}
+
+	// After a snapshot restore the live enemies are the snapshot's; line the
+	// stream up with them instead of spawning the chunks around focus again
+	void resumeStream(const sf::Vector2f& focus, std::vector<Enemy>& enemies)
+	{
+		if (!stream.isStreaming())
+			return;
+		stream.resume(focus, grounds, enemies);
+		terrain.build(grounds, stream.activeArea());
+		flowField.build(grounds, stream.activeArea());
+		navGraph.build(grounds);
+	}
+
+	// Survivor waves; spawns only while enemyCap has room. True when enemies were added.
+	bool updateWaves(float deltaTime, std::vector<Enemy>& enemies, const sf::Vector2f& player, int enemyCap)
+	{
+		return director.update(deltaTime, enemies, player, enemyCap);
+	}
+
+	// Where a player who fell in at position comes back
+	sf::Vector2f respawnPosition(const sf::Vector2f& position) const
+	{
+		if (!stream.isStreaming())
+			return spawnPosition;
+		// Every chunk starts on solid floor
+		return sf::Vector2f(stream.chunkLeft(position.x) + spawnPosition.x, spawnPosition.y);
+	}
+
+	// Spawns this room's enemies and chests, replacing whatever was there
+	void populate(std::vector<Enemy>& enemies, std::vector<Object>& objects, float width, float height)
+	{
+		sf::Texture& Chest = TextureManager("Textures/Chest.png");
+
+		enemies.clear();
+		objects.clear();
+		if (stream.isStreaming()) {
+			updateStream(spawnPosition, enemies);
+			return;
+		}
+		switch (levelNumber) {
+		case 0:
+			objects = { Object(sf::Vector2f(width / 2 - 81,height * 7 / 8 - 60),Chest,true) };
+			break;
+		case SURVIVOR_LEVEL:
+			// No fixed spawns: the director sends waves from here on
+			enemies.reserve(PerformanceBudget::MAX_ENEMIES);
+			director.start(bounds);
+			break;
+		case 1:
+			enemies = { Enemy(sf::Vector2f(width / 4, height / 2), WALKER_KIND),
+				Enemy(sf::Vector2f(width * 3 / 4, height * 7/8 ), WEAK_WALKER_KIND) };
+			break;
+		case 9:
+		case 4:
+			enemies = { Enemy(sf::Vector2f(width / 4, height * 7 / 8), WALKER_KIND),
+				Enemy(sf::Vector2f(width * 3 / 4, height / 2 ), WEAK_WALKER_KIND) };
+			break;
+		case 2:
+			enemies = { Enemy(sf::Vector2f(width * 3 / 4, height / 2), FLYER_KIND), 
+		   Enemy(sf::Vector2f(width / 2, height / 4), FLYER_KIND) };
+			break;
+		case 3:
+			enemies = { Enemy(sf::Vector2f(width * 3 / 4, height / 4), FLYER_KIND),
+			Enemy(sf::Vector2f(width / 4, height / 2), FLYER_KIND) };
+			break;
+		case 6:
+			enemies = { Enemy(sf::Vector2f(width * 3 / 4, height * 7 / 8), CHARGER_KIND) };
+			break;
+		case 7:
+			enemies = { Enemy(sf::Vector2f(width / 2, height / 3), WEAK_WALKER_KIND),
+			Enemy(sf::Vector2f(width / 2, height * 7 / 8), WALKER_KIND),
+			Enemy(sf::Vector2f(width / 2, height * 7 / 8), WALKER_KIND) };
+			break;
+		case 8:
+			enemies = { Enemy(sf::Vector2f(width * 3 / 4, height / 2), CHARGER_KIND),
+				Enemy(sf::Vector2f(width / 2, height / 4), FLYER_KIND)
+			};
+			break;
+		case 5:
+		case 10:
+			objects = { Object(sf::Vector2f(width / 2 - 81,height / 2 - 60),Chest,true) };
+			break;
+		}
 	}
 
 	// Variables
 	std::vector<Ground> grounds;
 	std::vector<Enemy> enemies;
 	sf::Vector2f spawnPosition;
+	Terrain terrain;       // Bitmap of the grounds, for probes and drawing
+	FlowField flowField;
+	NavGraph navGraph;
 	int levelNumber;
+	sf::FloatRect bounds;  // Whole level, one screen for rooms
+	WorldStream stream;    // Only used by the streamed level
+	WaveDirector director; // Only used by the survivor arena
 
 private:
 };
\ No newline at end of file
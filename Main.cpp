@@ -4,11 +4,29 @@
 #include <Windows.h>
 #include <vector>
 #include <iostream>
+#include <cstdlib>
+#include <memory>
+#include <fstream>
 
 #include "PlayerCharacter.h"
 #include "Ground.h"
+#include "World.h"
 #include "Enemy.h"
 #include "Object.h"
+#include "Projectile.h"
+#include "Particles.h"
+#include "RenderQueue.h"
+#include "RenderThread.h"
+#include "Telemetry.h"
+#include "AllocationTracker.h"
+#include "Snapshot.h"
+#include "Rewind.h"
+#include "Server.h"
+#include "Client.h"
+#include "Balance.h"
+#include "WaveDirector.h"
+#include "Tuning.h"
+#include "GameRandom.h"
 
 #include "Item.cpp"
 #include "Levels.cpp"
@@ -17,32 +35,47 @@ using namespace sf;
 
 // Constants
 const std::string gameName = "Ninja Survivor";
-const double movementSpeed = 500;
 
-const float HEALTH_BAR_WIDTH = 200.0f;
-const float HEALTH_BAR_HEIGHT = 20.0f;
+const float SIM_TICK = 1.0f / 120; // Simulation step cap; drawing runs at its own rate
 
-const float SCREEN_WIDTH = 1280;
-const float SCREEN_HEIGHT = 720;
+const std::string AUTOSAVE_PATH = "autosave.sav";
+const std::string TELEMETRY_PATH = "telemetry.json";  // Written on exit, and on F9
+const std::string TUNING_DIRECTORY = "Tuning";
 
 // Global Variables
 int totalLevels;
 int LevelNumber = -1;
-int gravity = 500;
 int currency = 0;
 bool isShopping = false;
 bool isPaused = false;
 bool gameOver = false;
 bool forceReload = false;
+bool isRewinding = false;            // World is frozen while history plays backwards
+WorldSnapshot checkpoint;            // Taken on entering each room, used by Retry
+AutosaveWriter autosave(AUTOSAVE_PATH);
+RewindBuffer rewindBuffer;
+WorldSnapshot rewindFrame;
+RenderThread renderThread;           // Draws gameplay frames; menus draw on the main thread
+PerformanceBudget frameBudget(SIM_TICK, 1.0f / 60); // Survivor enemy cap, from measured tick and render costs
+TuningFiles tuningFiles(TUNING_DIRECTORY);           // Watched while playing, so balance edits show up live
 
 // Function Prototypes
-void MainMenu(RenderWindow& window, bool& inMainMenu);
-void DisplayInstructions(RenderWindow& window);
+void MainMenu(RenderWindow& window, bool& inMainMenu, bool canContinue);
 Texture& TextureManager(const std::string& texturePath);
-static void LevelManager(Player& player, Level& level, int& prev, float deltaTime, RenderWindow& window, std::vector<Enemy>& enemies, std::vector<Object>& objects);
-void DeathMenu(Player& player, Level& level, int& prev, float deltaTime, RenderWindow& window, std::vector<Enemy>& enemies, std::vector<Object>& objects);
+static void LevelManager(Player& player, Level& level, int& prev, float deltaTime, RenderWindow& window, std::vector<Enemy>& enemies, std::vector<Object>& objects, ProjectilePool& projectiles);
+static void SimulateTick(Player& player, Level& level, int& prev, float deltaTime, RenderWindow& window, const PlayerInput& input, std::vector<Enemy>& enemies, std::vector<Object>& objects, ProjectilePool& projectiles);
+static void DrawWorld(RenderQueue& queue, Level& level, Player& player, std::vector<Enemy>& enemies, std::vector<Object>& objects, ProjectilePool& projectiles);
+static void RecordFrame(RenderFrame& frame, View& camera, Level& level, Player& player, std::vector<Enemy>& enemies, std::vector<Object>& objects, ProjectilePool& projectiles);
+void DeathMenu(Player& player, Level& level, int& prev, float deltaTime, RenderWindow& window, std::vector<Enemy>& enemies, std::vector<Object>& objects, ProjectilePool& projectiles);
 void enforceBounds(Player& player, int enemies, Level& level);
+Vector2f CameraCentre(const Vector2f& focus, const FloatRect& bounds);
 void PauseMenu(RenderWindow& window, bool& isShopping);
+bool RestoreSnapshot(const WorldSnapshot& snapshot, Player& player, Level& level, int& prev, std::vector<Enemy>& enemies, std::vector<Object>& objects, ProjectilePool& projectiles);
+int RunServer(unsigned short port, int hordeSize);
+int RunClient(RenderWindow& window, const sf::IpAddress& address, unsigned short port);
+int RunLoopbackTest(int botCount, int hordeSize, int seconds);
+int RunBalance(const BalanceConfig& config);
+int RunAllocationCheck(int seconds, int startLevel);
 
 static void AttachConsole() {
     AllocConsole();
@@ -50,51 +83,75 @@ static void AttachConsole() {
     freopen_s(&stream, "CONOUT$", "w", stdout);
 }
 
-int main()
+int main(int argc, char* argv[])
 {
     // Debug
     //AttachConsole();
 
+    // Network modes:
+    //   --server [port] [horde]            headless authoritative server
+    //   --connect <host> [port]            play on a server
+    //   --loopback [bots] [horde] [secs]   server plus bot clients in one process, prints a report
+    //   --balance [runs] [threads] [health scale] [speed scale]
+    //                                      headless bot runs across every core, writes a balance report
+    // Diagnostics:
+    //   --track-allocations                play with allocation counts in the telemetry
+    //   --alloc-check [secs] [level]       scripted headless play, fails if a settled tick allocates
+    std::string mode = argc > 1 ? argv[1] : "";
+    SeedGameRandom(static_cast<sf::Uint32>(time(0)));
+    tuningFiles.loadAll(); // Every mode, before any thread that reads the values starts
+    if (mode == "--server") {
+        return RunServer(argc > 2 ? static_cast<unsigned short>(std::atoi(argv[2])) : NET_DEFAULT_PORT,
+            argc > 3 ? std::atoi(argv[3]) : 500);
+    }
+    if (mode == "--loopback") {
+        return RunLoopbackTest(argc > 2 ? std::atoi(argv[2]) : 16, argc > 3 ? std::atoi(argv[3]) : 500,
+            argc > 4 ? std::atoi(argv[4]) : 10);
+    }
+
+    if (mode == "--balance") {
+        BalanceConfig config;
+        config.playerSpeed = GameTuning().player.movementSpeed;
+        if (argc > 2) config.runs = std::atoi(argv[2]);
+        if (argc > 3) config.threads = std::atoi(argv[3]);
+        if (argc > 4) config.enemyHealthScale = static_cast<float>(std::atof(argv[4]));
+        if (argc > 5) config.enemySpeedScale = static_cast<float>(std::atof(argv[5]));
+        return RunBalance(config);
+    }
+
+    if (mode == "--alloc-check") {
+        return RunAllocationCheck(argc > 2 ? std::atoi(argv[2]) : 20, argc > 3 ? std::atoi(argv[3]) : 1);
+    }
+    if (mode == "--track-allocations")
+        AllocationTracker::setEnabled(true);
+
     RenderWindow window(VideoMode(SCREEN_WIDTH, SCREEN_HEIGHT), gameName);
+    if (mode == "--connect" && argc > 2) {
+        return RunClient(window, sf::IpAddress(argv[2]),
+            argc > 3 ? static_cast<unsigned short>(std::atoi(argv[3])) : NET_DEFAULT_PORT);
+    }
 
     // Game objects
     bool inMainMenu = true;
-    Player player(Vector2f(10, 10), TextureManager("Textures/Player.png"), TextureManager("Textures/Weapon1.png"), movementSpeed);
+    Player player(Vector2f(10, 10), TextureManager("Textures/Player.png"), TextureManager("Textures/Weapon1.png"), GameTuning().player.movementSpeed);
     Level level(-1, SCREEN_WIDTH, SCREEN_HEIGHT);
     std::vector<Enemy> enemies;
     std::vector<Object> objects;
+    static ProjectilePool projectiles; // Large fixed-size pool, kept off the stack
     int previousLevel = LevelNumber;
+    sf::Uint32 inputSequence = 0;
+    View camera(FloatRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT));
 
-    // Font and Text Setup
-    Font font;
-    if (!font.loadFromFile("Textures/font.ttf")) {
-        std::cerr << "Failed to load font!" << std::endl;
-        return -1;
-    }
-    Text currencyText;
-    currencyText.setFont(font);
-    currencyText.setCharacterSize(24); // Font size
-    currencyText.setFillColor(Color::White);
-    currencyText.setStyle(Text::Bold);
-
-    // Health Bar Setup
-    Text healthBarText;
-    healthBarText.setFont(font);
-    healthBarText.setCharacterSize(24); // Font size
-    healthBarText.setFillColor(Color::White);
-    healthBarText.setStyle(Text::Bold);
-    healthBarText.setString("Health:");
-    healthBarText.setPosition(0, 0);
-
-    RectangleShape healthBarBackground(Vector2f(HEALTH_BAR_WIDTH, HEALTH_BAR_HEIGHT));
-    healthBarBackground.setFillColor(Color(50, 50, 50)); // Background color
-    healthBarBackground.setPosition(20, 40);
-
-    RectangleShape healthBar(Vector2f(HEALTH_BAR_WIDTH, HEALTH_BAR_HEIGHT));
-    healthBar.setFillColor(Color::Red); // Health bar color
-    healthBar.setPosition(20, 40);
+    // Saved session to continue from, if there is one
+    WorldSnapshot resume;
+    resume.loadFromFile(AUTOSAVE_PATH);
+    autosave.start();
+    window.setVerticalSyncEnabled(true);
+    renderThread.start(window);
 
     Clock clock;
+    Clock tickClock;
+    Time nextTick = tickClock.getElapsedTime();
 
     // Main game loop
     while (window.isOpen())
@@ -103,15 +160,37 @@ int main()
         Event event;
         while (window.pollEvent(event))
         {
-            if (event.type == Event::Closed)
+            if (event.type == Event::Closed) {
+                renderThread.stop();
                 window.close();
+            }
+            if (event.type == Event::KeyPressed && event.key.code == Keyboard::F9 &&
+                GameTelemetry().writeJson(TELEMETRY_PATH))
+                std::cout << "Telemetry written to " << TELEMETRY_PATH << std::endl;
         }
 
         float deltaTime = clock.restart().asSeconds();
 
+        // Gameplay is drawn by the render thread, everything else right here
+        bool playing = LevelNumber != -1 && !isShopping && !gameOver && !isPaused;
+        if (playing)
+            renderThread.resume();
+        else
+            renderThread.pause();
+
         if (LevelNumber == -1) {
-            MainMenu(window, inMainMenu);
-            if (!inMainMenu) {
+            MainMenu(window, inMainMenu, !resume.empty());
+            if (!resume.empty() && Keyboard::isKeyPressed(Keyboard::C)) {
+                RestoreSnapshot(resume, player, level, previousLevel, enemies, objects, projectiles);
+                rewindBuffer.clear();
+                inMainMenu = false;
+            }
+            else if (Keyboard::isKeyPressed(Keyboard::S)) {
+                // LevelManager builds the arena and the director takes it from there
+                LevelNumber = SURVIVOR_LEVEL;
+                inMainMenu = false;
+            }
+            else if (!inMainMenu) {
                 LevelNumber = 0;
                 level = Level(0, SCREEN_WIDTH, SCREEN_HEIGHT);
                 player.SetPosition(level.spawnPosition);
@@ -120,48 +199,59 @@ int main()
         }
         else if (!isShopping && !gameOver && !isPaused)
         {
-            // Update game
+            GameTelemetry().record(Timing::Frame, seconds(deltaTime));
+            AllocationTracker::Scope tickAllocations;
+            Clock workClock;
 
-            player.update(deltaTime, level.grounds);
-            player.handleCollision(enemies, deltaTime);
-
-            // Update currency text
-            currencyText.setString("Currency: " + std::to_string(currency));
-            currencyText.setPosition(SCREEN_WIDTH - currencyText.getLocalBounds().width - 10, 10);
+            // Update game
+            // Holding Backspace plays recorded history backwards one tick per frame
+            isRewinding = Keyboard::isKeyPressed(Keyboard::Backspace) && rewindBuffer.stepBack(rewindFrame) &&
+                RestoreSnapshot(rewindFrame, player, level, previousLevel, enemies, objects, projectiles);
+
+            PlayerInput input;
+            if (!isRewinding) {
+                Telemetry::Scope timing(Timing::Input);
+                input = PlayerInput::poll(++inputSequence);
+            }
 
             if (sf::Keyboard::isKeyPressed(sf::Keyboard::P)) {
                 isPaused = true;
             }
 
-            // Update health bar
-            float healthPercentage = static_cast<float>(player.getHealth()/10);
-            healthBar.setSize(Vector2f(HEALTH_BAR_WIDTH * healthPercentage, HEALTH_BAR_HEIGHT));
-
-            // Clear, draw, and display
-            window.clear(Color(18, 32, 32));
+            // Edited tuning files take effect here, between ticks
+            if (tuningFiles.poll())
+                player.SetSpeed(GameTuning().player.movementSpeed);
 
-            for (Ground& ground : level.grounds)
-                ground.draw(window);
+            SimulateTick(player, level, previousLevel, deltaTime, window, input, enemies, objects, projectiles);
 
-            LevelManager(player, level, previousLevel, deltaTime, window, enemies,objects);
-            // Display instructions if in level 0
-            if (LevelNumber == 0) {
-                DisplayInstructions(window);
+            // Hand the render thread a copy of this tick
+            {
+                Telemetry::Scope timing(Timing::Draw);
+                RecordFrame(renderThread.frame(), camera, level, player, enemies, objects, projectiles);
+                renderThread.publish();
+            }
+            frameBudget.report(workClock.getElapsedTime(), renderThread.renderTime(), static_cast<int>(enemies.size()));
+
+            GameTelemetry().sample(Counter::Enemies, static_cast<int>(enemies.size()));
+            GameTelemetry().sample(Counter::Projectiles, projectiles.size());
+            GameTelemetry().sample(Counter::Particles, Particles().size());
+            if (AllocationTracker::isEnabled()) {
+                AllocationCount allocated = tickAllocations.allocated();
+                GameTelemetry().sample(Counter::Allocations, static_cast<int>(allocated.count));
+                GameTelemetry().sample(Counter::AllocatedBytes, static_cast<int>(allocated.bytes));
             }
 
-            player.draw(window);
-
-            window.draw(currencyText);
-            window.draw(healthBarText);
-            window.draw(healthBarBackground);
-            window.draw(healthBar);
-
-            window.display();
-
+            // Nothing presents on this thread any more, so cap the tick rate here
+            nextTick += seconds(SIM_TICK);
+            Time now = tickClock.getElapsedTime();
+            if (nextTick > now)
+                sleep(nextTick - now);
+            else if (now - nextTick > seconds(0.25f))
+                nextTick = now; // Fell far behind; don't try to catch up in a burst
         }
         else if (gameOver)
         {
-            DeathMenu(player, level, previousLevel, deltaTime, window, enemies, objects);
+            DeathMenu(player, level, previousLevel, deltaTime, window, enemies, objects, projectiles);
         }
         else if (isPaused) {
             PauseMenu(window, isPaused);
@@ -176,10 +266,28 @@ int main()
         
     }
 
+    renderThread.stop();
+    autosave.stop();
+    GameTelemetry().writeJson(TELEMETRY_PATH);
     return 0;
 }
 
-static void LevelManager(Player& player, Level& level, int& prev, float deltaTime, RenderWindow& window, std::vector<Enemy>& enemies, std::vector<Object>& objects)
+// One gameplay tick: the player acts first, then the level and everything in it
+static void SimulateTick(Player& player, Level& level, int& prev, float deltaTime, RenderWindow& window, const PlayerInput& input, std::vector<Enemy>& enemies, std::vector<Object>& objects, ProjectilePool& projectiles)
+{
+    if (!isRewinding) {
+        Telemetry::Scope timing(Timing::Player);
+        player.update(deltaTime, level.terrain, input);
+        player.handleCollision(enemies, deltaTime);
+        player.throwProjectiles(projectiles, deltaTime, input);
+    }
+
+    LevelManager(player, level, prev, deltaTime, window, enemies, objects, projectiles);
+    if (!isRewinding)
+        rewindBuffer.record(player, enemies, objects, projectiles, level.director, LevelNumber, currency);
+}
+
+static void LevelManager(Player& player, Level& level, int& prev, float deltaTime, RenderWindow& window, std::vector<Enemy>& enemies, std::vector<Object>& objects, ProjectilePool& projectiles)
 {
 
     // Restart the game if the player's health is 0
@@ -188,83 +296,88 @@ static void LevelManager(Player& player, Level& level, int& prev, float deltaTim
         return;
     }
 
-    Texture Enemy1 = TextureManager("Textures/Enemy1.png");
-    Texture Enemy2 = TextureManager("Textures/Enemy2.png");
-    Texture Enemy3 = TextureManager("Textures/Enemy3.png");
-    Texture Enemy4 = TextureManager("Textures/Enemy4.png");
-    Texture Chest = TextureManager("Textures/Chest.png");
-
-
     // Checking if level changed or force reload
     if (LevelNumber != prev || forceReload)
     {
         std::cout << LevelNumber << std::endl;
         objects.clear();
+        projectiles.clear();
+        Particles().clear();
         level = Level(LevelNumber, SCREEN_WIDTH, SCREEN_HEIGHT);
         prev = LevelNumber;
         player.SetPosition(level.spawnPosition);
-        switch (LevelNumber) {
-        case 0:
-            objects = { Object(sf::Vector2f(SCREEN_WIDTH / 2 - 81,SCREEN_HEIGHT * 7 / 8 - 60),Chest,true) };
-            break;
-        case 1:
-            enemies = { Enemy(sf::Vector2f(SCREEN_WIDTH / 4, SCREEN_HEIGHT / 2), Enemy1,100,10,false, false),
-                Enemy(sf::Vector2f(SCREEN_WIDTH * 3 / 4, SCREEN_HEIGHT * 7/8 ), Enemy3,100,3,false, false) };
-            break;
-        case 9:
-        case 4:
-            enemies = { Enemy(sf::Vector2f(SCREEN_WIDTH / 4, SCREEN_HEIGHT * 7 / 8), Enemy1,100,10,false, false),
-                Enemy(sf::Vector2f(SCREEN_WIDTH * 3 / 4, SCREEN_HEIGHT / 2 ), Enemy3,100,3,false, false) };
-            break;
-        case 2:
-            enemies = { Enemy(sf::Vector2f(SCREEN_WIDTH * 3 / 4, SCREEN_HEIGHT / 2), Enemy4,150,3,true, false), 
-           Enemy(sf::Vector2f(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 4), Enemy4, 150 ,3,true, false) };
-            break;
-        case 3:
-            enemies = { Enemy(sf::Vector2f(SCREEN_WIDTH * 3 / 4, SCREEN_HEIGHT / 4), Enemy4,150,3,true, false),
-            Enemy(sf::Vector2f(SCREEN_WIDTH / 4, SCREEN_HEIGHT / 2), Enemy4,150,3,true, false) };
-            break;
-        case 6:
-            enemies = { Enemy(sf::Vector2f(SCREEN_WIDTH * 3 / 4, SCREEN_HEIGHT * 7 / 8), Enemy2,150,20,false,true) };
-            break;
-        case 7:
-            enemies = { Enemy(sf::Vector2f(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 3), Enemy3,100,3,false,false),
-            Enemy(sf::Vector2f(SCREEN_WIDTH / 2, SCREEN_HEIGHT * 7 / 8), Enemy1,100,10,false,false),
-            Enemy(sf::Vector2f(SCREEN_WIDTH / 2, SCREEN_HEIGHT * 7 / 8), Enemy1,100,10,false,false) };
-            break;
-        case 8:
-            enemies = { Enemy(sf::Vector2f(SCREEN_WIDTH * 3 / 4, SCREEN_HEIGHT / 2), Enemy2,150,20,false,true),
-                Enemy(sf::Vector2f(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 4), Enemy4, 150 ,3,true, false)
-            };
-            break;
-        case 5:
-        case 10:
-            objects = { Object(sf::Vector2f(SCREEN_WIDTH / 2 - 81,SCREEN_HEIGHT / 2 - 60),Chest,true) };
-            break;
-        }
+        WorldBounds() = level.bounds;
+        level.populate(enemies, objects, SCREEN_WIDTH, SCREEN_HEIGHT);
+        GroupByArchetype(enemies);
         forceReload = false;
+
+        // Checkpoint the fresh room for Retry and hand a copy to the autosave thread
+        checkpoint.capture(player, enemies, objects, projectiles, level.director, LevelNumber, currency);
+        autosave.request(checkpoint);
     }
     
-    enforceBounds(player, enemies.size(),level);
+    if (!isRewinding)
+        enforceBounds(player, enemies.size(),level);
+
+    // Streamed levels load chunks ahead of the player and freeze the ones left behind
+    if (!isRewinding && level.updateStream(player.position(), enemies))
+        GroupByArchetype(enemies);
+
+    // Survivor waves keep coming, as many at once as the machine keeps up with
+    if (!isRewinding && level.updateWaves(deltaTime, enemies, player.position(), frameBudget.enemyCap()))
+        GroupByArchetype(enemies);
 
     for (Object& object: objects)
     {
-        if (player.getBounds().intersects(object.getBounds()) && sf::Keyboard::isKeyPressed(sf::Keyboard::E)) {
-            object.interact(player, player.items, window, currency); // Interact with the object
+        if (!isRewinding && player.getBounds().intersects(object.getBounds()) && sf::Keyboard::isKeyPressed(sf::Keyboard::E)) {
+            renderThread.pause(); // The shop menu draws on this thread
+            object.interact(player, window, currency); // Interact with the object
             isShopping = true;
         }
-        object.draw(window);
     }
     // Enemy Management
-    for (Enemy& enemy : enemies)
+    level.flowField.setTarget(player.position()); // Only recomputed when the player changes cell
+    level.navGraph.setGoal(player.position() + Vector2f(0, player.getBounds().height / 2));
     {
-        if (!enemy.isAlive())
-            continue;
-        enemy.update(deltaTime, level.grounds, currency);
-        enemy.setTarget(player.position());
-        enemy.draw(window);
+        Telemetry::Scope timing(Timing::Enemies);
+        // Sized like the list, which the arena reserves for its largest horde, so a growing horde doesn't allocate
+        Enemy::reserveGroups(enemies.capacity());
+        Enemy* enemyData = enemies.data();
+        for (size_t first = 0; !isRewinding && first < enemies.size();)
+        {
+            size_t last = first + 1;
+            while (last < enemies.size() && enemies[last].archetype() == enemies[first].archetype())
+                ++last;
+
+            switch (enemies[first].archetype()) {
+            case EnemyArchetype::Walker:
+                Enemy::updateGroup<WalkerBehaviour>(enemyData + first, enemyData + last, deltaTime, level.terrain,
+                    level.flowField, level.navGraph, projectiles, player.position(), currency);
+                break;
+            case EnemyArchetype::Flyer:
+                Enemy::updateGroup<FlyerBehaviour>(enemyData + first, enemyData + last, deltaTime, level.terrain,
+                    level.flowField, level.navGraph, projectiles, player.position(), currency);
+                break;
+            case EnemyArchetype::Charger:
+                Enemy::updateGroup<ChargerBehaviour>(enemyData + first, enemyData + last, deltaTime, level.terrain,
+                    level.flowField, level.navGraph, projectiles, player.position(), currency);
+                break;
+            }
+            first = last;
+        }
+    }
+
+    // Projectiles: integrate, then one batched collision pass against enemies, terrain and player
+    if (!isRewinding) {
+        Telemetry::Scope timing(Timing::Collision);
+        projectiles.update(deltaTime);
+        projectiles.resolveCollisions(enemies, level.terrain, player);
     }
 
+    // Effects
+    if (!isRewinding)
+        Particles().update(deltaTime);
+
     enemies.erase(std::remove_if(enemies.begin(), enemies.end(), [](Enemy& enemy) {
         return !enemy.isAlive(); // Remove if the enemy is not alive
         }), enemies.end());
@@ -277,9 +390,11 @@ static void LevelManager(Player& player, Level& level, int& prev, float deltaTim
 Texture& TextureManager(const std::string& texturePath) {
     static std::map<std::string, sf::Texture> textureCache;  // Cache of textures
 
-    // Check if texture is already loaded
-    if (textureCache.find(texturePath) != textureCache.end()) {
-        return textureCache[texturePath];  // Return cached texture
+    // Check if texture is already loaded. Lookups of cached textures don't modify
+    // the map, so worker threads may call this once everything is preloaded.
+    std::map<std::string, sf::Texture>::iterator cached = textureCache.find(texturePath);
+    if (cached != textureCache.end()) {
+        return cached->second;  // Return cached texture
     }
 
     // Load new texture and cache it
@@ -294,7 +409,38 @@ Texture& TextureManager(const std::string& texturePath) {
     return textureCache[texturePath];
 }
 
-void DeathMenu(Player& player, Level& level, int& prev, float deltaTime, RenderWindow& window, std::vector<Enemy>& enemies, std::vector<Object>& objects)
+// Everything in the world, submitted after the frame's updates so nothing moves before the flush
+static void DrawWorld(RenderQueue& queue, Level& level, Player& player, std::vector<Enemy>& enemies, std::vector<Object>& objects, ProjectilePool& projectiles)
+{
+    for (Object& object : objects)
+        object.draw(queue);
+    for (Enemy& enemy : enemies)
+        enemy.draw(queue);
+    projectiles.draw(queue);
+    Particles().draw(queue);
+    player.draw(queue);
+}
+
+// Copies this tick into a render frame. The world is drawn through a camera following
+// the player; rooms are exactly one screen, so there it never moves.
+static void RecordFrame(RenderFrame& frame, View& camera, Level& level, Player& player, std::vector<Enemy>& enemies, std::vector<Object>& objects, ProjectilePool& projectiles)
+{
+    camera.setCenter(CameraCentre(player.position(), level.bounds));
+    frame.world.begin(camera);
+    DrawWorld(frame.world, level, player, enemies, objects, projectiles);
+    if (frame.staticRevision != level.terrain.getRevision()) {
+        frame.staticRevision = level.terrain.getRevision();
+        frame.staticArea = level.terrain.getArea();
+        frame.staticVertices = level.terrain.getVertices();
+    }
+    frame.hud.currency = currency;
+    frame.hud.health = player.getHealth();
+    frame.hud.stats = player.getStatsSummary();
+    frame.hud.showControls = LevelNumber == 0;
+    frame.hud.wave = level.director.wave();
+}
+
+void DeathMenu(Player& player, Level& level, int& prev, float deltaTime, RenderWindow& window, std::vector<Enemy>& enemies, std::vector<Object>& objects, ProjectilePool& projectiles)
 {
     // Create Game Over menu
     Font font;
@@ -333,11 +479,24 @@ void DeathMenu(Player& player, Level& level, int& prev, float deltaTime, RenderW
         SCREEN_HEIGHT * 2 / 3
     );
 
+    // "Retry" text, only when a checkpoint exists
+    sf::Text retryText;
+    retryText.setFont(font);
+    retryText.setCharacterSize(28);
+    retryText.setFillColor(sf::Color::White);
+    retryText.setString("Retry Room (R)");
+    retryText.setPosition(
+        SCREEN_WIDTH / 2 - retryText.getLocalBounds().width / 2,
+        SCREEN_HEIGHT * 2 / 3 + 50
+    );
+
     // Display the Game Over menu
     window.clear(sf::Color(0, 0, 0));
     window.draw(gameOverText);
     window.draw(scoreText);
     window.draw(restartText);
+    if (!checkpoint.empty())
+        window.draw(retryText);
     window.display();
 
     // Handle events for restarting
@@ -346,6 +505,14 @@ void DeathMenu(Player& player, Level& level, int& prev, float deltaTime, RenderW
         if (event.type == sf::Event::Closed)
             window.close();
 
+        // Retry the current room from its checkpoint instead of restarting the run
+        if (!checkpoint.empty() && sf::Keyboard::isKeyPressed(sf::Keyboard::R) &&
+            RestoreSnapshot(checkpoint, player, level, prev, enemies, objects, projectiles)) {
+            rewindBuffer.clear(); // History would lead straight back to the death
+            gameOver = false;
+            return;
+        }
+
         if ((event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left &&
             restartText.getGlobalBounds().contains(event.mouseButton.x, event.mouseButton.y)) || (
                 sf::Keyboard::isKeyPressed(sf::Keyboard::Escape) ||
@@ -356,11 +523,13 @@ void DeathMenu(Player& player, Level& level, int& prev, float deltaTime, RenderW
             LevelNumber = 0;
             level = Level(LevelNumber, SCREEN_WIDTH, SCREEN_HEIGHT);
             player.SetPosition(level.spawnPosition);
-            player.items.clear();
-            player.recalculateStats();
+            player.clearItems();
             prev = LevelNumber;
             enemies.clear();
             objects.clear();
+            projectiles.clear();
+            Particles().clear();
+            rewindBuffer.clear();
             gameOver = false; // Exit game-over state
             return;
         }
@@ -368,32 +537,60 @@ void DeathMenu(Player& player, Level& level, int& prev, float deltaTime, RenderW
 }
 
 
+bool RestoreSnapshot(const WorldSnapshot& snapshot, Player& player, Level& level, int& prev, std::vector<Enemy>& enemies, std::vector<Object>& objects, ProjectilePool& projectiles)
+{
+    DirectorState director;
+    if (!snapshot.restore(player, enemies, objects, projectiles, director, LevelNumber, currency))
+        return false;
+
+    // Geometry is only rebuilt when the snapshot is from another room. The
+    // director, in the arena, carries on with the snapshot's wave either way.
+    if (level.levelNumber != LevelNumber)
+        level = Level(LevelNumber, SCREEN_WIDTH, SCREEN_HEIGHT);
+    level.director.loadState(director, level.bounds);
+    WorldBounds() = level.bounds;
+    level.resumeStream(player.position(), enemies);
+    prev = LevelNumber;
+    forceReload = false;
+    Particles().clear();
+    return true;
+}
+
 void enforceBounds(Player& player, int enemies, Level& level) {
     sf::Vector2f position = player.position();
-    if (enemies) {
-        if (position.x > SCREEN_WIDTH)
-            position.x = SCREEN_WIDTH;
+    float right = level.bounds.left + level.bounds.width;
+    if (enemies || level.director.isActive()) {
+        // The survivor arena never opens
+        if (position.x > right)
+            position.x = right;
         player.SetPosition(position);
     }
-    else if (position.x > SCREEN_WIDTH)
+    else if (position.x > right)
     {
-        srand(time(0));
-        LevelNumber = rand() % 10 + 1;
+        LevelNumber = NextLevelNumber();
         forceReload = true;
     }
-    if (position.x < 0)
+    if (position.x < level.bounds.left)
     {
-        position.x = 0;
+        position.x = level.bounds.left;
         player.SetPosition(position);
     }
-    if (position.y > SCREEN_HEIGHT)
+    if (position.y > level.bounds.top + level.bounds.height)
     {
         player.ChangeHealth(-1);
-        player.SetPosition(level.spawnPosition);
+        sf::Vector2f respawn = level.respawnPosition(position);
+        player.SetPosition(respawn);
     }
 }
 
-void MainMenu(RenderWindow& window, bool& inMainMenu) {
+Vector2f CameraCentre(const Vector2f& focus, const FloatRect& bounds) {
+    // Horizontal follow only, levels are never taller than the screen
+    float half = SCREEN_WIDTH / 2;
+    float x = std::max(bounds.left + half, std::min(focus.x, bounds.left + bounds.width - half));
+    return Vector2f(x, SCREEN_HEIGHT / 2);
+}
+
+void MainMenu(RenderWindow& window, bool& inMainMenu, bool canContinue) {
     Font font;
     if (!font.loadFromFile("Textures/font.ttf")) {
         std::cerr << "Failed to load font for Main Menu!" << std::endl;
@@ -429,9 +626,32 @@ void MainMenu(RenderWindow& window, bool& inMainMenu) {
         SCREEN_HEIGHT / 2 + 55
     );
 
+    Text survivorText;
+    survivorText.setFont(font);
+    survivorText.setCharacterSize(28);
+    survivorText.setFillColor(Color::White);
+    survivorText.setString("Press S for Survivor Mode");
+    survivorText.setPosition(
+        SCREEN_WIDTH / 2 - survivorText.getLocalBounds().width / 2,
+        SCREEN_HEIGHT / 2 + 150
+    );
+
+    Text continueText;
+    continueText.setFont(font);
+    continueText.setCharacterSize(28);
+    continueText.setFillColor(Color::White);
+    continueText.setString("Press C to Continue");
+    continueText.setPosition(
+        SCREEN_WIDTH / 2 - continueText.getLocalBounds().width / 2,
+        SCREEN_HEIGHT / 2 + 110
+    );
+
     window.clear(Color(18, 32, 32));
     window.draw(titleText);
     window.draw(playText);
+    window.draw(survivorText);
+    if (canContinue)
+        window.draw(continueText);
     window.display();
 
     // Handle button click
@@ -508,29 +728,239 @@ void PauseMenu(RenderWindow& window, bool& isShopping) {
     }
 }
 
-void DisplayInstructions(RenderWindow& window) {
-    Font font;
-    if (!font.loadFromFile("Textures/font.ttf")) {
-        return;
+int RunServer(unsigned short port, int hordeSize)
+{
+    std::unique_ptr<GameServer> server(new GameServer(GameTuning().player.movementSpeed, hordeSize)); // Too big for the stack
+    if (!server->start(port))
+        return 1;
+    std::cout << "Server listening on UDP " << server->port() << " with a horde of " << hordeSize << std::endl;
+
+    // Fixed 60 Hz ticks; sleep away whatever each tick leaves over
+    Clock clock;
+    Time nextTick = clock.getElapsedTime();
+    Time nextReport = nextTick + seconds(5);
+    while (true) {
+        server->tick();
+        nextTick += seconds(NET_TICK);
+
+        Time now = clock.getElapsedTime();
+        if (now >= nextReport) {
+            ServerStats& stats = server->stats();
+            std::cout << "tick avg " << stats.totalTickTime * 1000.0f / std::max(stats.ticks, 1) << " ms, max "
+                << stats.maxTickTime * 1000.0f << " ms, clients " << server->clientCount()
+                << ", enemies " << server->enemyCount() << ", out " << stats.bytesSent / 5 / 1024 << " KB/s" << std::endl;
+            stats = ServerStats();
+            nextReport = now + seconds(5);
+        }
+        if (nextTick > now)
+            sleep(nextTick - now);
+        else if (now - nextTick > seconds(0.25f))
+            nextTick = now; // Fell far behind; don't try to catch up in a burst
     }
+}
 
-    Text instructions;
-    instructions.setFont(font);
-    instructions.setCharacterSize(24);
-    instructions.setFillColor(Color::White);
-    instructions.setString(
-        "Controls:\n"
-        "WASD / Arrow Keys - Move\n"
-        "Space - Jump\n"
-        "Left Mouse Click / J / X - Swing Weapon\n"
-        "E - Open Chest/Shop\n"
-        "Shift - Dash"
-    );
+int RunClient(RenderWindow& window, const sf::IpAddress& address, unsigned short port)
+{
+    GameClient client(GameTuning().player.movementSpeed);
+    if (!client.connect(address, port)) {
+        std::cerr << "Could not open a UDP socket" << std::endl;
+        return 1;
+    }
 
-    // Center the text
-    FloatRect textBounds = instructions.getLocalBounds();
-    instructions.setPosition(SCREEN_WIDTH / 2 - textBounds.width / 2, SCREEN_HEIGHT / 4);
+    // Simulation runs at the server's fixed tick so predictions line up with it
+    Clock clock;
+    float accumulator = 0.0f;
+    while (window.isOpen()) {
+        Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == Event::Closed)
+                window.close();
+        }
+        if (Keyboard::isKeyPressed(Keyboard::Escape))
+            window.close();
 
-    window.draw(instructions);
+        accumulator += clock.restart().asSeconds();
+        while (accumulator >= NET_TICK) {
+            client.tick();
+            Particles().update(NET_TICK);
+            accumulator -= NET_TICK;
+        }
+        client.draw(window);
+    }
+    client.disconnect();
+    return 0;
 }
 
+int RunLoopbackTest(int botCount, int hordeSize, int seconds)
+{
+    // Everything runs on this one thread, so the tick times below are what one server core costs
+    std::unique_ptr<GameServer> server(new GameServer(GameTuning().player.movementSpeed, hordeSize));
+    if (!server->start(Socket::AnyPort))
+        return 1;
+
+    std::vector<std::unique_ptr<GameClient>> bots;
+    for (int i = 0; i < botCount; ++i) {
+        bots.push_back(std::unique_ptr<GameClient>(new GameClient(GameTuning().player.movementSpeed)));
+        bots.back()->setBot(static_cast<sf::Uint32>(i + 1));
+        if (!bots.back()->connect(IpAddress::LocalHost, server->port()))
+            return 1;
+    }
+    std::cout << "Loopback: " << botCount << " bots, horde of " << hordeSize << ", " << seconds << " s" << std::endl;
+
+    Clock clock;
+    Time nextTick = clock.getElapsedTime();
+    float worstAverage = 0.0f;
+    int totalTicks = seconds * NET_TICK_RATE;
+    for (int tick = 1; tick <= totalTicks; ++tick) {
+        server->tick();
+        for (auto& bot : bots)
+            bot->tick();
+        Particles().clear(); // Bots predict dashes too; nothing draws them
+
+        if (tick % NET_TICK_RATE == 0) {
+            ServerStats& stats = server->stats();
+            float average = stats.totalTickTime / std::max(stats.ticks, 1);
+            worstAverage = std::max(worstAverage, average);
+            std::cout << "[" << tick / NET_TICK_RATE << "s] server tick avg " << average * 1000.0f << " ms, max "
+                << stats.maxTickTime * 1000.0f << " ms, out " << stats.bytesSent / 1024 << " KB/s ("
+                << stats.bytesSent / std::max(botCount, 1) / 1024 << " KB/s per client, " << stats.packetsSent
+                << " packets), clients " << server->clientCount() << ", enemies " << server->enemyCount() << std::endl;
+            stats = ServerStats();
+        }
+
+        nextTick += Time(sf::seconds(NET_TICK));
+        Time now = clock.getElapsedTime();
+        if (nextTick > now)
+            sleep(nextTick - now);
+    }
+
+    // Pass if every bot got in, nearly every frame arrived whole, and the server kept up with 60 Hz
+    bool passed = worstAverage < NET_TICK;
+    for (size_t i = 0; i < bots.size(); ++i) {
+        ClientStats& stats = bots[i]->stats();
+        float frameRate = stats.framesCompleted / static_cast<float>(seconds);
+        std::cout << "bot " << i << ": " << (bots[i]->isConnected() ? "connected" : "NOT CONNECTED") << ", "
+            << frameRate << " frames/s, " << stats.corrections << " corrections (avg "
+            << (stats.corrections ? stats.totalCorrection / stats.corrections : 0.0f) << " px, max "
+            << stats.maxCorrection << " px), " << stats.bytesReceived / seconds / 1024 << " KB/s in" << std::endl;
+        if (!bots[i]->isConnected() || frameRate < NET_TICK_RATE * 0.9f)
+            passed = false;
+        bots[i]->disconnect();
+    }
+    std::cout << "worst server second: " << worstAverage * 1000.0f << " ms per tick of a "
+        << NET_TICK * 1000.0f << " ms budget" << std::endl;
+    std::cout << (passed ? "PASS" : "FAIL") << std::endl;
+    return passed ? 0 : 1;
+}
+
+int RunBalance(const BalanceConfig& config)
+{
+    std::cout << "Balance: " << config.runs << " runs, health x" << config.enemyHealthScale
+        << ", speed x" << config.enemySpeedScale << std::endl;
+    BalanceReport report = RunBalanceSweep(config);
+    report.write(std::cout);
+
+    std::ofstream file(config.reportPath);
+    if (!file)
+        return 1;
+    report.write(file);
+    return 0;
+}
+
+// Walks back and forth across the room, jumping, swinging and throwing on a fixed rhythm
+static PlayerInput ScriptedInput(sf::Uint32 tick)
+{
+    PlayerInput input;
+    input.sequence = tick;
+    input.buttons |= (tick / 240) % 2 ? PlayerInput::Left : PlayerInput::Right;
+    if (tick % 90 < 10)
+        input.buttons |= PlayerInput::Jump;
+    if (tick % 30 < 15)
+        input.buttons |= PlayerInput::Attack;
+    if (tick % 120 == 0)
+        input.buttons |= PlayerInput::Throw;
+    return input;
+}
+
+int RunAllocationCheck(int seconds, int startLevel)
+{
+    // Scripted play through the game's own tick and frame recording, with no window.
+    // Loading a room allocates, and so does the first growth of the queues, pools and
+    // rewind history after it, so each room gets a settling period. Any allocation
+    // after that fails the check.
+    const int SETTLE_TICKS = 240;
+    const int REPORT_LIMIT = 10;
+
+    RenderWindow window; // Never opened; only the shop would draw to it and the script never presses E
+    Player player(Vector2f(10, 10), TextureManager("Textures/Player.png"), TextureManager("Textures/Weapon1.png"), GameTuning().player.movementSpeed);
+    Level level(-1, SCREEN_WIDTH, SCREEN_HEIGHT);
+    std::vector<Enemy> enemies;
+    std::vector<Object> objects;
+    static ProjectilePool projectiles;
+    static RenderFrame frame;
+    View camera(FloatRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT));
+    int previousLevel = -1;
+    LevelNumber = startLevel;
+    SeedGameRandom(1);
+
+    std::cout << "Allocation check: level " << startLevel << ", " << seconds << " s" << std::endl;
+#ifdef _DEBUG
+    std::cout << "Counting every CRT allocation" << std::endl;
+#else
+    std::cout << "Counting operator new only; a Debug build also counts malloc and SFML" << std::endl;
+#endif
+    AllocationTracker::setEnabled(true);
+    GameTelemetry().clear();
+
+    int totalTicks = static_cast<int>(seconds / SIM_TICK);
+    int settledAt = SETTLE_TICKS;
+    int settledTicks = 0;
+    int failedTicks = 0;
+    AllocationCount leaked;
+    for (int tick = 0; tick < totalTicks; ++tick) {
+        player.SetHealth(10); // The script never reaches the death screen
+        bool loadingRoom = LevelNumber != previousLevel || forceReload;
+
+        AllocationTracker::Scope allocations;
+        SimulateTick(player, level, previousLevel, SIM_TICK, window, ScriptedInput(tick), enemies, objects, projectiles);
+        {
+            Telemetry::Scope timing(Timing::Draw);
+            RecordFrame(frame, camera, level, player, enemies, objects, projectiles);
+        }
+        AllocationCount allocated = allocations.allocated();
+
+        if (loadingRoom) {
+            settledAt = tick + SETTLE_TICKS;
+            std::cout << "tick " << tick << ": entered level " << previousLevel << std::endl;
+        }
+        if (tick < settledAt)
+            continue;
+
+        ++settledTicks;
+        if (allocated.count) {
+            if (failedTicks < REPORT_LIMIT)
+                std::cout << "tick " << tick << ": " << allocated.count << " allocations, " << allocated.bytes << " bytes" << std::endl;
+            ++failedTicks;
+            leaked.count += allocated.count;
+            leaked.bytes += allocated.bytes;
+        }
+    }
+    AllocationTracker::setEnabled(false);
+
+    // Where the allocations were made, over the whole run including the settling ticks
+    const Timing scopes[] = { Timing::Player, Timing::Enemies, Timing::Collision, Timing::Draw };
+    const char* const scopeNames[] = { "player", "enemies", "collision", "draw" };
+    for (int i = 0; i < 4; ++i) {
+        const Histogram& histogram = GameTelemetry().allocationsIn(scopes[i]);
+        std::cout << scopeNames[i] << ": max " << histogram.max() << " allocations in a tick, mean "
+            << histogram.mean() << std::endl;
+    }
+
+    std::cout << "rewind history: " << rewindBuffer.framesStored() * SIM_TICK << " s in "
+        << rewindBuffer.bytesStored() / 1024 << " KB of " << RewindBuffer::MEMORY_BUDGET / 1024 << " KB" << std::endl;
+    std::cout << settledTicks << " settled ticks, " << failedTicks << " allocated (" << leaked.count
+        << " allocations, " << leaked.bytes << " bytes)" << std::endl;
+    bool passed = settledTicks > 0 && failedTicks == 0;
+    std::cout << (passed ? "PASS" : "FAIL") << std::endl;
+    return passed ? 0 : 1;
+}
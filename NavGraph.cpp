@@ -0,0 +1,189 @@
+#include "NavGraph.h"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+const float EDGE_MARGIN = 20.0f;      // Keeps takeoff and landing points off the very edge
+const float TOUCH_TOLERANCE = 2.0f;   // Platforms closer than this count as connected
+const float FEET_TOLERANCE = 24.0f;   // How far above a platform the feet may be and still be on it
+
+// Time until a jump with the given rise (negative = lands lower) comes back down to that height
+static float jumpAirTime(float rise) {
+    float discriminant = NAV_JUMP_SPEED * NAV_JUMP_SPEED - 2.0f * NAV_GRAVITY * rise;
+    if (discriminant < 0)
+        return -1.0f; // Too high to reach
+    return (NAV_JUMP_SPEED + std::sqrt(discriminant)) / NAV_GRAVITY;
+}
+
+NavGraph::NavGraph() : goalNode(-1) {}
+
+void NavGraph::build(const std::vector<Ground>& grounds) {
+    nodes.clear();
+    edges.clear();
+    goalNode = -1;
+
+    // One node per ground whose top isn't buried under another ground
+    for (const Ground& ground : grounds) {
+        sf::FloatRect bounds = ground.getBounds();
+        sf::Vector2f above(bounds.left + bounds.width / 2, bounds.top - 1.0f);
+        bool buried = false;
+        for (const Ground& other : grounds) {
+            if (other.getBounds().contains(above)) {
+                buried = true;
+                break;
+            }
+        }
+        if (!buried)
+            nodes.push_back(NavNode{ bounds.left, bounds.left + bounds.width, bounds.top });
+    }
+
+    for (int a = 0; a < static_cast<int>(nodes.size()); ++a) {
+        for (int b = 0; b < static_cast<int>(nodes.size()); ++b) {
+            if (a == b)
+                continue;
+            const NavNode& from = nodes[a];
+            const NavNode& to = nodes[b];
+            float rise = from.top - to.top; // Positive when the target is higher
+
+            // Side the target is on, and the horizontal gap to it
+            float gap = 0.0f;
+            float takeoffX;
+            float landingX;
+            if (to.left >= from.right - TOUCH_TOLERANCE) {
+                gap = to.left - from.right;
+                takeoffX = from.right - EDGE_MARGIN;
+                landingX = to.left + EDGE_MARGIN;
+            }
+            else if (to.right <= from.left + TOUCH_TOLERANCE) {
+                gap = from.left - to.right;
+                takeoffX = from.left + EDGE_MARGIN;
+                landingX = to.right - EDGE_MARGIN;
+            }
+            else if (rise < 0) {
+                // Target is lower and overlaps: drop off whichever end sticks out over it
+                if (to.right > from.right) {
+                    addEdge(a, b, NavEdgeType::Drop, from.right - EDGE_MARGIN, from.right + EDGE_MARGIN);
+                }
+                else if (to.left < from.left) {
+                    addEdge(a, b, NavEdgeType::Drop, from.left + EDGE_MARGIN, from.left - EDGE_MARGIN);
+                }
+                continue;
+            }
+            else {
+                // Target is higher and overlaps: jump straight up through it
+                float overlapLeft = std::max(from.left, to.left);
+                float overlapRight = std::min(from.right, to.right);
+                if (jumpAirTime(rise) >= 0)
+                    addEdge(a, b, NavEdgeType::Jump, (overlapLeft + overlapRight) / 2, (overlapLeft + overlapRight) / 2);
+                continue;
+            }
+
+            if (gap <= TOUCH_TOLERANCE && std::abs(rise) <= TOUCH_TOLERANCE) {
+                addEdge(a, b, NavEdgeType::Walk, takeoffX, landingX);
+                continue;
+            }
+
+            // Walking off the edge covers the gap when falling onto a lower platform
+            if (rise < 0 && NAV_RUN_SPEED * std::sqrt(2.0f * -rise / NAV_GRAVITY) >= gap + EDGE_MARGIN) {
+                addEdge(a, b, NavEdgeType::Drop, takeoffX, landingX);
+                continue;
+            }
+
+            // Otherwise it has to fit inside the jump arc
+            float airTime = jumpAirTime(rise);
+            if (airTime >= 0 && NAV_RUN_SPEED * airTime >= std::abs(landingX - takeoffX))
+                addEdge(a, b, NavEdgeType::Jump, takeoffX, landingX);
+        }
+    }
+
+    nextHop.assign(nodes.size() * nodes.size(), -2);
+    searchDistance.assign(nodes.size(), 0.0f);
+    searchVia.assign(nodes.size(), -1);
+    searchDone.assign(nodes.size(), false);
+}
+
+void NavGraph::addEdge(int from, int to, NavEdgeType type, float takeoffX, float landingX) {
+    float cost = std::abs(landingX - takeoffX) + std::abs(nodes[from].top - nodes[to].top);
+    if (type == NavEdgeType::Jump)
+        cost += 100.0f; // Prefer walking and dropping when both work
+    edges.push_back(NavEdge{ from, to, type, takeoffX, landingX, cost });
+}
+
+void NavGraph::setGoal(const sf::Vector2f& position) {
+    int node = nodeAt(position);
+    if (node >= 0)
+        goalNode = node; // Keep the last platform while the target is airborne
+}
+
+int NavGraph::goal() const {
+    return goalNode;
+}
+
+int NavGraph::nodeAt(const sf::Vector2f& feet) const {
+    // Closest platform top at or below the feet
+    int best = -1;
+    float bestDistance = std::numeric_limits<float>::max();
+    for (int i = 0; i < static_cast<int>(nodes.size()); ++i) {
+        const NavNode& node = nodes[i];
+        if (feet.x < node.left || feet.x > node.right)
+            continue;
+        float distance = node.top - feet.y;
+        if (distance >= -FEET_TOLERANCE && distance < bestDistance) {
+            best = i;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+const NavEdge* NavGraph::nextEdge(int start, int target) {
+    if (start < 0 || target < 0 || start == target)
+        return nullptr;
+
+    size_t slot = start * nodes.size() + target;
+    if (nextHop[slot] == -2)
+        search(start);
+    return nextHop[slot] >= 0 ? &edges[nextHop[slot]] : nullptr;
+}
+
+void NavGraph::search(int start) {
+    // Dijkstra from the start platform; levels only have a handful of nodes
+    int count = static_cast<int>(nodes.size());
+    std::fill(searchDistance.begin(), searchDistance.end(), std::numeric_limits<float>::max());
+    std::fill(searchVia.begin(), searchVia.end(), -1);
+    std::fill(searchDone.begin(), searchDone.end(), false);
+    searchDistance[start] = 0;
+
+    for (int step = 0; step < count; ++step) {
+        int current = -1;
+        for (int i = 0; i < count; ++i) {
+            if (!searchDone[i] && (current < 0 || searchDistance[i] < searchDistance[current]))
+                current = i;
+        }
+        if (current < 0 || searchDistance[current] == std::numeric_limits<float>::max())
+            break;
+        searchDone[current] = true;
+
+        for (int e = 0; e < static_cast<int>(edges.size()); ++e) {
+            const NavEdge& edge = edges[e];
+            if (edge.from != current)
+                continue;
+            if (searchDistance[current] + edge.cost < searchDistance[edge.to]) {
+                searchDistance[edge.to] = searchDistance[current] + edge.cost;
+                searchVia[edge.to] = e;
+            }
+        }
+    }
+
+    // Fill the whole row: for every goal, walk back to the first edge leaving the start
+    for (int target = 0; target < count; ++target) {
+        int first = -1;
+        int node = target;
+        while (node != start && searchVia[node] >= 0) {
+            first = searchVia[node];
+            node = edges[first].from;
+        }
+        nextHop[start * count + target] = (node == start && target != start) ? first : -1;
+    }
+}
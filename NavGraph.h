@@ -0,0 +1,66 @@
+#ifndef NAVGRAPH_H
+#define NAVGRAPH_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "Ground.h"
+#include "EnemyKind.h"
+
+// Enemy jump arc the graph is built for, so planned jumps match how enemies
+// actually fall whatever the tick rate
+const float NAV_JUMP_SPEED = 440.0f;
+const float NAV_GRAVITY = ENEMY_GRAVITY;
+const float NAV_RUN_SPEED = 100.0f; // Slowest ground enemy, so every edge works for all of them
+
+enum class NavEdgeType : sf::Uint8 {
+    Walk,   // Platforms touch, just keep walking
+    Drop,   // Walk off the edge and fall onto the target
+    Jump    // Needs a jump from the takeoff point
+};
+
+// Walkable top surface of a ground
+struct NavNode {
+    float left;
+    float right;
+    float top;
+};
+
+struct NavEdge {
+    int from;
+    int to;
+    NavEdgeType type;
+    float takeoffX;  // Where on the start platform to leave it
+    float landingX;  // Where the move should end up on the target platform
+    float cost;
+};
+
+// Platform graph for ground enemies, built once per level. Paths are looked
+// up per (start, goal) platform pair and cached, so every enemy standing on
+// the same platform shares one search.
+class NavGraph {
+public:
+    NavGraph();
+
+    // Member functions
+    void build(const std::vector<Ground>& grounds);
+    void setGoal(const sf::Vector2f& position);
+    int nodeAt(const sf::Vector2f& feet) const;
+    int goal() const;
+    const NavEdge* nextEdge(int start, int target);
+
+private:
+    void addEdge(int from, int to, NavEdgeType type, float takeoffX, float landingX);
+    void search(int start);
+
+    std::vector<NavNode> nodes;
+    std::vector<NavEdge> edges;
+    int goalNode;
+    std::vector<int> nextHop; // nodes x nodes edge index, -2 = not searched yet, -1 = unreachable
+
+    // Search scratch, sized at build so a search mid-level doesn't allocate
+    std::vector<float> searchDistance;
+    std::vector<int> searchVia;
+    std::vector<bool> searchDone;
+};
+
+#endif // NAVGRAPH_H
@@ -0,0 +1,92 @@
+#include "NetProtocol.h"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+
+NetEntity* NetFrame::find(sf::Uint16 id) {
+    std::vector<NetEntity>::iterator it = std::lower_bound(entities.begin(), entities.end(), id,
+        [](const NetEntity& entity, sf::Uint16 key) { return entity.id < key; });
+    return it != entities.end() && it->id == id ? &*it : nullptr;
+}
+
+bool WriteEntityDelta(NetBuffer& out, const NetEntity* baseline, const NetEntity& current) {
+    sf::Uint8 mask = 0;
+    int dx = baseline ? current.x - baseline->x : 0;
+    int dy = baseline ? current.y - baseline->y : 0;
+
+    if (!baseline || dx != 0)
+        mask |= (baseline && dx >= -128 && dx <= 127) ? NET_DELTA_X_SMALL : NET_DELTA_X;
+    if (!baseline || dy != 0)
+        mask |= (baseline && dy >= -128 && dy <= 127) ? NET_DELTA_Y_SMALL : NET_DELTA_Y;
+    if (!baseline || current.health != baseline->health)
+        mask |= NET_DELTA_HEALTH;
+    if (!baseline || current.flags != baseline->flags)
+        mask |= NET_DELTA_FLAGS;
+    if (mask == 0)
+        return false;
+
+    out.write(NetEntry::Entity);
+    out.write(current.id);
+    out.write(mask);
+    if (mask & NET_DELTA_X) out.write(current.x);
+    if (mask & NET_DELTA_X_SMALL) out.write(static_cast<sf::Int8>(dx));
+    if (mask & NET_DELTA_Y) out.write(current.y);
+    if (mask & NET_DELTA_Y_SMALL) out.write(static_cast<sf::Int8>(dy));
+    if (mask & NET_DELTA_HEALTH) out.write(current.health);
+    if (mask & NET_DELTA_FLAGS) out.write(current.flags);
+    return true;
+}
+
+void WriteEntityRemoval(NetBuffer& out, sf::Uint16 id) {
+    out.write(NetEntry::Entity);
+    out.write(id);
+    out.write(static_cast<sf::Uint8>(NET_DELTA_REMOVED));
+}
+
+bool ReadEntityDelta(NetBuffer& in, NetFrame& frame) {
+    sf::Uint16 id;
+    sf::Uint8 mask;
+    if (!in.read(id) || !in.read(mask))
+        return false;
+
+    NetEntity* entity = frame.find(id);
+    if (mask & NET_DELTA_REMOVED) {
+        if (entity)
+            frame.entities.erase(frame.entities.begin() + (entity - frame.entities.data()));
+        return true;
+    }
+    if (!entity) {
+        // New entity: inserted in id order, every field follows
+        NetEntity blank = { id, 0, 0, 0, 0 };
+        std::vector<NetEntity>::iterator it = std::lower_bound(frame.entities.begin(), frame.entities.end(), id,
+            [](const NetEntity& other, sf::Uint16 key) { return other.id < key; });
+        entity = &*frame.entities.insert(it, blank);
+    }
+
+    sf::Int8 step;
+    if ((mask & NET_DELTA_X) && !in.read(entity->x)) return false;
+    if (mask & NET_DELTA_X_SMALL) {
+        if (!in.read(step)) return false;
+        entity->x = static_cast<sf::Int16>(entity->x + step);
+    }
+    if ((mask & NET_DELTA_Y) && !in.read(entity->y)) return false;
+    if (mask & NET_DELTA_Y_SMALL) {
+        if (!in.read(step)) return false;
+        entity->y = static_cast<sf::Int16>(entity->y + step);
+    }
+    if ((mask & NET_DELTA_HEALTH) && !in.read(entity->health)) return false;
+    if ((mask & NET_DELTA_FLAGS) && !in.read(entity->flags)) return false;
+    return true;
+}
+
+void NetStepPlayer(Player& player, const Terrain& terrain, std::vector<Enemy>& enemies,
+    const PlayerInput& input, float width) {
+    player.update(NET_TICK, terrain, input);
+    player.handleCollision(enemies, NET_TICK); // Also carries on any knockback arc
+
+    // The arena has no exits, keep players on screen
+    sf::Vector2f position = player.position();
+    if (position.x < 0 || position.x > width) {
+        position.x = std::max(0.0f, std::min(position.x, width));
+        player.SetPosition(position);
+    }
+}
@@ -0,0 +1,153 @@
+#ifndef NETPROTOCOL_H
+#define NETPROTOCOL_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cstring>
+#include "PlayerCharacter.h"
+#include "Enemy.h"
+#include "Input.h"
+#include "World.h"
+
+// Shared settings for the authoritative server and its clients
+const unsigned short NET_DEFAULT_PORT = 53000;
+const sf::Uint32 NET_PROTOCOL_ID = 0x4E534E31;  // "NSN1", rejects stray datagrams
+const int NET_TICK_RATE = 60;
+const float NET_TICK = 1.0f / NET_TICK_RATE;
+const int NET_MAX_CLIENTS = 64;
+const size_t NET_MAX_PACKET = 1200;           // Stays under a typical MTU
+const int NET_HISTORY = 64;                   // Frames kept as delta baselines, about a second
+const int NET_INPUT_REDUNDANCY = 8;           // Every input packet repeats this many recent inputs
+const int NET_MAX_PROJECTILES = 512;          // Projectiles sent per frame, the rest are left out
+const float NET_POSITION_SCALE = 8.0f;        // Positions travel in 1/8 px
+const float NET_HEALTH_SCALE = 8.0f;
+const int NET_ARENA_LEVEL = 6;                // Flat single-floor room
+
+enum class NetMessage : sf::Uint8 {
+    Hello,      // Client -> server: asks for a slot
+    Welcome,    // Server -> client: slot, room and tick
+    Input,      // Client -> server: recent inputs plus the newest complete frame
+    State,      // Server -> client: one fragment of a delta-compressed frame
+    Bye         // Client -> server: leaving
+};
+
+// Entry types inside a state fragment
+enum class NetEntry : sf::Uint8 {
+    Self,        // Receiving client's own full PlayerState, used to reconcile prediction
+    Entity,      // Delta of one player or enemy against the baseline
+    Projectiles  // Quantised projectiles, resent every frame
+};
+
+// Per-entity flags. Archetype and texture id are packed into the top bits.
+enum NetEntityFlag : sf::Uint8 {
+    NET_FACING_RIGHT = 1 << 0,
+    NET_DYING = 1 << 1,
+    NET_ATTACKING = 1 << 2,
+    NET_ARCHETYPE_SHIFT = 4,
+    NET_TEXTURE_SHIFT = 6
+};
+
+// Which fields of an entity follow in a delta
+enum NetDeltaMask : sf::Uint8 {
+    NET_DELTA_X = 1 << 0,
+    NET_DELTA_X_SMALL = 1 << 1,  // X is an 8-bit offset from the baseline
+    NET_DELTA_Y = 1 << 2,
+    NET_DELTA_Y_SMALL = 1 << 3,
+    NET_DELTA_HEALTH = 1 << 4,
+    NET_DELTA_FLAGS = 1 << 5,
+    NET_DELTA_REMOVED = 1 << 6
+};
+
+// Quantised state of one player or enemy as it goes over the wire
+struct NetEntity {
+    sf::Uint16 id;       // Players use their slot, enemies start at NET_MAX_CLIENTS
+    sf::Int16 x;
+    sf::Int16 y;
+    sf::Uint8 health;
+    sf::Uint8 flags;
+};
+
+struct NetProjectile {
+    sf::Int16 x;
+    sf::Int16 y;
+    sf::Int16 velocityX;  // Whole px per second
+    sf::Int16 velocityY;
+    sf::Uint8 owner;
+};
+
+// Everything the server shows a client for one tick. Entities are sorted by id
+// so two frames can be diffed with a single merge walk.
+struct NetFrame {
+    sf::Uint32 tick = 0;
+    std::vector<NetEntity> entities;
+    std::vector<NetProjectile> projectiles;
+
+    NetEntity* find(sf::Uint16 id);
+};
+
+// Byte buffer for building and parsing datagrams. Fields are copied raw, as in
+// WorldSnapshot, since both ends are the same build on little-endian machines.
+class NetBuffer {
+public:
+    NetBuffer() : cursor(0) {}
+
+    void clear() { bytes.clear(); cursor = 0; }
+    size_t size() const { return bytes.size(); }
+    bool atEnd() const { return cursor >= bytes.size(); }
+
+    template <class T>
+    void write(const T& value) {
+        size_t offset = bytes.size();
+        bytes.resize(offset + sizeof(T));
+        std::memcpy(&bytes[offset], &value, sizeof(T));
+    }
+
+    template <class T>
+    bool read(T& value) {
+        if (bytes.size() - cursor < sizeof(T))
+            return false;
+        std::memcpy(&value, &bytes[cursor], sizeof(T));
+        cursor += sizeof(T);
+        return true;
+    }
+
+    std::vector<char> bytes;
+    size_t cursor;
+};
+
+inline sf::Int16 QuantizePosition(float value) {
+    float scaled = value * NET_POSITION_SCALE;
+    if (scaled > 32767.0f) scaled = 32767.0f;
+    if (scaled < -32768.0f) scaled = -32768.0f;
+    return static_cast<sf::Int16>(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+}
+
+inline float DequantizePosition(sf::Int16 value) {
+    return value / NET_POSITION_SCALE;
+}
+
+inline sf::Uint8 QuantizeHealth(float health) {
+    float scaled = health * NET_HEALTH_SCALE;
+    if (scaled <= 0.0f) return 0;
+    if (scaled >= 255.0f) return 255;
+    return static_cast<sf::Uint8>(scaled + 0.5f);
+}
+
+// Where the player in slot starts, spread along the floor so players don't
+// start stacked. The client predicts from here until the server's first state.
+inline sf::Vector2f NetSpawnPosition(const sf::Vector2f& levelSpawn, int slot) {
+    return levelSpawn + sf::Vector2f(static_cast<float>((slot * 40) % static_cast<int>(SCREEN_WIDTH)), 0);
+}
+
+// Delta coding for entities. WriteEntityDelta writes nothing when the entity
+// matches its baseline; a null baseline sends every field.
+bool WriteEntityDelta(NetBuffer& out, const NetEntity* baseline, const NetEntity& current);
+void WriteEntityRemoval(NetBuffer& out, sf::Uint16 id);
+bool ReadEntityDelta(NetBuffer& in, NetFrame& frame);
+
+// The movement half of a player tick. Server and clients both run exactly this,
+// so predictions only drift when combat (which the server owns) gets involved.
+void NetStepPlayer(Player& player, const Terrain& terrain, std::vector<Enemy>& enemies,
+    const PlayerInput& input, float width);
+
+#endif // NETPROTOCOL_H
@@ -1,47 +1,39 @@
 ﻿#include "Object.h"
+#include "World.h"
 #include "PlayerCharacter.h"
+#include "GameRandom.h"
 #include <iostream>
 #include <random>
+#include <algorithm>
 #include <ctime>
 #include "Item.cpp"
 
-const float SCREEN_WIDTH = 1280;
-const float SCREEN_HEIGHT = 720;
-
 Object::Object(const sf::Vector2f& position, const sf::Texture& textureFile, bool awarding)
-    : texture(textureFile), chest(awarding), interacted(false)
+    : chest(awarding), interacted(false)
 {
     sprite.setTexture(textureFile);
     sprite.setPosition(position);
 
-    std::vector<Item> predefinedItems = {
-    Item("Flaming Sword", 5, 0, 1.5f, 100),       
-    Item("Small Health Potion", 0, 2, 1.0f, 20),        
-    Item("Full Health Potion", 0, 9, 1.0f, 50),       
-    Item("Sword of Shadows", 0, 0, 1.2f, 100),      
-    Item("Enchanted Sword", 4, 0, 1.1f, 75),    
-    Item("Totem of Undying", 1, 0, 1.5f, 150),           
-    };
-
-    // Randomize storedItems
-    std::srand(time(0));
-
-    // Shuffle the predefined items
-    std::random_shuffle(predefinedItems.begin(), predefinedItems.end());
+    // Shuffle the item ids (from GameRandom, so simulations and restores stay reproducible).
+    // Only ids are shuffled and stored, so a chest never copies an Item or its name.
+    ItemId ids[256]; // One slot per possible ItemId
+    int catalogSize = std::min(static_cast<int>(ItemCatalog().size()), 256);
+    for (int i = 0; i < catalogSize; ++i)
+        ids[i] = static_cast<ItemId>(i);
+    std::minstd_rand shuffleRandom(GameRandom());
+    std::shuffle(ids, ids + catalogSize, shuffleRandom);
 
     // Choose a random number of items (1 to 3) and add them to storedItems
-    int numItems = std::rand() % 2 + 2; // Randomly select 1 to 3 items
-    for (int i = 0; i < numItems; ++i) {
-        storedItems.push_back(predefinedItems[i]);
-    }
+    int numItems = std::min(GameRandom(2) + 2, catalogSize); // Randomly select 1 to 3 items
+    storedItems.assign(ids, ids + numItems);
 }
 
-void Object::draw(sf::RenderWindow& window)
+void Object::draw(RenderQueue& queue)
 {
-    window.draw(sprite);
+    queue.submit(RenderLayer::Objects, sprite);
 }
 
-void Object::interact(Player& player, std::vector<Item>& items, sf::RenderWindow& window, int& currency)
+void Object::interact(Player& player, sf::RenderWindow& window, int& currency)
 {
     sf::Font font;
     if (!font.loadFromFile("Textures/font.ttf"))
@@ -104,6 +96,10 @@ void Object::interact(Player& player, std::vector<Item>& items, sf::RenderWindow
     float feedbackTimer = 0.0f;
     const float FEEDBACK_DURATION = 2.0f;
 
+    // The shop is laid out in screen space, whatever the camera is doing
+    sf::View worldView = window.getView();
+    window.setView(window.getDefaultView());
+
     bool menuOpen = true;
     sf::Clock clock;
 
@@ -121,7 +117,7 @@ void Object::interact(Player& player, std::vector<Item>& items, sf::RenderWindow
         // Create the menu string with detailed item stats
         std::string menuString = "Available Items:\n\n";
         for (size_t i = 0; i < storedItems.size(); ++i) {
-            const Item& item = storedItems[i];
+            const Item& item = GetItem(storedItems[i]);
             menuString += std::to_string(i + 1) + ". " + item.getName() + "\n";
             menuString += "   Price: " + std::to_string(item.getPrice()) + " coins\n";
 
@@ -136,6 +132,12 @@ void Object::interact(Player& player, std::vector<Item>& items, sf::RenderWindow
                 menuString += "   [Damage Multiplier: x" +
                     std::to_string(item.getDamageMultiplier()) + "]\n";
             }
+            if (item.getProjectiles() > 0) {
+                menuString += "   [Shuriken: +" + std::to_string(item.getProjectiles()) + "]\n";
+            }
+            if (item.getDuration() > 0.0f) {
+                menuString += "   [Lasts " + std::to_string(static_cast<int>(item.getDuration())) + "s]\n";
+            }
             menuString += "\n";  // Add spacing between items
         }
         menuText.setString(menuString);
@@ -166,36 +168,27 @@ void Object::interact(Player& player, std::vector<Item>& items, sf::RenderWindow
             {
                 int key = event.key.code - sf::Keyboard::Num1;
                 if (key >= 0 && key < static_cast<int>(storedItems.size())) {
-                    if (currency >= storedItems[key].getPrice()) {
-                        // Store old stats for comparison
-                        float oldMultiplier = player.calculateTotalDamageMultiplier();
-                        int oldDamage = player.getDamage();
-
-                        // Purchase and update
-                        items.push_back(storedItems[key]);
-                        currency -= storedItems[key].getPrice();
-
-
-                        player.recalculateStats();
+                    // Store old stats for comparison
+                    float oldMultiplier = player.getDamageMultiplier();
+                    int oldDamage = player.getDamage();
+                    const std::string& name = GetItem(storedItems[key]).getName();
 
+                    if (buy(key, player, currency)) {
                         // Generate feedback with stat changes
-                        feedbackMessage = "Purchased: " + storedItems[key].getName() + "\n";
+                        feedbackMessage = "Purchased: " + name + "\n";
                         if (player.getDamage() > oldDamage) {
                             feedbackMessage += "Damage: +" +
                                 std::to_string(player.getDamage() - oldDamage) + "\n";
                         }
-                        if (player.calculateTotalDamageMultiplier() > oldMultiplier) {
+                        if (player.getDamageMultiplier() > oldMultiplier) {
                             feedbackMessage += "Multiplier: +" +
-                                std::to_string(player.calculateTotalDamageMultiplier() - oldMultiplier) + "x";
+                                std::to_string(player.getDamageMultiplier() - oldMultiplier) + "x";
                         }
                         feedbackText.setFillColor(sf::Color::Green);
                         feedbackTimer = FEEDBACK_DURATION;
-
-                        // Remove the purchased item from storedItems
-                        storedItems.erase(storedItems.begin() + key);
                     }
                     else {
-                        feedbackMessage = "Not enough currency for: " + storedItems[key].getName();
+                        feedbackMessage = "Not enough currency for: " + name;
                         feedbackText.setFillColor(sf::Color::Red);
                         feedbackTimer = FEEDBACK_DURATION;
                     }
@@ -219,14 +212,72 @@ void Object::interact(Player& player, std::vector<Item>& items, sf::RenderWindow
         window.display();
     }
 
+    window.setView(worldView);
     interacted = true;
 }
 
+bool Object::buy(int index, Player& player, int& currency)
+{
+    if (index < 0 || index >= static_cast<int>(storedItems.size()))
+        return false;
+    const Item& item = GetItem(storedItems[index]);
+    if (currency < item.getPrice())
+        return false;
+
+    // Purchase and update
+    // Potions heal on purchase, timed items become buffs, everything else a stat modifier
+    if (player.getHealth() < 10)
+        player.ChangeHealth(item.getHealth());
+    if (item.getDuration() > 0.0f)
+        player.addBuff(storedItems[index], item.getDuration());
+    else
+        player.addItem(storedItems[index]);
+    currency -= item.getPrice();
+
+    // Remove the purchased item from storedItems
+    storedItems.erase(storedItems.begin() + index);
+    return true;
+}
+
+void Object::close()
+{
+    interacted = true;
+}
+
+const std::vector<ItemId>& Object::stock() const
+{
+    return storedItems;
+}
+
 sf::FloatRect Object::getBounds()
 {
     return sprite.getGlobalBounds();
 }
 
+void Object::saveState(ObjectState& state) const
+{
+    state.position = sprite.getPosition();
+    state.storedItemCount = 0;
+    for (ItemId id : storedItems) {
+        if (state.storedItemCount < ObjectState::MAX_STORED_ITEMS)
+            state.storedItems[state.storedItemCount++] = id;
+    }
+    state.chest = chest;
+    state.interacted = interacted;
+}
+
+void Object::loadState(const ObjectState& state)
+{
+    sprite.setPosition(state.position);
+    storedItems.clear();
+    for (int i = 0; i < state.storedItemCount; ++i) {
+        if (IsValidItem(state.storedItems[i]))
+            storedItems.push_back(state.storedItems[i]);
+    }
+    chest = state.chest;
+    interacted = state.interacted;
+}
+
 bool Object::isInteracted()
 {
     return interacted;
@@ -3,9 +3,21 @@
 
 #include <SFML/Graphics.hpp>
 #include <vector>
+#include "RenderQueue.h"
 #include "Item.cpp"
 #include "PlayerCharacter.h"
 
+// Plain copy of an object's state, used by world snapshots
+struct ObjectState {
+    static const int MAX_STORED_ITEMS = 8;
+
+    sf::Vector2f position;
+    ItemId storedItems[MAX_STORED_ITEMS];
+    sf::Uint8 storedItemCount;
+    bool chest;
+    bool interacted;
+};
+
 class Object
 {
 public:
@@ -13,19 +25,23 @@ public:
     Object(const sf::Vector2f& position, const sf::Texture& textureFile, bool awarding);
 
     // Member functions
-    void draw(sf::RenderWindow& window);
-    void interact(Player& player,std::vector<Item>& items, sf::RenderWindow& window, int& currency);
+    void draw(RenderQueue& queue);
+    void interact(Player& player, sf::RenderWindow& window, int& currency);
+    bool buy(int index, Player& player, int& currency);
+    void close();
+    const std::vector<ItemId>& stock() const;
 
     sf::FloatRect getBounds();
     bool isInteracted();  
+    void saveState(ObjectState& state) const;
+    void loadState(const ObjectState& state);
 
 private:
     // Member variables
     sf::Sprite sprite;
-    sf::Texture texture;
     bool chest;
     bool interacted;
-    std::vector<Item> storedItems;
+    std::vector<ItemId> storedItems;
 };
 
 #endif // !OBJECT_H
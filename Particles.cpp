@@ -0,0 +1,139 @@
+#include "Particles.h"
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <algorithm>
+
+const float PI = 3.14159265f;
+const float PARTICLE_DRAG = 0.98f; // Velocity kept per 1/60 s
+
+ParticleSystem::ParticleSystem() : count(0), seed(0x9E3779B9u) {
+    posX.resize(CAPACITY);
+    posY.resize(CAPACITY);
+    velX.resize(CAPACITY);
+    velY.resize(CAPACITY);
+    gravity.resize(CAPACITY);
+    life.resize(CAPACITY);
+    inverseLifetime.resize(CAPACITY);
+    halfSize.resize(CAPACITY);
+    color.resize(CAPACITY);
+    vertices.resize(CAPACITY * 4);
+}
+
+void ParticleSystem::emit(const sf::Vector2f& position, const sf::Vector2f& velocity, float lifetime,
+    float size, sf::Color tint, float fall) {
+    if (count >= CAPACITY || lifetime <= 0)
+        return; // Full: new particles are dropped rather than stealing old ones
+
+    int i = count++;
+    posX[i] = position.x;
+    posY[i] = position.y;
+    velX[i] = velocity.x;
+    velY[i] = velocity.y;
+    gravity[i] = fall;
+    life[i] = lifetime;
+    inverseLifetime[i] = 1.0f / lifetime;
+    halfSize[i] = size / 2.0f;
+    color[i] = tint;
+}
+
+void ParticleSystem::burst(const sf::Vector2f& position, int amount, float speed, float lifetime,
+    float size, sf::Color tint, float fall) {
+    for (int n = 0; n < amount; ++n) {
+        float angle = random01() * 2.0f * PI;
+        float magnitude = speed * (0.3f + 0.7f * random01());
+        sf::Vector2f velocity(std::cos(angle) * magnitude, std::sin(angle) * magnitude);
+        emit(position, velocity, lifetime * (0.5f + 0.5f * random01()), size, tint, fall);
+    }
+}
+
+void ParticleSystem::spray(const sf::Vector2f& position, const sf::Vector2f& direction, float spread, int amount,
+    float speed, float lifetime, float size, sf::Color tint, float fall) {
+    float baseAngle = std::atan2(direction.y, direction.x);
+    for (int n = 0; n < amount; ++n) {
+        float angle = baseAngle + (random01() - 0.5f) * spread;
+        float magnitude = speed * (0.5f + 0.5f * random01());
+        sf::Vector2f velocity(std::cos(angle) * magnitude, std::sin(angle) * magnitude);
+        emit(position, velocity, lifetime * (0.5f + 0.5f * random01()), size, tint, fall);
+    }
+}
+
+void ParticleSystem::update(float deltaTime) {
+    float drag = std::pow(PARTICLE_DRAG, deltaTime * 60.0f);
+
+    // Separate simple loops over float arrays so each one vectorises
+    for (int i = 0; i < count; ++i)
+        velY[i] += gravity[i] * deltaTime;
+    for (int i = 0; i < count; ++i) {
+        velX[i] *= drag;
+        velY[i] *= drag;
+    }
+    for (int i = 0; i < count; ++i) {
+        posX[i] += velX[i] * deltaTime;
+        posY[i] += velY[i] * deltaTime;
+    }
+    for (int i = 0; i < count; ++i)
+        life[i] -= deltaTime;
+
+    // Swap-remove expired particles to keep the live range packed
+    for (int i = 0; i < count;) {
+        if (life[i] > 0) {
+            ++i;
+            continue;
+        }
+        int last = --count;
+        posX[i] = posX[last];
+        posY[i] = posY[last];
+        velX[i] = velX[last];
+        velY[i] = velY[last];
+        gravity[i] = gravity[last];
+        life[i] = life[last];
+        inverseLifetime[i] = inverseLifetime[last];
+        halfSize[i] = halfSize[last];
+        color[i] = color[last];
+    }
+}
+
+void ParticleSystem::draw(RenderQueue& queue) {
+    const sf::FloatRect& area = queue.visibleArea();
+    int visible = 0;
+    for (int i = 0; i < count; ++i) {
+        float h = halfSize[i];
+        if (posX[i] + h < area.left || posX[i] - h > area.left + area.width ||
+            posY[i] + h < area.top || posY[i] - h > area.top + area.height)
+            continue;
+
+        sf::Vertex* quad = &vertices[visible++ * 4];
+        quad[0].position = sf::Vector2f(posX[i] - h, posY[i] - h);
+        quad[1].position = sf::Vector2f(posX[i] + h, posY[i] - h);
+        quad[2].position = sf::Vector2f(posX[i] + h, posY[i] + h);
+        quad[3].position = sf::Vector2f(posX[i] - h, posY[i] + h);
+
+        // Fade out over the particle's lifetime
+        sf::Color tint = color[i];
+        tint.a = static_cast<sf::Uint8>(tint.a * std::min(1.0f, life[i] * inverseLifetime[i]));
+        quad[0].color = quad[1].color = quad[2].color = quad[3].color = tint;
+    }
+    queue.submit(RenderLayer::Effects, vertices.data(), visible * 4, sf::Quads);
+}
+
+void ParticleSystem::clear() {
+    count = 0;
+}
+
+int ParticleSystem::size() const {
+    return count;
+}
+
+float ParticleSystem::random01() {
+    // xorshift32: cheap, and keeps effects off the GameRandom sequence
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return (seed & 0xFFFFFF) / static_cast<float>(0x1000000);
+}
+
+ParticleSystem& Particles() {
+    // One per thread, so headless simulations on worker threads don't share it
+    static thread_local ParticleSystem particles;
+    return particles;
+}
@@ -0,0 +1,54 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "RenderQueue.h"
+
+// CPU particle system for hit sparks, death bursts and dash trails.
+// Particles live in structure-of-arrays buffers packed in [0, count), the
+// integration loops only touch plain float arrays, and all visible particles
+// are drawn with a single vertex-array call.
+class ParticleSystem {
+public:
+    static const int CAPACITY = 32768;
+
+    ParticleSystem();
+
+    // Member functions
+    void emit(const sf::Vector2f& position, const sf::Vector2f& velocity, float lifetime,
+        float size, sf::Color color, float gravity);
+    void burst(const sf::Vector2f& position, int amount, float speed, float lifetime,
+        float size, sf::Color color, float gravity);
+    void spray(const sf::Vector2f& position, const sf::Vector2f& direction, float spread, int amount,
+        float speed, float lifetime, float size, sf::Color color, float gravity);
+    void update(float deltaTime);
+    void draw(RenderQueue& queue);
+    void clear();
+
+    int size() const;
+
+private:
+    float random01();
+
+    int count;
+    sf::Uint32 seed;
+
+    // Particle data
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> velX;
+    std::vector<float> velY;
+    std::vector<float> gravity;
+    std::vector<float> life;
+    std::vector<float> inverseLifetime; // 1 / starting lifetime, for the fade
+    std::vector<float> halfSize;
+    std::vector<sf::Color> color;
+
+    std::vector<sf::Vertex> vertices;
+};
+
+// Particle system used by the combat and movement code, one per thread
+ParticleSystem& Particles();
+
+#endif // PARTICLES_H
@@ -0,0 +1,112 @@
+#include "Physics.h"
+#include <algorithm>
+
+KinematicBody KinematicBody::fromSprite(const sf::Sprite& sprite, const sf::Vector2f& velocity, bool onGround) {
+    KinematicBody body;
+    body.position = sprite.getPosition();
+    body.velocity = velocity;
+    body.bounds = sprite.getGlobalBounds();
+    body.origin = sprite.getOrigin();
+    body.gravity = 0.0f;
+    body.deltaTime = 0.0f;
+    body.moves = false;
+    body.collides = true;
+    body.onGround = onGround;
+    body.contacts = 0;
+    return body;
+}
+
+// Moves the body and its cached box together
+static void MoveBody(KinematicBody& body, const sf::Vector2f& position) {
+    body.bounds.left += position.x - body.position.x;
+    body.bounds.top += position.y - body.position.y;
+    body.position = position;
+}
+
+void PhysicsWorld::stepBody(KinematicBody& body, const Terrain& terrain) {
+    body.contacts = 0;
+    if (body.collides) {
+        if (!body.onGround)
+            body.velocity.y += body.gravity * body.deltaTime;
+
+        // The bitmap says whether any ground is close; only then test the rectangles
+        body.onGround = false;
+        for (const sf::FloatRect& ground : terrain.rectsNear(body.bounds)) {
+            if (!body.bounds.intersects(ground))
+                continue;
+
+            sf::FloatRect box = body.bounds;
+            box.left -= body.origin.x;
+            box.top -= body.origin.y;
+
+            float overlapTop = box.top + box.height - ground.top;
+            float overlapBottom = ground.top + ground.height - box.top;
+            float overlapLeft = box.left + box.width - ground.left;
+            float overlapRight = ground.left + ground.width - box.left;
+            float minOverlap = std::min({ overlapTop, overlapBottom, overlapLeft, overlapRight });
+
+            // Push out along the shallowest side, if moving into it
+            if (minOverlap == overlapTop && body.velocity.y > 0) {
+                MoveBody(body, sf::Vector2f(body.position.x, ground.top - (box.height - body.origin.y)));
+                body.velocity.y = 0;
+                body.onGround = true;
+                body.contacts |= static_cast<sf::Uint8>(ContactSide::Top);
+            }
+            else if (minOverlap == overlapLeft && body.velocity.x > 0) {
+                MoveBody(body, sf::Vector2f(ground.left - (box.width - body.origin.x), body.position.y));
+                body.velocity.x = 0;
+                body.contacts |= static_cast<sf::Uint8>(ContactSide::Left);
+            }
+            else if (minOverlap == overlapRight && body.velocity.x < 0) {
+                MoveBody(body, sf::Vector2f(ground.left + ground.width + body.origin.x, body.position.y));
+                body.velocity.x = 0;
+                body.contacts |= static_cast<sf::Uint8>(ContactSide::Right);
+            }
+        }
+    }
+
+    if (body.moves)
+        MoveBody(body, body.position + body.velocity * body.deltaTime);
+}
+
+void PhysicsWorld::clear() {
+    bodies.clear();
+    contacts.clear();
+}
+
+void PhysicsWorld::reserve(int bodyCount) {
+    bodies.reserve(bodyCount);
+    contacts.reserve(bodyCount * 3); // Top, left and right at most
+}
+
+int PhysicsWorld::add(const KinematicBody& body) {
+    bodies.push_back(body);
+    return static_cast<int>(bodies.size()) - 1;
+}
+
+void PhysicsWorld::step(const Terrain& terrain) {
+    contacts.clear();
+    contacts.reserve(bodies.capacity() * 3);
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        KinematicBody& body = bodies[i];
+        stepBody(body, terrain);
+        for (sf::Uint8 side = 1; side <= 4; side <<= 1) {
+            if (body.contacts & side) {
+                Contact contact = { static_cast<int>(i), static_cast<ContactSide>(side) };
+                contacts.push_back(contact);
+            }
+        }
+    }
+}
+
+KinematicBody& PhysicsWorld::body(int index) {
+    return bodies[index];
+}
+
+int PhysicsWorld::size() const {
+    return static_cast<int>(bodies.size());
+}
+
+const std::vector<Contact>& PhysicsWorld::getContacts() const {
+    return contacts;
+}
@@ -0,0 +1,62 @@
+#ifndef PHYSICS_H
+#define PHYSICS_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "Terrain.h"
+
+// Face of a ground rectangle a body was pushed back out of
+enum class ContactSide : sf::Uint8 {
+    Top = 1,      // Landed on it
+    Left = 2,     // Ran into its left side
+    Right = 4
+};
+
+struct Contact {
+    int body;     // Index in the world
+    ContactSide side;
+};
+
+// A moving box. bounds is the sprite's global bounds, read once when the body
+// is made and moved along with position from then on, so resolution never
+// asks the sprite to rebuild its transform.
+struct KinematicBody {
+    sf::Vector2f position;  // As the sprite's setPosition takes it
+    sf::Vector2f velocity;
+    sf::FloatRect bounds;
+    sf::Vector2f origin;    // Sprite origin; ground contact is measured from the box shifted back by it
+    float gravity;          // px/s^2, accelerates velocity.y over the step while airborne
+    float deltaTime;        // Length of the step in seconds
+    bool moves;             // Move by velocity after resolving; false leaves moving to the owner
+    bool collides;          // Flyers pass through ground
+    bool onGround;
+    sf::Uint8 contacts;     // ContactSide bits from the last step
+
+    static KinematicBody fromSprite(const sf::Sprite& sprite, const sf::Vector2f& velocity, bool onGround);
+};
+
+// Steps every kinematic body of a tick in one pass: gravity, a broadphase
+// against the terrain bitmap, exact resolution against the ground rectangles,
+// then integration. Owners copy their bodies in, step, and read them back
+// along with the contact events; the storage is kept between ticks.
+class PhysicsWorld {
+public:
+    // Member functions
+    void clear();
+    void reserve(int bodyCount);  // Room for this many bodies and all their contacts
+    int add(const KinematicBody& body);
+    void step(const Terrain& terrain);
+
+    KinematicBody& body(int index);
+    int size() const;
+    const std::vector<Contact>& getContacts() const;  // From the last step, in body order
+
+    // The one collision path, also used on its own by single bodies like the player
+    static void stepBody(KinematicBody& body, const Terrain& terrain);
+
+private:
+    std::vector<KinematicBody> bodies;
+    std::vector<Contact> contacts;
+};
+
+#endif // PHYSICS_H
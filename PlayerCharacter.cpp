@@ -1,21 +1,22 @@
-#include <SFML/Window/Keyboard.hpp>
 #include <iostream>
 #include <vector>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
 #include "PlayerCharacter.h"
 #include "Ground.h"
 #include "Enemy.h"
 #include "Item.cpp"
-
-const float SCREEN_WIDTH = 1280;
-const float SCREEN_HEIGHT = 720;
+#include "Particles.h"
+#include "Animation.h"
+#include "Tuning.h"
+#include "Physics.h"
 
 Player::Player(const sf::Vector2f& position, const sf::Texture& textureFile, sf::Texture& weaponTexture, const float& moveSpeed)
-    :texture(textureFile), gravity(10), OnGround(false), velocity(0, 0), collisionTimer(0), Hit(false), facingRight(true), weapon(weaponTexture, position) {
+    : OnGround(false), velocity(0, 0), collisionTimer(0), Hit(false), facingRight(true), weapon(weaponTexture, position) {
 
-    sprite.setTexture(texture);
+    sprite.setTexture(textureFile);
     sprite.setPosition(position);
     sprite.setOrigin(sprite.getGlobalBounds().width / 2, sprite.getGlobalBounds().height / 2);
     speed = moveSpeed;
@@ -24,143 +25,69 @@ Player::Player(const sf::Vector2f& position, const sf::Texture& textureFile, sf:
 
     // Store base stats
     baseHealth = 10;
-    damage = 1;
-
-    if (!font.loadFromFile("Textures/font.ttf")) { 
-        std::cout << "Error loading font" << std::endl;
-    }
+    stats.setBase(Stat::Damage, 1);
 
-    statsText.setFont(font);
-    statsText.setCharacterSize(20);
-    statsText.setFillColor(sf::Color::Red);
-    statsText.setPosition(10, SCREEN_HEIGHT/8);
+    statsChanged();
 }
 
-void Player::update(float deltaTime, std::vector<Ground>& grounds) {
+void Player::update(float deltaTime, const Terrain& terrain, const PlayerInput& input) {
     if (!health) return;
 
+    // Timed buffs run out here; permanent modifiers cost nothing per frame
+    if (stats.update(deltaTime)) {
+        float now = stats.time();
+        buffs.erase(std::remove_if(buffs.begin(), buffs.end(), [now](const Buff& buff) {
+            return buff.expires <= now;
+            }), buffs.end());
+        statsChanged();
+    }
+
     /*float previousVelocityY = velocity.y;*/
     sf::Vector2f newScale = baseScale;
 
-    // Apply gravity if not on the ground
-    if (!OnGround)
-        velocity.y += gravity * deltaTime;
-
-    // Collision detection with the ground
-    OnGround = false;  // Reset on ground status
-    for (auto& ground : grounds)
-    {
-        if (sprite.getGlobalBounds().intersects(ground.getBounds()))
-        {
-            sf::FloatRect groundBounds = ground.getBounds();
-            sf::FloatRect spriteBounds = sprite.getGlobalBounds();
-
-            // Adjust sprite bounds based on origin offset
-            sf::Vector2f originOffset(sprite.getOrigin().x, sprite.getOrigin().y);
-            spriteBounds.left -= originOffset.x;
-            spriteBounds.top -= originOffset.y;
-
-            float spriteBottom = spriteBounds.top + spriteBounds.height;
-            float groundTop = groundBounds.top;
-
-            float spriteRight = spriteBounds.left + spriteBounds.width;
-            float groundLeft = groundBounds.left;
-
-            float spriteLeft = spriteBounds.left;
-            float groundRight = groundBounds.left + groundBounds.width;
-
-            // Determine the amount of overlap on each side
-            float overlapTop = spriteBottom - groundTop;
-            float overlapBottom = groundBounds.top + groundBounds.height - spriteBounds.top;
-            float overlapLeft = spriteRight - groundLeft;
-            float overlapRight = groundRight - spriteLeft;
-
-            // Find the smallest overlap to determine collision direction
-            float minOverlap = std::min({ overlapTop, overlapBottom, overlapLeft, overlapRight });
-
-            if (minOverlap == overlapTop && velocity.y > 0) {
-                // Vertical collision: landing on top of the ground
-                sprite.setPosition(sprite.getPosition().x, groundTop - (spriteBounds.height - originOffset.y));
-                velocity.y = 0;
-                OnGround = true;
-            }
-            else if (minOverlap == overlapLeft && velocity.x > 0) {
-                // Horizontal collision: hitting the left side of the ground
-                sprite.setPosition(groundLeft - (spriteBounds.width - originOffset.x), sprite.getPosition().y);
-                velocity.x = 0; // Stop horizontal movement
-            }
-            else if (minOverlap == overlapRight && velocity.x < 0) {
-                // Horizontal collision: hitting the right side of the ground
-                sprite.setPosition(groundRight + originOffset.x, sprite.getPosition().y);
-                velocity.x = 0; // Stop horizontal movement
-            }
-        }
-    }
-
+    // Fall and land through the shared physics path; handleInput does the moving
+    KinematicBody body = KinematicBody::fromSprite(sprite, velocity, OnGround);
+    body.gravity = GameTuning().player.gravity;
+    body.deltaTime = deltaTime;
+    PhysicsWorld::stepBody(body, terrain);
+    sprite.setPosition(body.position);
+    velocity = body.velocity;
+    OnGround = body.onGround;
 
     // Handle movement and velocity
-    handleInput(deltaTime);
+    handleInput(deltaTime, input);
 
 
     // Hurt animation
+    const AnimationPose* pose = &RestPose();
     if (Hit) {
         hurtPulseTimer += deltaTime;
-
-        // Calculate fade factor using a sinusoidal wave
-        float fadeFactor = 0.5f + 0.5f * sin(hurtPulseTimer * 10.0f); // Range: [0, 1]
-
-        // Interpolate between white and red for fading effect
-        sf::Color interpolatedColor = sf::Color(
-            static_cast<sf::Uint8>(255),  // Red remains constant
-            static_cast<sf::Uint8>(255 * (1.0f - fadeFactor)), // Green fades
-            static_cast<sf::Uint8>(255 * (1.0f - fadeFactor)), // Blue fades
-            255  // Alpha is fully opaque
-        );
-        sprite.setColor(interpolatedColor);
-
-        // Calculate scale pulsing effect
-        float pulseScale = 1.0f + 0.2f * sin(hurtPulseTimer * 10.0f); // Scale oscillates
-        newScale *= pulseScale; // Apply pulse effect
-        sprite.setScale(newScale);
-
-        if (hurtPulseTimer >= hurtPulseDuration) {
+        const AnimationClip& hurt = GetClip(Clip::PlayerHurt);
+        pose = &hurt.at(hurtPulseTimer);
+        if (hurt.isFinished(hurtPulseTimer)) {
             hurtPulseTimer = 0.0f;
             Hit = false;
-            sprite.setColor(sf::Color::White); // Reset to default color
+            pose = &RestPose();
         }
     }
 
-    // Sprite flipping
-    if (facingRight) {
-        sprite.setScale(newScale.x, newScale.y);
-    }
-    else {
-        sprite.setScale(-newScale.x, newScale.y);
-    }
+    // Pose, facing the way the player moves
+    pose->apply(sprite, newScale, facingRight ? 1.0f : -1.0f, 0.0f);
     // Handle weapon 
-    weapon.update(sprite.getPosition(), sprite.getGlobalBounds().width/2, facingRight,deltaTime);
+    weapon.update(sprite.getPosition(), sprite.getGlobalBounds().width/2, facingRight,deltaTime, input.held(PlayerInput::Attack));
 }
 
 
-void Player::draw(sf::RenderWindow& window) {
-    // Stat display
-    std::string stats = "Damage: " + std::to_string(int(damage)) + "\n";
-
-    std::ostringstream stream;
-    stream << std::fixed << std::setprecision(1) << calculateTotalDamageMultiplier(); // Format to one decimal place
-    stats += "Damage Multiplier: " + stream.str() + "x";
-
-    statsText.setString(stats);
-
-    window.draw(statsText);
-    weapon.draw(window);
-    window.draw(sprite);
+void Player::draw(RenderQueue& queue) {
+    weapon.draw(queue);
+    queue.submit(RenderLayer::Player, sprite);
 }
 
-void Player::handleInput(float deltaTime) {
+void Player::handleInput(float deltaTime, const PlayerInput& input) {
+    const PlayerTuning& tuning = GameTuning().player;
     if (!canDash) {
         dashCooldownTimer += deltaTime;
-        if (dashCooldownTimer >= dashCooldown) {
+        if (dashCooldownTimer >= tuning.dashCooldown) {
             canDash = true;
             dashCooldownTimer = 0.0f;
         }
@@ -170,7 +97,7 @@ void Player::handleInput(float deltaTime) {
         // Continue the dash
         dashTimer += deltaTime;
         // Calculate normalized time (0.0 to 1.0)
-        float t = dashTimer / dashTime;
+        float t = dashTimer / tuning.dashTime;
         if (t >= 1.0f) {
             // Dash complete
             isDashing = false;
@@ -179,12 +106,16 @@ void Player::handleInput(float deltaTime) {
         }
         else {
             // Move the sprite by the dash distance over time
-            sprite.move(dashDirection * (dashDistance / dashTime) * deltaTime);
+            sprite.move(dashDirection * (tuning.dashDistance / tuning.dashTime) * deltaTime);
+
+            // Leave a trail behind the dash
+            Particles().emit(sprite.getPosition(), -dashDirection * 60.0f, 0.25f, 10.0f, sf::Color(150, 180, 255, 180), 0.0f);
+            Particles().emit(sprite.getPosition() - dashDirection * 8.0f, -dashDirection * 30.0f, 0.2f, 6.0f, sf::Color(220, 230, 255, 160), 0.0f);
         }
     }
 
     // Normal movement logic
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::LShift) && canDash && !isDashing) {
+    if (input.held(PlayerInput::Dash) && canDash && !isDashing) {
         // Start dashing
         isDashing = true;
         canDash = false;
@@ -192,29 +123,24 @@ void Player::handleInput(float deltaTime) {
         dashDirection = { 0.0f, 0.0f }; // Reset dash direction
 
         // Determine horizontal dash direction
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::A) ||
-            sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) {
+        if (input.held(PlayerInput::Left)) {
             dashDirection.x = -1; // Dash left
             facingRight = false;
         }
-        else if (sf::Keyboard::isKeyPressed(sf::Keyboard::D) || 
-            sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) {
+        else if (input.held(PlayerInput::Right)) {
             dashDirection.x = 1;  // Dash right
             facingRight = true;
         }
-        else if (!sf::Keyboard::isKeyPressed(sf::Keyboard::W) &&
-            !sf::Keyboard::isKeyPressed(sf::Keyboard::S)) {
+        else if (!input.held(PlayerInput::Up) && !input.held(PlayerInput::Down)) {
             // Only use facing direction if no vertical input
             dashDirection.x = facingRight ? 1 : -1;
         }
 
         // Determine vertical dash direction
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::W) ||
-            sf::Keyboard::isKeyPressed(sf::Keyboard::Up)) {
+        if (input.held(PlayerInput::Up)) {
             dashDirection.y = -1; // Dash up
         }
-        else if (sf::Keyboard::isKeyPressed(sf::Keyboard::S) || 
-            sf::Keyboard::isKeyPressed(sf::Keyboard::Down)) {
+        else if (input.held(PlayerInput::Down)) {
             dashDirection.y = 1;  // Dash down
         }
 
@@ -230,13 +156,11 @@ void Player::handleInput(float deltaTime) {
     }
 
     // Horizontal movement
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::A) || 
-        sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) {
+    if (input.held(PlayerInput::Left)) {
         velocity.x = -1;  // Move left
         facingRight = false;
     }
-    else if (sf::Keyboard::isKeyPressed(sf::Keyboard::D) ||
-        sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) {
+    else if (input.held(PlayerInput::Right)) {
         velocity.x = 1;  // Move right
         facingRight = true;
     }
@@ -245,7 +169,7 @@ void Player::handleInput(float deltaTime) {
     }
 
     // Vertical movement
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space) && OnGround) {
+    if (input.held(PlayerInput::Jump) && OnGround) {
         velocity.y = -3;
     }
 
@@ -256,13 +180,14 @@ void Player::handleInput(float deltaTime) {
 
 void Player::handleCollision(std::vector<Enemy>& enemies, float deltaTime) {
     if (!health) return;
-    weapon.checkCollision(enemies, damage,facingRight);
+    weapon.checkCollision(enemies, getDamage(),facingRight);
+    const PlayerTuning& tuning = GameTuning().player;
     if (knockbackActive) {
         // Continue semicircular knockback motion
         knockbackTimer += deltaTime;
 
         // Compute normalized time in [0, 1]
-        float t = knockbackTimer / knockbackDuration;
+        float t = knockbackTimer / tuning.knockbackDuration;
 
         if (t >= 1.0f) {
             // Knockback complete
@@ -272,8 +197,8 @@ void Player::handleCollision(std::vector<Enemy>& enemies, float deltaTime) {
         }
 
         // Semicircular trajectory
-        float x = knockbackDirection.x * knockbackDistance * t; // Horizontal movement
-        float y = -4 * knockbackArcHeight * t * (1 - t);        // Vertical arc
+        float x = knockbackDirection.x * tuning.knockbackDistance * t; // Horizontal movement
+        float y = -4 * tuning.knockbackArcHeight * t * (1 - t);        // Vertical arc
 
         // Apply knockback motion
         sprite.setPosition(knockbackStartPosition + sf::Vector2f(x, y));
@@ -282,6 +207,7 @@ void Player::handleCollision(std::vector<Enemy>& enemies, float deltaTime) {
 
     // Check for collisions
     for (auto& enemy : enemies) {
+        if (enemy.isDying()) continue; // Dying enemies no longer hurt
         if (sprite.getGlobalBounds().intersects(enemy.getBounds())) {
             if (Hit) return; // Skip if already hit
             if (enemy.hit()) return; // Skip if enemy was attacked
@@ -291,33 +217,199 @@ void Player::handleCollision(std::vector<Enemy>& enemies, float deltaTime) {
     }
 
 }
-void Player::recalculateStats() {
+void Player::throwProjectiles(ProjectilePool& projectiles, float deltaTime, const PlayerInput& input) {
+    if (!health) return;
+    const PlayerTuning& tuning = GameTuning().player;
+
+    if (throwCooldownTimer > 0.0f) {
+        throwCooldownTimer -= deltaTime;
+        return;
+    }
+
+    if (!input.held(PlayerInput::Throw))
+        return;
+
+    // One shuriken plus any granted by items, fanned out vertically
+    int volley = 1 + static_cast<int>(stats.get(Stat::Projectiles));
+
+    float direction = facingRight ? 1.0f : -1.0f;
+    float shurikenDamage = getDamage() * getDamageMultiplier() * 0.5f;
+    for (int i = 0; i < volley; ++i) {
+        float spread = (i - (volley - 1) / 2.0f) * tuning.shurikenSpread;
+        projectiles.spawn(sprite.getPosition(), sf::Vector2f(direction * tuning.shurikenSpeed, spread),
+            shurikenDamage, 1.5f, 14.0f, ProjectileOwner::Player, sf::Color(200, 200, 220));
+    }
+    throwCooldownTimer = tuning.throwCooldown;
+}
+
+void Player::takeHit() {
+    if (Hit || knockbackActive) return; // Still recovering from the last hit
+    Hit = true;
+    health--;
+}
+
+void Player::addItem(ItemId id) {
+    std::vector<ItemStack>::iterator stack = std::find_if(items.begin(), items.end(),
+        [id](const ItemStack& owned) { return owned.id == id; });
+    if (stack == items.end()) {
+        ItemStack added = { id, 1 };
+        items.push_back(added);
+    }
+    else if (stack->count < 255) {
+        ++stack->count;
+    }
+    else {
+        return; // Full stack: stats stay in line with what the inventory and saves record
+    }
+
+    StatStack::Handle handles[3];
+    int count = pushModifiers(GetItem(id), 0.0f, handles);
+    itemModifiers.insert(itemModifiers.end(), handles, handles + count);
+    statsChanged();
+}
 
-    // Calculate flat bonuses
-    int additionalDamage = 0;
-    for (const auto& item : items) {
-        additionalDamage += item.getDamage();
+void Player::addBuff(ItemId id, float duration) {
+    // Only so many run at once; a new one ends the one closest to running out
+    if (buffs.size() == PlayerState::MAX_BUFFS) {
+        std::vector<Buff>::iterator soonest = std::min_element(buffs.begin(), buffs.end(),
+            [](const Buff& a, const Buff& b) { return a.expires < b.expires; });
+        for (int i = 0; i < soonest->modifierCount; ++i)
+            stats.remove(soonest->modifiers[i]);
+        buffs.erase(soonest);
     }
 
-    // Apply multipliers and bonuses
-    if (health < 10)
-        health += items[items.size() - 1].getHealth();
-    damage = 1 + additionalDamage;
+    Buff buff;
+    buff.item = id;
+    buff.expires = stats.time() + duration;
+    buff.modifierCount = pushModifiers(GetItem(id), duration, buff.modifiers);
+    buffs.push_back(buff);
+    statsChanged();
+}
+
+// Pushes the item's modifiers, timed if duration is set. Only modifiers that change something are pushed.
+int Player::pushModifiers(const Item& item, float duration, StatStack::Handle* handles) {
+    StatModifier modifiers[3];
+    int count = 0;
+    if (item.getDamage() != 0)
+        modifiers[count++] = { Stat::Damage, static_cast<float>(item.getDamage()), 1.0f };
+    if (item.getDamageMultiplier() != 1.0f)
+        modifiers[count++] = { Stat::DamageMultiplier, 0.0f, item.getDamageMultiplier() };
+    if (item.getProjectiles() != 0)
+        modifiers[count++] = { Stat::Projectiles, static_cast<float>(item.getProjectiles()), 1.0f };
+
+    for (int i = 0; i < count; ++i)
+        handles[i] = duration > 0.0f ? stats.addTimed(modifiers[i], duration) : stats.add(modifiers[i]);
+    return count;
+}
+
+void Player::endBuffs() {
+    for (const Buff& buff : buffs) {
+        for (int i = 0; i < buff.modifierCount; ++i)
+            stats.remove(buff.modifiers[i]);
+    }
+    buffs.clear();
+}
+
+void Player::clearItems() {
+    for (StatStack::Handle handle : itemModifiers)
+        stats.remove(handle);
+    itemModifiers.clear();
+    items.clear();
+    endBuffs();
+    statsChanged();
+}
 
-    // Update weapon damage multiplier
-    float damageMultiplier = calculateTotalDamageMultiplier();
-    weapon.setDamageMultiplier(damageMultiplier);
+const std::vector<ItemStack>& Player::getItems() const {
+    return items;
+}
 
+float Player::getDamageMultiplier() const {
+    return stats.get(Stat::DamageMultiplier);
 }
 
-float Player::calculateTotalDamageMultiplier() const {
-    float multiplier = 1.0f;
-    for (const auto& item : items) {
-        multiplier *= item.getDamageMultiplier();
+void Player::statsChanged() {
+    weapon.setDamageMultiplier(getDamageMultiplier());
+
+    // Stat display
+    std::string text = "Damage: " + std::to_string(int(getDamage())) + "\n";
+
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(1) << getDamageMultiplier(); // Format to one decimal place
+    text += "Damage Multiplier: " + stream.str() + "x";
+
+    statsSummary = text;
+}
+
+const std::string& Player::getStatsSummary() const {
+    return statsSummary;
+}
+
+void Player::saveState(PlayerState& state) const {
+    state.position = sprite.getPosition();
+    state.velocity = velocity;
+    state.knockbackStartPosition = knockbackStartPosition;
+    state.knockbackDirection = knockbackDirection;
+    state.dashDirection = dashDirection;
+    state.health = health;
+    state.damage = getDamage();
+    state.collisionTimer = collisionTimer;
+    state.knockbackTimer = knockbackTimer;
+    state.dashTimer = dashTimer;
+    state.dashCooldownTimer = dashCooldownTimer;
+    state.throwCooldownTimer = throwCooldownTimer;
+    state.hurtPulseTimer = hurtPulseTimer;
+    state.buffCount = static_cast<sf::Uint8>(buffs.size());
+    for (size_t i = 0; i < buffs.size(); ++i) {
+        state.buffItems[i] = buffs[i].item;
+        state.buffRemaining[i] = buffs[i].expires - stats.time();
     }
-    return multiplier;
+    weapon.saveState(state.weapon);
+    state.facingRight = facingRight;
+    state.onGround = OnGround;
+    state.hit = Hit;
+    state.knockbackActive = knockbackActive;
+    state.isDashing = isDashing;
+    state.canDash = canDash;
 }
 
+void Player::loadState(const PlayerState& state) {
+    sprite.setPosition(state.position);
+    velocity = state.velocity;
+    knockbackStartPosition = state.knockbackStartPosition;
+    knockbackDirection = state.knockbackDirection;
+    dashDirection = state.dashDirection;
+    health = state.health;
+    collisionTimer = state.collisionTimer;
+    knockbackTimer = state.knockbackTimer;
+    dashTimer = state.dashTimer;
+    dashCooldownTimer = state.dashCooldownTimer;
+    throwCooldownTimer = state.throwCooldownTimer;
+    hurtPulseTimer = state.hurtPulseTimer;
+    weapon.loadState(state.weapon);
+
+    // Buffs are put back with the time they had left. Rewinding changes that
+    // every tick, so while a buff runs this re-adds it each time.
+    int buffCount = std::min<int>(state.buffCount, PlayerState::MAX_BUFFS);
+    bool buffsMatch = static_cast<int>(buffs.size()) == buffCount;
+    for (int i = 0; buffsMatch && i < buffCount; ++i)
+        buffsMatch = buffs[i].item == state.buffItems[i] && buffs[i].expires - stats.time() == state.buffRemaining[i];
+    if (!buffsMatch) {
+        endBuffs();
+        for (int i = 0; i < buffCount; ++i) {
+            if (IsValidItem(state.buffItems[i]))
+                addBuff(state.buffItems[i], state.buffRemaining[i]);
+        }
+        statsChanged();
+    }
+    facingRight = state.facingRight;
+    OnGround = state.onGround;
+    Hit = state.hit;
+    knockbackActive = state.knockbackActive;
+    isDashing = state.isDashing;
+    canDash = state.canDash;
+    if (!Hit)
+        sprite.setColor(sf::Color::White);
+}
 
 sf::FloatRect Player::getBounds(){
     return sprite.getGlobalBounds();
@@ -329,6 +421,9 @@ void Player::SetPosition(sf::Vector2f& position) {
 void Player::SetHealth(float health) {
     this->health = health;
 }
+void Player::SetSpeed(float speed) {
+    this->speed = speed;
+}
 void Player::ChangeHealth(float health)
 {
     this->health += health;
@@ -342,8 +437,8 @@ float Player::getHealth() {
     return health;
 }
 
-float Player::getDamage() {
-    return damage;
+float Player::getDamage() const {
+    return stats.get(Stat::Damage);
 }
 
 Weapon& Player::getWeapon() {
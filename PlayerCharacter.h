@@ -5,80 +5,133 @@
 #include "Ground.h"
 #include "Enemy.h"
 #include "Weapon.h"
+#include "Projectile.h"
+#include "Input.h"
+#include "Stats.h"
 #include "Item.cpp"
 
+// Plain copy of the player's simulation state, used by world snapshots.
+// Items are stored separately as ItemIds.
+struct PlayerState {
+    static const int MAX_BUFFS = 4;
+
+    sf::Vector2f position;
+    sf::Vector2f velocity;
+    sf::Vector2f knockbackStartPosition;
+    sf::Vector2f knockbackDirection;
+    sf::Vector2f dashDirection;
+    float health;
+    float damage;                 // Derived from items on load, kept so the layout doesn't change
+    float collisionTimer;
+    float knockbackTimer;
+    float dashTimer;
+    float dashCooldownTimer;
+    float throwCooldownTimer;
+    float hurtPulseTimer;
+    float buffRemaining[MAX_BUFFS];  // Seconds left on each running buff
+    ItemId buffItems[MAX_BUFFS];
+    sf::Uint8 buffCount;
+    WeaponState weapon;
+    bool facingRight;
+    bool onGround;
+    bool hit;
+    bool knockbackActive;
+    bool isDashing;
+    bool canDash;
+};
+
 class Player {
 public:
     // Constructor
     Player(const sf::Vector2f& position, const sf::Texture& textureFile, sf::Texture& weaponTexture, const float& speed);
 
     // Member functions
-    void update(float deltaTime, std::vector<Ground>& grounds);
-    void draw(sf::RenderWindow& window);
-    void handleInput(float deltaTime);
+    void update(float deltaTime, const Terrain& terrain, const PlayerInput& input);
+    void draw(RenderQueue& queue);
+    void handleInput(float deltaTime, const PlayerInput& input);
     void handleCollision(std::vector<Enemy>& enemies,float deltaTime);
+    void throwProjectiles(ProjectilePool& projectiles, float deltaTime, const PlayerInput& input);
+    void takeHit();
     void SetPosition(sf::Vector2f& position);
     void SetHealth(float health);
+    void SetSpeed(float speed);
     void ChangeHealth(float health);
 
     sf::Vector2f position();
     sf::FloatRect getBounds();
     Weapon& getWeapon();
     float getHealth();
-    float getDamage();
+    float getDamage() const;
+    float getDamageMultiplier() const;
+    const std::string& getStatsSummary() const;  // Stat lines for the HUD
+
+    void saveState(PlayerState& state) const;
+    void loadState(const PlayerState& state);
 
-    void recalculateStats();
-    float calculateTotalDamageMultiplier() const;
+    // Items and buffs. Each pushes modifiers onto the stat stack, so stat reads never scan the inventory.
+    // A buff is a timed item: its modifiers come off again by themselves after duration seconds.
+    void addItem(ItemId id);
+    void addBuff(ItemId id, float duration);
+    void clearItems();  // Buffs too
+    const std::vector<ItemStack>& getItems() const;
 
     bool facingRight;
-    std::vector<Item> items;
 private:
+    // A running buff and the modifiers it pushed
+    struct Buff {
+        ItemId item;
+        float expires;                       // On the stat stack's clock
+        StatStack::Handle modifiers[3];
+        int modifierCount;
+    };
+
+    int pushModifiers(const Item& item, float duration, StatStack::Handle* handles);
+    void endBuffs();
+    void statsChanged();
+
     // Member variables
     sf::Sprite sprite;
-    sf::Texture texture;
     sf::Vector2f velocity;
     float collisionTimer;
     float speed;
-    float gravity;
     float baseSpeed;
     float baseHealth;
     bool OnGround;
     bool Hit;
     float health;
-    float damage;
 
     Weapon weapon;
+    StatStack stats;
+    std::vector<ItemStack> items;                 // Ids and counts, a couple of bytes per kind of item
+    std::vector<StatStack::Handle> itemModifiers; // Removed by clearItems
+    std::vector<Buff> buffs;                      // At most PlayerState::MAX_BUFFS, oldest first
 
+    // Knockback, dash and shuriken tuning is in Tuning/player.cfg
     // Knockback variables
     bool knockbackActive = false;      // Is the player currently in knockback?
     float knockbackTimer = 0.0f;       // Time elapsed during knockback
-    float knockbackDuration = 0.5f;    // Duration of the knockback effect
-    float knockbackDistance = 200.0f;  // Maximum horizontal distance to cover
-    float knockbackArcHeight = 100.0f; // Maximum height of the arc
     sf::Vector2f knockbackStartPosition; // Starting position for the arc
     sf::Vector2f knockbackDirection;  // Direction of the knockback
 
     // Dash variables
     bool isDashing = false;         
-    float dashDistance = 200.f;     
-    float dashTime = 0.1f;          // Total time for dash
     float dashTimer = 0.0f;         // Timer to track dash progress
     sf::Vector2f dashDirection;     
 
     bool canDash = true;            
-    float dashCooldown = 0.3f;      // Time between dashes 
     float dashCooldownTimer = 0.0f; // Tracks time since the last dash
 
+    // Shuriken variables
+    float throwCooldownTimer = 0.0f;
+
     // Stats    
-    sf::Text statsText;
-    sf::Font font;
+    std::string statsSummary;       // Rebuilt only when a stat changes
 
     // Animation parameters
     const float jumpSquashFactor = 0.8f;    // Vertical squash when jumping
     const float jumpStretchFactor = 1.2f;    // Horizontal stretch when jumping
     const float fallStretchFactor = 1.3f;    // Vertical stretch when falling
     const float fallSquashFactor = 0.9f;     // Horizontal squash when falling
-    const float hurtPulseDuration = 1.0f;    // Duration of hurt animation
     float hurtPulseTimer = 0.0f;            // Timer for hurt animation
     sf::Vector2f baseScale{ 1.0f, 1.0f };     // Store the base scale for animations
 
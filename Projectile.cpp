@@ -0,0 +1,219 @@
+#include "Projectile.h"
+#include "World.h"
+#include "PlayerCharacter.h"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+
+const float OFFSCREEN_MARGIN = 64.0f;   // Projectiles die once this far outside the world
+const float BUCKET_WIDTH = 64.0f;       // Width of the enemy broadphase columns
+const int BUCKET_COUNT = static_cast<int>(SCREEN_WIDTH / BUCKET_WIDTH) + 1;
+const float PROJECTILE_KNOCKBACK = 25.0f;
+
+int ProjectilePool::bucketOf(float x) const {
+    int column = static_cast<int>((x - bucketLeft) / bucketWidth);
+    return std::max(0, std::min(BUCKET_COUNT - 1, column));
+}
+
+ProjectilePool::ProjectilePool() : count(0), bucketLeft(0.0f), bucketWidth(BUCKET_WIDTH) {
+    vertices.resize(CAPACITY * 4);
+    bucketStart.resize(BUCKET_COUNT + 1);
+    bucketCursor.resize(BUCKET_COUNT);
+}
+
+bool ProjectilePool::spawn(const sf::Vector2f& position, const sf::Vector2f& velocity, float damageAmount,
+    float lifetime, float size, ProjectileOwner from, sf::Color tint) {
+    if (count >= CAPACITY)
+        return false; // Pool exhausted, drop the shot
+
+    int i = count++;
+    posX[i] = position.x;
+    posY[i] = position.y;
+    velX[i] = velocity.x;
+    velY[i] = velocity.y;
+    life[i] = lifetime;
+    damage[i] = damageAmount;
+    halfSize[i] = size / 2.0f;
+    owner[i] = from;
+    color[i] = tint;
+    dead[i] = false;
+    return true;
+}
+
+void ProjectilePool::update(float deltaTime) {
+    // Integration over plain float arrays so the compiler can vectorise it
+    for (int i = 0; i < count; ++i) {
+        posX[i] += velX[i] * deltaTime;
+        posY[i] += velY[i] * deltaTime;
+        life[i] -= deltaTime;
+    }
+
+    const sf::FloatRect& world = WorldBounds();
+    float left = world.left - OFFSCREEN_MARGIN;
+    float right = world.left + world.width + OFFSCREEN_MARGIN;
+    float top = world.top - OFFSCREEN_MARGIN;
+    float bottom = world.top + world.height + OFFSCREEN_MARGIN;
+    for (int i = 0; i < count; ++i) {
+        dead[i] = life[i] <= 0.0f ||
+            posX[i] < left || posX[i] > right ||
+            posY[i] < top || posY[i] > bottom;
+    }
+
+    // Compact: swap the last live projectile into each dead slot
+    for (int i = 0; i < count;) {
+        if (dead[i])
+            kill(i);
+        else
+            ++i;
+    }
+}
+
+void ProjectilePool::buildEnemyBuckets(std::vector<Enemy>& enemies) {
+    // Sized like the enemy list, so a horde growing into reserved room doesn't allocate here either
+    enemyBounds.reserve(enemies.capacity());
+    bucketEnemies.reserve(enemies.capacity() * 2); // Most enemies span one or two columns
+    enemyBounds.resize(enemies.size());
+    std::fill(bucketStart.begin(), bucketStart.end(), 0);
+
+    // Columns span the live enemies, widening past BUCKET_WIDTH when they are
+    // spread over more than a screen, so streamed levels keep a useful split
+    float minX = 0.0f;
+    float maxX = 0.0f;
+    bool any = false;
+    for (size_t e = 0; e < enemies.size(); ++e) {
+        enemyBounds[e] = enemies[e].getBounds();
+        if (!enemies[e].isAlive() || enemies[e].isDying())
+            continue;
+        minX = any ? std::min(minX, enemyBounds[e].left) : enemyBounds[e].left;
+        maxX = any ? std::max(maxX, enemyBounds[e].left + enemyBounds[e].width) : enemyBounds[e].left + enemyBounds[e].width;
+        any = true;
+    }
+    bucketLeft = minX;
+    bucketWidth = std::max(BUCKET_WIDTH, (maxX - minX) / BUCKET_COUNT + 1.0f);
+
+    // Count how many columns each enemy covers
+    for (size_t e = 0; e < enemies.size(); ++e) {
+        if (!enemies[e].isAlive() || enemies[e].isDying())
+            continue;
+        int first = bucketOf(enemyBounds[e].left);
+        int last = bucketOf(enemyBounds[e].left + enemyBounds[e].width);
+        for (int b = first; b <= last; ++b)
+            bucketStart[b + 1]++;
+    }
+    for (int b = 0; b < BUCKET_COUNT; ++b)
+        bucketStart[b + 1] += bucketStart[b];
+
+    // Scatter enemy indices into their columns
+    bucketEnemies.resize(bucketStart[BUCKET_COUNT]);
+    std::copy(bucketStart.begin(), bucketStart.end() - 1, bucketCursor.begin());
+    for (size_t e = 0; e < enemies.size(); ++e) {
+        if (!enemies[e].isAlive() || enemies[e].isDying())
+            continue;
+        int first = bucketOf(enemyBounds[e].left);
+        int last = bucketOf(enemyBounds[e].left + enemyBounds[e].width);
+        for (int b = first; b <= last; ++b)
+            bucketEnemies[bucketCursor[b]++] = static_cast<int>(e);
+    }
+}
+
+void ProjectilePool::resolveCollisions(std::vector<Enemy>& enemies, const Terrain& terrain, Player& player) {
+    Player* single = &player;
+    resolveCollisions(enemies, terrain, &single, 1);
+}
+
+void ProjectilePool::resolveCollisions(std::vector<Enemy>& enemies, const Terrain& terrain, Player* const* players, int playerCount) {
+    if (count == 0)
+        return;
+
+    // Bounds are fetched once per tick instead of once per projectile pair
+    buildEnemyBuckets(enemies);
+    playerBounds.resize(playerCount);
+    for (int p = 0; p < playerCount; ++p)
+        playerBounds[p] = players[p]->getHealth() > 0 ? players[p]->getBounds() : sf::FloatRect();
+
+    for (int i = 0; i < count; ++i) {
+        sf::FloatRect box(posX[i] - halfSize[i], posY[i] - halfSize[i], halfSize[i] * 2, halfSize[i] * 2);
+
+        if (terrain.isSolid(sf::Vector2f(posX[i], posY[i]))) {
+            dead[i] = true;
+            continue;
+        }
+
+        if (owner[i] == ProjectileOwner::Player) {
+            // Every column the shot's box covers, so one straddling an edge still hits
+            int first = bucketOf(box.left);
+            int last = bucketOf(box.left + box.width);
+            for (int column = first; column <= last && !dead[i]; ++column) {
+                for (int k = bucketStart[column]; k < bucketStart[column + 1]; ++k) {
+                    int e = bucketEnemies[k];
+                    // An enemy spanning columns was already tested in the earlier one
+                    if (column > first && bucketOf(enemyBounds[e].left) < column)
+                        continue;
+                    if (enemyBounds[e].intersects(box)) {
+                        sf::Vector2f hitDirection(velX[i] >= 0 ? 1.0f : -1.0f, 0.0f);
+                        enemies[e].takeDamage(damage[i], hitDirection, PROJECTILE_KNOCKBACK);
+                        dead[i] = true;
+                        break;
+                    }
+                }
+            }
+        }
+        else {
+            for (int p = 0; p < playerCount; ++p) {
+                if (playerBounds[p].intersects(box)) {
+                    players[p]->takeHit();
+                    dead[i] = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < count;) {
+        if (dead[i])
+            kill(i);
+        else
+            ++i;
+    }
+}
+
+void ProjectilePool::draw(RenderQueue& queue) {
+    // Each projectile is a diamond-shaped quad; the visible ones go out in one draw call
+    const sf::FloatRect& area = queue.visibleArea();
+    int visible = 0;
+    for (int i = 0; i < count; ++i) {
+        float h = halfSize[i];
+        if (posX[i] + h < area.left || posX[i] - h > area.left + area.width ||
+            posY[i] + h < area.top || posY[i] - h > area.top + area.height)
+            continue;
+
+        sf::Vertex* quad = &vertices[visible++ * 4];
+        quad[0].position = sf::Vector2f(posX[i], posY[i] - h);
+        quad[1].position = sf::Vector2f(posX[i] + h, posY[i]);
+        quad[2].position = sf::Vector2f(posX[i], posY[i] + h);
+        quad[3].position = sf::Vector2f(posX[i] - h, posY[i]);
+        quad[0].color = quad[1].color = quad[2].color = quad[3].color = color[i];
+    }
+    queue.submit(RenderLayer::Projectiles, vertices.data(), visible * 4, sf::Quads);
+}
+
+void ProjectilePool::clear() {
+    count = 0;
+}
+
+int ProjectilePool::size() const {
+    return count;
+}
+
+void ProjectilePool::kill(int index) {
+    int last = --count;
+    posX[index] = posX[last];
+    posY[index] = posY[last];
+    velX[index] = velX[last];
+    velY[index] = velY[last];
+    life[index] = life[last];
+    damage[index] = damage[last];
+    halfSize[index] = halfSize[last];
+    owner[index] = owner[last];
+    color[index] = color[last];
+    dead[index] = dead[last];
+}
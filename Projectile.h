@@ -0,0 +1,73 @@
+#ifndef PROJECTILE_H
+#define PROJECTILE_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "Terrain.h"
+#include "Enemy.h"
+#include "RenderQueue.h"
+
+class Player;
+
+// Who fired a projectile decides what it can hit
+enum class ProjectileOwner : sf::Uint8 {
+    Player,
+    Enemy
+};
+
+// Fixed-capacity projectile pool stored as structure-of-arrays.
+// Live projectiles are always packed in [0, count) so update, collision and
+// draw are straight loops over contiguous arrays; dead ones are swap-removed.
+class ProjectilePool {
+public:
+    static const int CAPACITY = 4096;
+
+    ProjectilePool();
+
+    // Member functions
+    bool spawn(const sf::Vector2f& position, const sf::Vector2f& velocity, float damage,
+        float lifetime, float size, ProjectileOwner owner, sf::Color color);
+    void update(float deltaTime);
+    void resolveCollisions(std::vector<Enemy>& enemies, const Terrain& terrain, Player& player);
+    void resolveCollisions(std::vector<Enemy>& enemies, const Terrain& terrain, Player* const* players, int playerCount);
+    void draw(RenderQueue& queue);
+    void clear();
+
+    int size() const;
+
+private:
+    friend class WorldSnapshot; // Copies the arrays in bulk
+    friend class GameServer;    // Quantises the arrays for clients
+
+    void kill(int index);
+    void buildEnemyBuckets(std::vector<Enemy>& enemies);
+    int bucketOf(float x) const;
+
+    int count;
+
+    // Projectile data, one entry per live projectile
+    float posX[CAPACITY];
+    float posY[CAPACITY];
+    float velX[CAPACITY];
+    float velY[CAPACITY];
+    float life[CAPACITY];
+    float damage[CAPACITY];
+    float halfSize[CAPACITY];
+    ProjectileOwner owner[CAPACITY];
+    sf::Color color[CAPACITY];
+    bool dead[CAPACITY];
+
+    // Collision caches rebuilt once per tick
+    std::vector<sf::FloatRect> enemyBounds;
+    std::vector<sf::FloatRect> playerBounds;
+    std::vector<int> bucketStart;   // Per column offset into bucketEnemies
+    std::vector<int> bucketCursor;  // Scatter position per column
+    std::vector<int> bucketEnemies; // Enemy indices sorted by column
+    float bucketLeft;               // World x of column 0
+    float bucketWidth;
+
+    // Preallocated quads for a single draw call
+    std::vector<sf::Vertex> vertices;
+};
+
+#endif // PROJECTILE_H
@@ -0,0 +1,144 @@
+#include "RenderQueue.h"
+#include <algorithm>
+
+RenderQueue::RenderQueue()
+    : culledThisFrame(0), spriteCount(0), shapeCount(0), drawnCount(0), culledCount(0), switchCount(0) {
+    // Past what a busy frame submits, so frames after the first don't grow them
+    commands.reserve(1024);
+    textures.reserve(16);
+    sprites.reserve(256);
+    shapes.reserve(64);
+    vertices.reserve(4096);
+}
+
+void RenderQueue::begin(const sf::View& newView) {
+    view = newView;
+    sf::Vector2f size = view.getSize();
+    area = sf::FloatRect(view.getCenter() - size / 2.0f, size);
+    commands.clear();
+    textures.clear();
+    vertices.clear();
+    spriteCount = 0;
+    shapeCount = 0;
+    culledThisFrame = 0;
+}
+
+bool RenderQueue::submit(RenderLayer layer, const sf::Sprite& sprite, RenderBlend blend) {
+    if (!isVisible(sprite.getGlobalBounds())) {
+        ++culledThisFrame;
+        return false;
+    }
+
+    // Assigning over an old copy keeps its storage
+    if (spriteCount == sprites.size())
+        sprites.push_back(sprite);
+    else
+        sprites[spriteCount] = sprite;
+
+    const sf::Texture* texture = sprite.getTexture();
+    Command command = { makeKey(layer, blend, texture), Kind::Sprite, blend, sf::Quads, texture, spriteCount++, 0 };
+    commands.push_back(command);
+    return true;
+}
+
+bool RenderQueue::submit(RenderLayer layer, const sf::RectangleShape& shape, RenderBlend blend) {
+    if (!isVisible(shape.getGlobalBounds())) {
+        ++culledThisFrame;
+        return false;
+    }
+
+    if (shapeCount == shapes.size())
+        shapes.push_back(shape);
+    else
+        shapes[shapeCount] = shape;
+
+    Command command = { makeKey(layer, blend, nullptr), Kind::Shape, blend, sf::Quads, nullptr, shapeCount++, 0 };
+    commands.push_back(command);
+    return true;
+}
+
+void RenderQueue::submit(RenderLayer layer, const sf::Vertex* batch, size_t vertexCount, sf::PrimitiveType type,
+    const sf::Texture* texture, RenderBlend blend) {
+    // Batches cull their own elements while building their vertices
+    if (vertexCount == 0)
+        return;
+
+    Command command = { makeKey(layer, blend, texture), Kind::Vertices, blend, type, texture, vertices.size(), vertexCount };
+    vertices.insert(vertices.end(), batch, batch + vertexCount);
+    commands.push_back(command);
+}
+
+void RenderQueue::flush(sf::RenderTarget& target) {
+    std::sort(commands.begin(), commands.end(), [](const Command& a, const Command& b) {
+        return a.key < b.key;
+        });
+
+    target.setView(view);
+    const sf::Texture* boundTexture = nullptr;
+    switchCount = 0;
+    for (const Command& command : commands) {
+        if (command.texture && command.texture != boundTexture) {
+            boundTexture = command.texture;
+            ++switchCount;
+        }
+
+        sf::RenderStates states(command.blend == RenderBlend::Add ? sf::BlendAdd : sf::BlendAlpha);
+        switch (command.kind) {
+        case Kind::Sprite:
+            target.draw(sprites[command.index], states);
+            break;
+        case Kind::Shape:
+            target.draw(shapes[command.index], states);
+            break;
+        case Kind::Vertices:
+            states.texture = command.texture;
+            target.draw(&vertices[command.index], command.vertexCount, command.type, states);
+            break;
+        }
+    }
+
+    drawnCount = static_cast<int>(commands.size());
+    culledCount = culledThisFrame;
+}
+
+bool RenderQueue::isVisible(const sf::FloatRect& bounds) const {
+    return area.intersects(bounds);
+}
+
+const sf::FloatRect& RenderQueue::visibleArea() const {
+    return area;
+}
+
+const sf::View& RenderQueue::getView() const {
+    return view;
+}
+
+int RenderQueue::drawn() const {
+    return drawnCount;
+}
+
+int RenderQueue::culled() const {
+    return culledCount;
+}
+
+int RenderQueue::textureSwitches() const {
+    return switchCount;
+}
+
+sf::Uint64 RenderQueue::makeKey(RenderLayer layer, RenderBlend blend, const sf::Texture* texture) {
+    // Textures are numbered in order of first use, so sorting on the id keeps
+    // the submission order between textures; 0 is untextured
+    sf::Uint64 textureId = 0;
+    if (texture) {
+        std::vector<const sf::Texture*>::iterator found = std::find(textures.begin(), textures.end(), texture);
+        textureId = static_cast<sf::Uint64>(found - textures.begin()) + 1;
+        if (found == textures.end())
+            textures.push_back(texture);
+    }
+
+    // layer:8 | blend:8 | texture:16 | submission order:32
+    return (static_cast<sf::Uint64>(layer) << 56) |
+        (static_cast<sf::Uint64>(blend) << 48) |
+        ((textureId & 0xFFFF) << 32) |
+        static_cast<sf::Uint64>(commands.size());
+}
@@ -0,0 +1,87 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+// Draw order, back to front
+enum class RenderLayer : sf::Uint8 {
+    Ground,
+    Objects,
+    Enemies,
+    EnemyBars,    // Health bars, above every enemy sprite
+    Projectiles,
+    Effects,
+    Player
+};
+
+enum class RenderBlend : sf::Uint8 {
+    Alpha,
+    Add
+};
+
+// Draw submissions for one frame. Anything outside the view is dropped on
+// submit; the rest is copied in and keyed by (layer, blend, texture,
+// submission order), then drawn in one sorted pass by flush(), so draws that
+// share a texture end up next to each other. Since the queue owns its copies
+// it can be filled on one thread and flushed on another, and nothing
+// submitted has to outlive the call. Storage is reused from frame to frame.
+class RenderQueue {
+public:
+    RenderQueue();
+
+    // Member functions
+    void begin(const sf::View& view);
+    bool submit(RenderLayer layer, const sf::Sprite& sprite, RenderBlend blend = RenderBlend::Alpha);
+    bool submit(RenderLayer layer, const sf::RectangleShape& shape, RenderBlend blend = RenderBlend::Alpha);
+    void submit(RenderLayer layer, const sf::Vertex* vertices, size_t vertexCount, sf::PrimitiveType type,
+        const sf::Texture* texture = nullptr, RenderBlend blend = RenderBlend::Alpha);
+    void flush(sf::RenderTarget& target);  // Can be repeated until the next begin()
+
+    bool isVisible(const sf::FloatRect& bounds) const;
+    const sf::FloatRect& visibleArea() const;
+    const sf::View& getView() const;
+
+    // Counts from the last flush
+    int drawn() const;
+    int culled() const;
+    int textureSwitches() const;
+
+private:
+    enum class Kind : sf::Uint8 {
+        Sprite,
+        Shape,
+        Vertices
+    };
+
+    struct Command {
+        sf::Uint64 key;
+        Kind kind;
+        RenderBlend blend;
+        sf::PrimitiveType type;
+        const sf::Texture* texture;
+        size_t index;        // Into sprites or shapes, or the first of the vertices
+        size_t vertexCount;
+    };
+
+    sf::Uint64 makeKey(RenderLayer layer, RenderBlend blend, const sf::Texture* texture);
+
+    sf::View view;
+    sf::FloatRect area;
+    std::vector<Command> commands;
+    std::vector<const sf::Texture*> textures;  // Texture ids for this frame, in order of first use
+    int culledThisFrame;
+
+    // Copies of what was submitted; only the first count of each are this frame's
+    std::vector<sf::Sprite> sprites;
+    std::vector<sf::RectangleShape> shapes;
+    std::vector<sf::Vertex> vertices;
+    size_t spriteCount;
+    size_t shapeCount;
+
+    int drawnCount;
+    int culledCount;
+    int switchCount;
+};
+
+#endif // RENDERQUEUE_H
@@ -0,0 +1,146 @@
+#include "RenderThread.h"
+#include "Telemetry.h"
+#include <chrono>
+
+RenderThread::RenderThread()
+    : window(nullptr), writing(0), reading(2), latest(1), drawnCount(0), renderMicros(0),
+    running(false), paused(true), released(false) {}
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+void RenderThread::start(sf::RenderWindow& target) {
+    if (running)
+        return;
+    window = &target;
+    running = true;
+    paused = true;
+    released = false;
+    worker = std::thread(&RenderThread::run, this);
+}
+
+void RenderThread::stop() {
+    if (!worker.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_all();
+    worker.join();
+    paused = true;
+    window->setActive(true);
+}
+
+void RenderThread::pause() {
+    if (!worker.joinable())
+        return;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (paused)
+            return;
+        paused = true;
+        wake.notify_all();
+        wake.wait(lock, [this] { return released; });
+    }
+    window->setActive(true);
+}
+
+void RenderThread::resume() {
+    if (!worker.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!paused)
+            return;
+        window->setActive(false); // A context can only be active on one thread
+        paused = false;
+    }
+    wake.notify_all();
+}
+
+RenderFrame& RenderThread::frame() {
+    return frames[writing];
+}
+
+void RenderThread::publish() {
+    writing = latest.exchange(writing | FRESH) & ~FRESH;
+    wake.notify_one();
+}
+
+int RenderThread::framesDrawn() const {
+    return drawnCount;
+}
+
+sf::Time RenderThread::renderTime() const {
+    return sf::microseconds(renderMicros.load(std::memory_order_relaxed));
+}
+
+bool RenderThread::acquire() {
+    if (!(latest.load() & FRESH))
+        return false;
+    reading = latest.exchange(reading) & ~FRESH;
+    return true;
+}
+
+void RenderThread::run() {
+    // Built here, so their fonts and textures are only ever touched by this thread
+    Hud hud;
+    StaticLayer staticLayer;
+    bool active = false;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (paused && running) {
+                if (active) {
+                    window->setActive(false);
+                    active = false;
+                }
+                released = true;
+                wake.notify_all();
+                wake.wait(lock, [this] { return !paused || !running; });
+                released = false;
+            }
+            if (!running)
+                break;
+
+            // Publishing doesn't lock, so a wakeup can be missed; the timeout bounds that to a couple of ms
+            wake.wait_for(lock, std::chrono::milliseconds(2), [this] {
+                return (latest.load() & FRESH) || paused || !running;
+                });
+            if (paused || !running)
+                continue;
+        }
+        if (!acquire())
+            continue;
+
+        if (!active) {
+            window->setActive(true);
+            active = true;
+        }
+        sf::Clock renderClock;
+        RenderFrame& frame = frames[reading];
+        if (frame.staticRevision != staticLayer.getRevision())
+            staticLayer.rebuild(frame.staticVertices, frame.staticArea, frame.staticRevision);
+
+        window->clear(sf::Color(18, 32, 32));
+        window->setView(frame.world.getView());
+        staticLayer.draw(*window);
+        frame.world.flush(*window);
+        hud.draw(*window, frame.hud);
+        sf::Time rendered = renderClock.getElapsedTime();
+        renderMicros.store(rendered.asMicroseconds(), std::memory_order_relaxed);
+        GameTelemetry().record(Timing::Render, rendered);
+        GameTelemetry().sample(Counter::DrawCalls, frame.world.drawn());
+        GameTelemetry().sample(Counter::Culled, frame.world.culled());
+        GameTelemetry().sample(Counter::TextureSwitches, frame.world.textureSwitches());
+
+        renderClock.restart();
+        window->display();
+        GameTelemetry().record(Timing::Present, renderClock.getElapsedTime());
+        ++drawnCount;
+    }
+    if (active)
+        window->setActive(false);
+}
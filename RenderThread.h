@@ -0,0 +1,72 @@
+#ifndef RENDERTHREAD_H
+#define RENDERTHREAD_H
+
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "RenderQueue.h"
+#include "Hud.h"
+#include "StaticLayer.h"
+
+// Everything the render thread needs for one frame, copied out of the simulation
+struct RenderFrame {
+    RenderQueue world;  // Begun with the camera
+    HudState hud;
+
+    // Level geometry for the static layer. Only recopied when the terrain's
+    // revision differs from the one this buffer last carried.
+    sf::Uint32 staticRevision = 0;
+    sf::FloatRect staticArea;
+    std::vector<sf::Vertex> staticVertices;
+};
+
+// Draws and presents frames on its own thread, so vsync or a slow present
+// never holds up the simulation. Frames pass through a triple buffer: the
+// simulation fills one, the render thread draws another, and the third holds
+// the newest finished frame. Publishing swaps the filled buffer with that
+// one, so neither side waits for the other and the renderer always picks up
+// the latest frame, skipping any it was too slow for.
+//
+// Menus still draw on the calling thread: pause() takes the window back, and
+// resume() hands it to the render thread again.
+class RenderThread {
+public:
+    RenderThread();
+    ~RenderThread();
+
+    // Member functions
+    void start(sf::RenderWindow& window);  // Starts paused
+    void stop();
+    void pause();
+    void resume();
+    RenderFrame& frame();  // The buffer to fill next
+    void publish();
+
+    int framesDrawn() const;
+    sf::Time renderTime() const;  // Drawing cost of the last frame, present excluded
+
+private:
+    static const int FRESH = 4;  // Set on the shared slot until the render thread takes it
+
+    void run();
+    bool acquire();
+
+    sf::RenderWindow* window;
+    RenderFrame frames[3];
+    int writing;             // Simulation's buffer
+    int reading;             // Render thread's buffer
+    std::atomic<int> latest; // Newest finished buffer, plus FRESH
+    std::atomic<int> drawnCount;
+    std::atomic<sf::Int64> renderMicros;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool running;
+    bool paused;
+    bool released;  // The render thread has let go of the window
+};
+
+#endif // RENDERTHREAD_H
@@ -0,0 +1,379 @@
+#include "Rewind.h"
+#include <SFML/Graphics.hpp>
+#include <cstring>
+#include <algorithm>
+
+const size_t MIN_MATCH = 4;          // Equal bytes needed to end a literal run
+const size_t MATCH_WINDOW = 16;      // How far past its last match an entity is looked for
+const sf::Uint8 NEW_ENTITY = 0x7F;   // Entity marker: nothing matched, encoded against zeros
+const sf::Uint8 UNCHANGED = 0x80;    // Entity marker flag: identical to its match, no delta follows
+
+// Run format: repeated [Run unchanged bytes][Run changed bytes][changed bytes...].
+// Base bytes past baseSize count as zeros, so a keyframe or a section that grew
+// encodes its new bytes against zeros.
+template <class Run>
+static void encodeRuns(const char* base, size_t baseSize, const char* current, size_t size, std::vector<char>& out) {
+    const size_t maxRun = static_cast<Run>(~Run(0));
+    auto unchanged = [&](size_t i) { return current[i] == (i < baseSize ? base[i] : 0); };
+
+    size_t i = 0;
+    while (i < size) {
+        size_t skip = 0;
+        while (i < size && skip < maxRun && unchanged(i)) {
+            ++i;
+            ++skip;
+        }
+
+        size_t start = i;
+        size_t length = 0;
+        while (i < size && length < maxRun) {
+            // Stop the literal once a long enough unchanged stretch follows
+            size_t same = 0;
+            while (same < MIN_MATCH && i + same < size && unchanged(i + same))
+                ++same;
+            if (same == MIN_MATCH || i + same == size)
+                break;
+            i += same + 1;
+            length += same + 1;
+        }
+        if (length > maxRun) {
+            i -= length - maxRun;
+            length = maxRun;
+        }
+
+        Run run[2] = { static_cast<Run>(skip), static_cast<Run>(length) };
+        out.insert(out.end(), reinterpret_cast<const char*>(run), reinterpret_cast<const char*>(run + 2));
+        out.insert(out.end(), current + start, current + start + length);
+    }
+}
+
+// Patches the changed bytes over frame, which already holds the base
+template <class Run>
+static const char* applyRuns(const char* delta, char* frame, size_t size) {
+    size_t position = 0;
+    while (position < size) {
+        Run run[2];
+        std::memcpy(run, delta, sizeof(run));
+        delta += sizeof(run);
+        position += run[0];
+        std::memcpy(frame + position, delta, run[1]);
+        delta += run[1];
+        position += run[1];
+    }
+    return delta;
+}
+
+// An entity's delta against its match (or zeros): a bit for each 4-byte word
+// that changed, a nibble for each changed word saying which of its bytes did,
+// then those bytes. A zero nibble means the word is the same as in the entity
+// before it, which catches the fields a whole horde shares, like the target
+// they chase. A moving enemy comes to about twenty bytes a tick.
+static void encodeEntity(const char* base, const char* entity, const char* before, size_t stride, std::vector<char>& out) {
+    const size_t words = (stride + 3) / 4;
+    auto changedBytes = [&](size_t w) {
+        sf::Uint8 changed = 0;
+        for (size_t i = w * 4; i < std::min(w * 4 + 4, stride); ++i) {
+            if (entity[i] != (base ? base[i] : 0))
+                changed |= 1 << (i - w * 4);
+        }
+        return changed;
+    };
+
+    size_t maskAt = out.size();
+    out.insert(out.end(), (words + 7) / 8, 0);
+    size_t changedWords = 0;
+    for (size_t w = 0; w < words; ++w) {
+        if (changedBytes(w)) {
+            out[maskAt + w / 8] |= 1 << (w % 8);
+            ++changedWords;
+        }
+    }
+
+    // Nibbles first, then the bytes, so both passes append
+    size_t nibblesAt = out.size();
+    out.insert(out.end(), (changedWords + 1) / 2, 0);
+    size_t nibble = 0;
+    for (size_t w = 0; w < words; ++w) {
+        sf::Uint8 changed = changedBytes(w);
+        if (!changed)
+            continue;
+        size_t end = std::min(w * 4 + 4, stride);
+        if (!before || std::memcmp(entity + w * 4, before + w * 4, end - w * 4) != 0) {
+            out[nibblesAt + nibble / 2] |= changed << (nibble % 2 * 4);
+            for (size_t i = w * 4; i < end; ++i) {
+                if (changed & (1 << (i - w * 4)))
+                    out.push_back(entity[i]);
+            }
+        }
+        ++nibble;
+    }
+}
+
+// Writes the changed bytes over entity, which already holds its match
+static const char* applyEntity(const char* delta, char* entity, size_t stride) {
+    const size_t words = (stride + 3) / 4;
+    const char* mask = delta;
+    const char* nibbles = mask + (words + 7) / 8;
+    size_t changedWords = 0;
+    for (size_t w = 0; w < words; ++w)
+        changedWords += (mask[w / 8] >> (w % 8)) & 1;
+    const char* bytes = nibbles + (changedWords + 1) / 2;
+
+    size_t nibble = 0;
+    for (size_t w = 0; w < words; ++w) {
+        if (!((mask[w / 8] >> (w % 8)) & 1))
+            continue;
+        size_t end = std::min(w * 4 + 4, stride);
+        sf::Uint8 changed = (static_cast<sf::Uint8>(nibbles[nibble / 2]) >> (nibble % 2 * 4)) & 0xF;
+        if (!changed)
+            std::memcpy(entity + w * 4, entity - stride + w * 4, end - w * 4);
+        for (size_t i = w * 4; i < end; ++i) {
+            if (changed & (1 << (i - w * 4)))
+                entity[i] = *bytes++;
+        }
+        ++nibble;
+    }
+    return bytes;
+}
+
+// Bytes that differ, counted no further than limit
+static size_t difference(const char* a, const char* b, size_t size, size_t limit) {
+    size_t count = 0;
+    for (size_t i = 0; i < size && count < limit; ++i)
+        count += a[i] != b[i];
+    return count;
+}
+
+// Entities keep their order from tick to tick; some die and a few arrive. Each one is
+// matched with the closest of the next few base entities after the previous match and
+// stored as a marker byte, saying which, plus its delta against it.
+static void encodeEntities(const char* base, size_t baseSize, const char* current, size_t size, size_t stride,
+    std::vector<char>& out) {
+    const size_t baseCount = baseSize / stride;
+    const size_t goodEnough = stride / 8;
+    size_t next = 0;
+    for (const char* entity = current; entity < current + size; entity += stride) {
+        size_t match = baseCount;
+        size_t best = stride / 2; // Anything further off is stored as new
+        for (size_t j = next; j < baseCount && j < next + MATCH_WINDOW && best > goodEnough; ++j) {
+            size_t differs = difference(base + j * stride, entity, stride, best);
+            if (differs < best) {
+                match = j;
+                best = differs;
+            }
+        }
+
+        if (match == baseCount) {
+            out.push_back(static_cast<char>(NEW_ENTITY));
+            encodeEntity(nullptr, entity, entity == current ? nullptr : entity - stride, stride, out);
+            continue;
+        }
+        sf::Uint8 marker = static_cast<sf::Uint8>(match - next);
+        out.push_back(static_cast<char>(best ? marker : marker | UNCHANGED));
+        if (best)
+            encodeEntity(base + match * stride, entity, entity == current ? nullptr : entity - stride, stride, out);
+        next = match + 1;
+    }
+}
+
+static const char* applyEntities(const char* delta, const char* base, char* frame, size_t size, size_t stride) {
+    size_t next = 0;
+    for (char* entity = frame; entity < frame + size; entity += stride) {
+        sf::Uint8 marker = static_cast<sf::Uint8>(*delta++);
+        if (marker == NEW_ENTITY) {
+            std::memset(entity, 0, stride);
+            delta = applyEntity(delta, entity, stride);
+            continue;
+        }
+        size_t match = next + (marker & ~UNCHANGED);
+        std::memcpy(entity, base + match * stride, stride);
+        if (!(marker & UNCHANGED))
+            delta = applyEntity(delta, entity, stride);
+        next = match + 1;
+    }
+    return delta;
+}
+
+// A frame is the delta of each of its sections against the same section of the
+// frame before, in order. Keyframes have no base.
+static void encodeFrame(const char* base, const char* frame, std::vector<char>& out) {
+    SnapshotSection from[WorldSnapshot::SECTION_COUNT] = {};
+    SnapshotSection to[WorldSnapshot::SECTION_COUNT];
+    if (base)
+        WorldSnapshot::sections(base, from);
+    WorldSnapshot::sections(frame, to);
+
+    out.clear();
+    for (int s = 0; s < WorldSnapshot::SECTION_COUNT; ++s) {
+        const char* section = base ? base + from[s].offset : nullptr;
+        if (to[s].stride)
+            encodeEntities(section, from[s].size, frame + to[s].offset, to[s].size, to[s].stride, out);
+        else
+            encodeRuns<sf::Uint16>(section, from[s].size, frame + to[s].offset, to[s].size, out);
+    }
+}
+
+static const char* decodeSection(const char* delta, const char* base, const SnapshotSection& from,
+    std::vector<char>& frame, const SnapshotSection& to) {
+    char* target = frame.data() + to.offset;
+    if (to.stride)
+        return applyEntities(delta, base ? base + from.offset : nullptr, target, to.size, to.stride);
+
+    size_t kept = std::min(from.size, to.size);
+    if (kept)
+        std::memcpy(target, base + from.offset, kept);
+    std::memset(target + kept, 0, to.size - kept);
+    return applyRuns<sf::Uint16>(delta, target, to.size);
+}
+
+static void decodeFrame(const char* base, const char* delta, std::vector<char>& frame) {
+    SnapshotSection from[WorldSnapshot::SECTION_COUNT] = {};
+    SnapshotSection to[WorldSnapshot::SECTION_COUNT];
+    if (base)
+        WorldSnapshot::sections(base, from);
+
+    // The first section holds the header, which says how big the rest are
+    to[0] = { 0, WorldSnapshot::FIXED_SIZE, 0 };
+    frame.resize(WorldSnapshot::FIXED_SIZE);
+    delta = decodeSection(delta, base, from[0], frame, to[0]);
+    WorldSnapshot::sections(frame.data(), to);
+
+    const SnapshotSection& last = to[WorldSnapshot::SECTION_COUNT - 1];
+    frame.resize(last.offset + last.size);
+    for (int s = 1; s < WorldSnapshot::SECTION_COUNT; ++s)
+        delta = decodeSection(delta, base, from[s], frame, to[s]);
+}
+
+RewindBuffer::RewindBuffer() : oldestFrame(0), frameCount(0), writeOffset(0), sinceKeyframe(0) {
+    // The whole budget up front, so recording doesn't allocate while the ring first fills
+    ring.resize(MEMORY_BUDGET);
+    frames.resize(MAX_FRAMES);
+}
+
+void RewindBuffer::record(const Player& player, const std::vector<Enemy>& enemies, const std::vector<Object>& objects,
+    const ProjectilePool& projectiles, const WaveDirector& director, int levelNumber, int currency) {
+    capture.capture(player, enemies, objects, projectiles, director, levelNumber, currency);
+    const std::vector<char>& frame = capture.data();
+    // An encoding never reaches twice its frame, so these only grow when the capture does
+    encoded.reserve(frame.capacity() * 2);
+    previous.reserve(frame.capacity());
+
+    bool keyframe = frameCount == 0 || sinceKeyframe >= FRAMES_PER_SEGMENT;
+    encodeFrame(keyframe ? nullptr : previous.data(), frame.data(), encoded);
+    if (!store(keyframe)) {
+        // One segment has filled the whole ring; start over from a keyframe
+        clear();
+        keyframe = true;
+        encodeFrame(nullptr, frame.data(), encoded);
+        if (!store(true))
+            return; // A single frame over budget; keep no history
+    }
+    sinceKeyframe = keyframe ? 1 : sinceKeyframe + 1;
+    previous.assign(frame.begin(), frame.end());
+}
+
+bool RewindBuffer::stepBack(WorldSnapshot& frame) {
+    if (frameCount < 2)
+        return false; // Keep the oldest frame so there is always something to land on
+
+    // Drop the newest frame; the one before it becomes the present
+    --frameCount;
+    const Frame& newest = frames[(oldestFrame + frameCount - 1) % MAX_FRAMES];
+    writeOffset = newest.offset + newest.size;
+
+    decodeNewest();
+    frame.assign(previous.data(), previous.size());
+    return true;
+}
+
+void RewindBuffer::clear() {
+    oldestFrame = 0;
+    frameCount = 0;
+    writeOffset = 0;
+    sinceKeyframe = 0;
+    previous.clear();
+}
+
+int RewindBuffer::framesStored() const {
+    return frameCount;
+}
+
+size_t RewindBuffer::bytesStored() const {
+    size_t bytes = 0;
+    for (int f = 0; f < frameCount; ++f)
+        bytes += frames[(oldestFrame + f) % MAX_FRAMES].size;
+    return bytes;
+}
+
+size_t RewindBuffer::memoryUsed() const {
+    return ring.capacity() + frames.capacity() * sizeof(Frame) + capture.data().capacity() +
+        encoded.capacity() + previous.capacity() + decoded.capacity();
+}
+
+// Copies the encoded frame in after the newest one, dropping the oldest segments
+// until it fits. Fails when only the segment this frame builds on is left.
+bool RewindBuffer::store(bool keyframe) {
+    size_t size = encoded.size();
+    if (size > ring.size())
+        return false;
+
+    while (frameCount) {
+        if (frameCount == MAX_FRAMES) {
+            if (!dropOldestSegment(keyframe))
+                return false;
+            continue;
+        }
+        size_t oldest = frames[oldestFrame].offset;
+        if (writeOffset > oldest) {
+            // Stored frames run from oldest up to here; use the end of the ring, else wrap
+            if (writeOffset + size <= ring.size())
+                break;
+            writeOffset = 0;
+        }
+        if (writeOffset + size <= oldest)
+            break;
+        if (!dropOldestSegment(keyframe))
+            return false;
+    }
+    if (!frameCount)
+        writeOffset = 0;
+
+    Frame& slot = frames[(oldestFrame + frameCount) % MAX_FRAMES];
+    slot.offset = static_cast<sf::Uint32>(writeOffset);
+    slot.size = static_cast<sf::Uint32>(size);
+    slot.keyframe = keyframe;
+    if (size)
+        std::memcpy(&ring[writeOffset], encoded.data(), size);
+    writeOffset += size;
+    ++frameCount;
+    return true;
+}
+
+// Drops the oldest keyframe and the deltas after it. A new keyframe depends on
+// nothing, so ahead of one even the newest segment may go.
+bool RewindBuffer::dropOldestSegment(bool beforeKeyframe) {
+    int dropped = 1;
+    while (dropped < frameCount && !frames[(oldestFrame + dropped) % MAX_FRAMES].keyframe)
+        ++dropped;
+    if (dropped == frameCount && !beforeKeyframe)
+        return false;
+
+    oldestFrame = (oldestFrame + dropped) % MAX_FRAMES;
+    frameCount -= dropped;
+    return true;
+}
+
+void RewindBuffer::decodeNewest() {
+    // Rebuild the newest frame from the keyframe it builds on plus the deltas after it.
+    // The oldest stored frame is always a keyframe.
+    int first = frameCount - 1;
+    while (!frames[(oldestFrame + first) % MAX_FRAMES].keyframe)
+        --first;
+
+    for (int f = first; f < frameCount; ++f) {
+        const Frame& stored = frames[(oldestFrame + f) % MAX_FRAMES];
+        decodeFrame(stored.keyframe ? nullptr : previous.data(), &ring[stored.offset], decoded);
+        previous.swap(decoded);
+    }
+    sinceKeyframe = frameCount - first;
+}
@@ -0,0 +1,56 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "Snapshot.h"
+
+// Gameplay rewind history. Every tick is captured as a WorldSnapshot and
+// stored as a delta against the previous tick, with a full keyframe every
+// FRAMES_PER_SEGMENT ticks. Deltas are taken section by section and each
+// entity is matched with its own state from the tick before, so deaths,
+// spawns and projectiles coming and going cost a few bytes rather than a
+// keyframe. Frames share one ring of MEMORY_BUDGET bytes; once it is full
+// the oldest keyframe and the deltas that depend on it are dropped.
+class RewindBuffer {
+public:
+    static const int FRAMES_PER_SEGMENT = 60;                    // Keyframe interval
+    static const int MAX_FRAMES = 120 * 60;                      // A minute of ticks, whatever they cost
+    static const size_t MEMORY_BUDGET = 8 * 1024 * 1024;         // Bytes of encoded frames
+
+    RewindBuffer();
+
+    // Member functions
+    void record(const Player& player, const std::vector<Enemy>& enemies, const std::vector<Object>& objects,
+        const ProjectilePool& projectiles, const WaveDirector& director, int levelNumber, int currency);
+    bool stepBack(WorldSnapshot& frame);
+    void clear();
+
+    int framesStored() const;
+    size_t bytesStored() const;  // Encoded history in the ring
+    size_t memoryUsed() const;
+
+private:
+    struct Frame {
+        sf::Uint32 offset;   // In the ring
+        sf::Uint32 size;     // Encoded bytes
+        bool keyframe;
+    };
+
+    bool store(bool keyframe);
+    bool dropOldestSegment(bool beforeKeyframe);
+    void decodeNewest();
+
+    std::vector<char> ring;
+    std::vector<Frame> frames;   // Circular index of what is in the ring
+    int oldestFrame;
+    int frameCount;
+    size_t writeOffset;          // Where the next frame goes
+    int sinceKeyframe;
+    WorldSnapshot capture;
+    std::vector<char> encoded;   // The frame being recorded
+    std::vector<char> previous;  // Decoded copy of the newest frame, the base for the next delta
+    std::vector<char> decoded;   // Scratch while rebuilding a frame from its keyframe
+};
+
+#endif // REWIND_H
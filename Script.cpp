@@ -0,0 +1,295 @@
+#include "Script.h"
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <new>
+
+// Frames are pooled by size in steps of FRAME_GRANULE; bigger ones go to the heap
+const std::size_t FRAME_GRANULE = 128;
+const std::size_t FRAME_CLASSES = 16;
+
+struct FreeFrame {
+    FreeFrame* next;
+};
+
+// Scripts are started and finished on the thread that owns their scheduler
+thread_local FreeFrame* freeFrames[FRAME_CLASSES] = {};
+
+static void* AllocateFrame(std::size_t size) {
+    std::size_t sizeClass = (size + FRAME_GRANULE - 1) / FRAME_GRANULE;
+    if (sizeClass >= FRAME_CLASSES)
+        return ::operator new(size);
+    if (FreeFrame* frame = freeFrames[sizeClass]) {
+        freeFrames[sizeClass] = frame->next;
+        return frame;
+    }
+    return ::operator new(sizeClass * FRAME_GRANULE);
+}
+
+static void ReleaseFrame(void* frame, std::size_t size) {
+    std::size_t sizeClass = (size + FRAME_GRANULE - 1) / FRAME_GRANULE;
+    if (sizeClass >= FRAME_CLASSES) {
+        ::operator delete(frame);
+        return;
+    }
+    FreeFrame* freed = static_cast<FreeFrame*>(frame);
+    freed->next = freeFrames[sizeClass];
+    freeFrames[sizeClass] = freed;
+}
+
+void* Script::promise_type::operator new(std::size_t size) {
+    return AllocateFrame(size);
+}
+
+void Script::promise_type::operator delete(void* frame, std::size_t size) {
+    ReleaseFrame(frame, size);
+}
+
+Script Script::promise_type::get_return_object() {
+    return Script(std::coroutine_handle<promise_type>::from_promise(*this));
+}
+
+void Script::promise_type::unhandled_exception() {
+    std::terminate();
+}
+
+Script::Script(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+Script::Script(Script&& other) noexcept : handle(other.handle) {
+    other.handle = nullptr;
+}
+
+Script& Script::operator=(Script&& other) noexcept {
+    if (this != &other) {
+        if (handle)
+            handle.destroy();
+        handle = other.handle;
+        other.handle = nullptr;
+    }
+    return *this;
+}
+
+Script::~Script() {
+    // Only scripts never handed to a scheduler still own their frame
+    if (handle)
+        handle.destroy();
+}
+
+const float PhasedScript::FOREVER = std::numeric_limits<float>::infinity();
+
+void* PhasedScript::promise_type::operator new(std::size_t size) {
+    return AllocateFrame(size);
+}
+
+void PhasedScript::promise_type::operator delete(void* frame, std::size_t size) {
+    ReleaseFrame(frame, size);
+}
+
+PhasedScript PhasedScript::promise_type::get_return_object() {
+    return PhasedScript(std::coroutine_handle<promise_type>::from_promise(*this));
+}
+
+void PhasedScript::promise_type::unhandled_exception() {
+    std::terminate();
+}
+
+bool PhasedScript::Wait::await_suspend(std::coroutine_handle<promise_type> handle) {
+    promise = &handle.promise();
+    promise->phase = phase;
+    promise->remaining = seconds - elapsed;
+    promise->elapsed = elapsed;
+    promise->interrupted = false;
+    return promise->remaining > 0.0f;  // Already over, e.g. restored past its end: carry straight on
+}
+
+bool PhasedScript::Wait::await_resume() {
+    bool interrupted = promise->interrupted;
+    promise->interrupted = false;
+    return interrupted;
+}
+
+PhasedScript PhasedScript::start(Factory factory, int phase, float elapsed) {
+    PhasedScript script = factory(phase, elapsed);
+    script.factory = factory;
+    return script;
+}
+
+PhasedScript::Wait PhasedScript::wait(int phase, float seconds, float elapsed) {
+    return Wait{ phase, seconds, elapsed, nullptr };
+}
+
+PhasedScript::PhasedScript() : handle(nullptr), factory(nullptr) {}
+
+PhasedScript::PhasedScript(std::coroutine_handle<promise_type> handle) : handle(handle), factory(nullptr) {}
+
+PhasedScript::PhasedScript(const PhasedScript& other) : handle(nullptr), factory(nullptr) {
+    if (other.handle && other.factory)
+        *this = start(other.factory, other.phase(), other.elapsed());
+}
+
+PhasedScript::PhasedScript(PhasedScript&& other) noexcept : handle(other.handle), factory(other.factory) {
+    other.handle = nullptr;
+}
+
+PhasedScript& PhasedScript::operator=(const PhasedScript& other) {
+    if (this != &other)
+        *this = PhasedScript(other);
+    return *this;
+}
+
+PhasedScript& PhasedScript::operator=(PhasedScript&& other) noexcept {
+    if (this != &other) {
+        if (handle)
+            handle.destroy();
+        handle = other.handle;
+        factory = other.factory;
+        other.handle = nullptr;
+    }
+    return *this;
+}
+
+PhasedScript::~PhasedScript() {
+    if (handle)
+        handle.destroy();
+}
+
+void PhasedScript::advance(float deltaTime) {
+    if (!handle || handle.done())
+        return;
+    promise_type& promise = handle.promise();
+    promise.elapsed += deltaTime;
+    promise.remaining -= deltaTime;
+    if (promise.remaining <= 0.0f)
+        handle.resume();
+}
+
+void PhasedScript::interrupt() {
+    if (!handle || handle.done())
+        return;
+    handle.promise().interrupted = true;
+    handle.resume();
+}
+
+int PhasedScript::phase() const {
+    return handle ? handle.promise().phase : 0;
+}
+
+float PhasedScript::elapsed() const {
+    return handle ? handle.promise().elapsed : 0.0f;
+}
+
+float PhasedScript::remaining() const {
+    return handle ? handle.promise().remaining : 0.0f;
+}
+
+bool ScriptScheduler::Sleep::await_ready() const noexcept {
+    return wake <= scheduler->now;
+}
+
+void ScriptScheduler::Sleep::await_suspend(std::coroutine_handle<> handle) {
+    Sleeper sleeper = { wake, handle };
+    scheduler->sleepers.push_back(sleeper);
+    std::push_heap(scheduler->sleepers.begin(), scheduler->sleepers.end(), &ScriptScheduler::wakesLater);
+}
+
+void ScriptScheduler::EventWait::await_suspend(std::coroutine_handle<> handle) {
+    event->waiting.push_back(handle);
+    if (std::find(scheduler->events.begin(), scheduler->events.end(), event) == scheduler->events.end())
+        scheduler->events.push_back(event);
+}
+
+ScriptEvent::ScriptEvent() {
+    waiting.reserve(4); // So the first scripts to wait don't allocate
+}
+
+ScriptScheduler::ScriptScheduler() : now(0) {
+    // A few of each, so the first waits after a scheduler is built don't allocate
+    sleepers.reserve(8);
+    conditions.reserve(8);
+    ready.reserve(8);
+    scripts.reserve(8);
+    events.reserve(4);
+}
+
+ScriptScheduler::~ScriptScheduler() {
+    clear();
+}
+
+void ScriptScheduler::start(Script script) {
+    std::coroutine_handle<> handle = script.handle;
+    script.handle = nullptr;
+    scripts.push_back(handle);
+    resume(handle);
+}
+
+void ScriptScheduler::update(float deltaTime) {
+    now += deltaTime;
+
+    // Due sleepers come off the top of the heap; the rest aren't looked at
+    while (!sleepers.empty() && sleepers.front().wake <= now) {
+        std::pop_heap(sleepers.begin(), sleepers.end(), &ScriptScheduler::wakesLater);
+        ready.push_back(sleepers.back().handle);
+        sleepers.pop_back();
+    }
+
+    for (size_t i = 0; i < conditions.size();) {
+        if (conditions[i]->test(conditions[i]->context)) {
+            ready.push_back(conditions[i]->handle);
+            conditions[i] = conditions.back();
+            conditions.pop_back();
+        }
+        else
+            ++i;
+    }
+
+    // Resumed scripts may wake others, which then run in this same pass
+    for (size_t i = 0; i < ready.size(); ++i)
+        resume(ready[i]);
+    ready.clear();
+}
+
+void ScriptScheduler::raise(ScriptEvent& event) {
+    ready.insert(ready.end(), event.waiting.begin(), event.waiting.end());
+    event.waiting.clear();
+}
+
+void ScriptScheduler::clear() {
+    sleepers.clear();
+    conditions.clear();
+    ready.clear();
+    for (ScriptEvent* event : events)
+        event->waiting.clear();
+    events.clear();
+    for (std::coroutine_handle<> handle : scripts)
+        handle.destroy();
+    scripts.clear();
+}
+
+int ScriptScheduler::running() const {
+    return static_cast<int>(scripts.size());
+}
+
+ScriptScheduler::Sleep ScriptScheduler::sleep(float seconds) {
+    return Sleep{ this, now + seconds };
+}
+
+ScriptScheduler::EventWait ScriptScheduler::waitFor(ScriptEvent& event) {
+    return EventWait{ this, &event };
+}
+
+bool ScriptScheduler::wakesLater(const Sleeper& a, const Sleeper& b) {
+    return a.wake > b.wake;
+}
+
+void ScriptScheduler::resume(std::coroutine_handle<> handle) {
+    handle.resume();
+    if (!handle.done())
+        return;
+
+    std::vector<std::coroutine_handle<>>::iterator finished = std::find(scripts.begin(), scripts.end(), handle);
+    if (finished != scripts.end()) {
+        *finished = scripts.back();
+        scripts.pop_back();
+    }
+    handle.destroy();
+}
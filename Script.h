@@ -0,0 +1,196 @@
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+#include <coroutine>
+#include <cstddef>
+#include <vector>
+
+// A coroutine run by a ScriptScheduler: a function returning Script that
+// co_awaits the scheduler's sleep, until and waitFor. Frames come from a
+// per-thread pool, so once warm, starting and finishing scripts never reaches
+// the heap.
+class Script {
+public:
+    struct promise_type {
+        Script get_return_object();
+        std::suspend_always initial_suspend() noexcept { return {}; }  // Runs once started
+        std::suspend_always final_suspend() noexcept { return {}; }    // Freed by the scheduler
+        void return_void() {}
+        void unhandled_exception();
+
+        static void* operator new(std::size_t size);
+        static void operator delete(void* frame, std::size_t size);
+    };
+
+    Script(Script&& other) noexcept;
+    Script& operator=(Script&& other) noexcept;
+    ~Script();
+
+private:
+    explicit Script(std::coroutine_handle<promise_type> handle);
+
+    std::coroutine_handle<promise_type> handle;
+
+    friend class ScriptScheduler;
+};
+
+// A script driven by its owner instead of a scheduler, for state that gets
+// copied, snapshotted and restored along with the object holding it. It
+// moves through numbered phases, each a timed wait: advance() only resumes
+// it once the wait runs out, and interrupt() cuts the wait short at once.
+// Only the phase and the time spent in it matter, so a copy is a fresh script
+// started there by the same factory, as is a restore.
+class PhasedScript {
+public:
+    typedef PhasedScript (*Factory)(int phase, float elapsed);
+
+    struct promise_type {
+        int phase = 0;
+        float remaining = 0.0f;  // Seconds left in the phase's wait
+        float elapsed = 0.0f;    // Seconds spent in the phase
+        bool interrupted = false;
+
+        PhasedScript get_return_object();
+        std::suspend_never initial_suspend() noexcept { return {}; }   // Runs to its first wait
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception();
+
+        static void* operator new(std::size_t size);
+        static void operator delete(void* frame, std::size_t size);
+    };
+
+    // co_await yields true if the owner interrupted the wait, false if it ran out
+    struct Wait {
+        int phase;
+        float seconds;
+        float elapsed;
+        promise_type* promise;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<promise_type> handle);
+        bool await_resume();
+    };
+
+    static const float FOREVER;
+
+    static PhasedScript start(Factory factory, int phase, float elapsed);
+    static Wait wait(int phase, float seconds, float elapsed);  // Counts elapsed as already spent
+
+    PhasedScript();
+    PhasedScript(const PhasedScript& other);
+    PhasedScript(PhasedScript&& other) noexcept;
+    PhasedScript& operator=(const PhasedScript& other);
+    PhasedScript& operator=(PhasedScript&& other) noexcept;
+    ~PhasedScript();
+
+    // Member functions
+    void advance(float deltaTime);
+    void interrupt();
+    int phase() const;    // 0 when there is no script
+    float elapsed() const;
+    float remaining() const;
+
+private:
+    explicit PhasedScript(std::coroutine_handle<promise_type> handle);
+
+    std::coroutine_handle<promise_type> handle;
+    Factory factory;
+};
+
+// Something scripts can wait for. It holds their frames until raised, so
+// declare it before the scheduler whose scripts wait on it: the scheduler's
+// clear() empties it, and must run while it still exists.
+class ScriptEvent {
+public:
+    ScriptEvent();
+
+private:
+    std::vector<std::coroutine_handle<>> waiting;
+
+    friend class ScriptScheduler;
+};
+
+// Owns running scripts and resumes only those whose wait is over. Sleepers sit
+// in a heap on wake time and event waiters on their event, so neither costs
+// anything per tick until it wakes; only conditions are tested every update.
+class ScriptScheduler {
+public:
+    // A condition waiter as the scheduler sees it; lives in the script's frame
+    struct ConditionWait {
+        bool (*test)(const void* context);
+        const void* context;
+        std::coroutine_handle<> handle;
+    };
+
+    struct Sleep {
+        ScriptScheduler* scheduler;
+        double wake;
+
+        bool await_ready() const noexcept;
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+    };
+
+    template <class Condition>
+    struct Until {
+        ScriptScheduler* scheduler;
+        Condition condition;
+        ConditionWait wait;
+
+        static bool test(const void* context) { return static_cast<const Until*>(context)->condition(); }
+        bool await_ready() const { return condition(); }
+        void await_suspend(std::coroutine_handle<> handle) {
+            wait.test = &Until::test;
+            wait.context = this;
+            wait.handle = handle;
+            scheduler->conditions.push_back(&wait);
+        }
+        void await_resume() const noexcept {}
+    };
+
+    struct EventWait {
+        ScriptScheduler* scheduler;
+        ScriptEvent* event;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+    };
+
+    ScriptScheduler();
+    ~ScriptScheduler();
+    ScriptScheduler(const ScriptScheduler&) = delete;
+    ScriptScheduler& operator=(const ScriptScheduler&) = delete;
+
+    // Member functions
+    void start(Script script);       // Runs it up to its first wait
+    void update(float deltaTime);
+    void raise(ScriptEvent& event);  // Its waiters run on the next update
+    void clear();                    // Drops every script where it stands
+    int running() const;
+
+    // For scripts to co_await
+    Sleep sleep(float seconds);
+    template <class Condition>
+    Until<Condition> until(Condition condition) { return Until<Condition>{ this, condition, ConditionWait() }; }
+    EventWait waitFor(ScriptEvent& event);
+
+private:
+    struct Sleeper {
+        double wake;
+        std::coroutine_handle<> handle;
+    };
+
+    static bool wakesLater(const Sleeper& a, const Sleeper& b);  // Heap order, soonest on top
+    void resume(std::coroutine_handle<> handle);
+
+    double now;
+    std::vector<Sleeper> sleepers;             // Min-heap on wake
+    std::vector<ConditionWait*> conditions;
+    std::vector<std::coroutine_handle<>> ready;
+    std::vector<std::coroutine_handle<>> scripts;
+    std::vector<ScriptEvent*> events;          // Waited on by these scripts, emptied by clear()
+};
+
+#endif // SCRIPT_H
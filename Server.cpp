@@ -0,0 +1,497 @@
+#include "Server.h"
+#include "World.h"
+#include "Snapshot.h"
+#include "Particles.h"
+#include "Levels.cpp"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <iostream>
+
+const float CLIENT_TIMEOUT = 5.0f;   // Seconds without packets before a slot is freed
+const float RESPAWN_TIME = 3.0f;
+const size_t FRAGMENT_COUNT_OFFSET = 18; // Where the fragment count sits in a State header
+
+sf::Texture& TextureManager(const std::string& texturePath);
+
+GameServer::GameServer(float playerSpeed, int hordeSize)
+    : playerSpeed(playerSpeed), hordeSize(std::min(hordeSize, MAX_HORDE)), tickNumber(0), currency(0),
+    nextEnemyId(NET_MAX_CLIENTS), spawnCursor(0), fragmentsUsed(0), fragmentBaseline(0), fragmentLastInput(0),
+    rng(0x9E3779B9) {
+    Level arena(NET_ARENA_LEVEL, SCREEN_WIDTH, SCREEN_HEIGHT);
+    terrain = arena.terrain;
+    flowField = arena.flowField;
+    navGraph = arena.navGraph;
+    spawnPosition = arena.spawnPosition;
+    clients.resize(NET_MAX_CLIENTS);
+
+    // Build every enemy slot up front, grouped by archetype so updateGroup runs stay long.
+    // Mix: 40% walkers, 35% flyers, 25% chargers, with the same stats as the campaign rooms.
+    int walkers = this->hordeSize * 40 / 100;
+    int flyers = this->hordeSize * 35 / 100;
+    enemies.reserve(this->hordeSize);
+    for (int i = 0; i < this->hordeSize; ++i) {
+        EnemyKindId kind = i < walkers ? ((i % 2) ? WEAK_WALKER_KIND : WALKER_KIND) :
+            i < walkers + flyers ? FLYER_KIND : CHARGER_KIND;
+        enemies.push_back(Enemy(sf::Vector2f(0, 0), kind));
+        enemyFlags.push_back(static_cast<sf::Uint8>(
+            (static_cast<int>(GetEnemyKind(kind).archetype) << NET_ARCHETYPE_SHIFT) | (GetEnemyKind(kind).textureId << NET_TEXTURE_SHIFT)));
+    }
+
+    // Remember each slot's fresh state, then start them all dead so the refill spawns them
+    spawnStates.resize(enemies.size());
+    for (size_t i = 0; i < enemies.size(); ++i) {
+        enemies[i].saveState(spawnStates[i]);
+        EnemyState dead = spawnStates[i];
+        dead.alive = false;
+        enemies[i].loadState(dead);
+    }
+    enemyIds.assign(enemies.size(), 0);
+    enemyIdInUse.assign(0x10000, false);
+}
+
+bool GameServer::start(unsigned short port) {
+    if (socket.bind(port) != sf::Socket::Done) {
+        std::cerr << "Server could not bind UDP port " << port << std::endl;
+        return false;
+    }
+    socket.setBlocking(false);
+    return true;
+}
+
+void GameServer::tick() {
+    sf::Clock timer;
+    ++tickNumber;
+
+    receive();
+    simulate();
+    captureFrame();
+    for (int slot = 0; slot < NET_MAX_CLIENTS; ++slot) {
+        if (clients[slot].connected)
+            sendState(slot);
+    }
+
+    // Nobody watches the server's effects
+    Particles().clear();
+
+    float elapsed = timer.getElapsedTime().asSeconds();
+    counters.ticks++;
+    counters.totalTickTime += elapsed;
+    counters.maxTickTime = std::max(counters.maxTickTime, elapsed);
+}
+
+void GameServer::receive() {
+    sf::IpAddress address;
+    unsigned short remotePort;
+    std::size_t received;
+    while (true) {
+        incoming.bytes.resize(NET_MAX_PACKET);
+        if (socket.receive(incoming.bytes.data(), incoming.bytes.size(), received, address, remotePort) != sf::Socket::Done)
+            break;
+        incoming.bytes.resize(received);
+        incoming.cursor = 0;
+
+        sf::Uint32 protocol;
+        NetMessage message;
+        if (!incoming.read(protocol) || protocol != NET_PROTOCOL_ID || !incoming.read(message))
+            continue;
+
+        int slot = findClient(address, remotePort);
+        switch (message) {
+        case NetMessage::Hello:
+            handleHello(address, remotePort);
+            break;
+        case NetMessage::Input:
+            if (slot >= 0)
+                handleInput(clients[slot], incoming);
+            break;
+        case NetMessage::Bye:
+            if (slot >= 0) {
+                clients[slot].connected = false;
+                clients[slot].player.reset();
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void GameServer::handleHello(const sf::IpAddress& address, unsigned short port) {
+    int slot = findClient(address, port);
+    if (slot < 0) {
+        for (int i = 0; i < NET_MAX_CLIENTS && slot < 0; ++i) {
+            if (!clients[i].connected)
+                slot = i;
+        }
+        if (slot < 0)
+            return; // Full, the client keeps retrying
+
+        Client& client = clients[slot];
+        client = Client();
+        client.connected = true;
+        client.address = address;
+        client.port = port;
+        client.player.reset(new Player(NetSpawnPosition(spawnPosition, slot), TextureManager("Textures/Player.png"),
+            TextureManager("Textures/Weapon1.png"), playerSpeed));
+    }
+
+    // Sent again for a repeated Hello, in case the first Welcome was lost
+    outgoing.clear();
+    outgoing.write(NET_PROTOCOL_ID);
+    outgoing.write(NetMessage::Welcome);
+    outgoing.write(static_cast<sf::Uint8>(slot));
+    outgoing.write(static_cast<sf::Int32>(NET_ARENA_LEVEL));
+    outgoing.write(tickNumber);
+    socket.send(outgoing.bytes.data(), outgoing.size(), address, port);
+}
+
+void GameServer::handleInput(Client& client, NetBuffer& packet) {
+    sf::Uint32 ackTick;
+    sf::Uint32 firstSequence;
+    sf::Uint8 count;
+    if (!packet.read(ackTick) || !packet.read(firstSequence) || !packet.read(count))
+        return;
+
+    client.silentTime = 0.0f;
+    if (ackTick > client.ackTick && ackTick <= tickNumber)
+        client.ackTick = ackTick;
+
+    // Inputs arrive several times over; only queue the ones not seen yet
+    for (sf::Uint32 i = 0; i < count; ++i) {
+        PlayerInput input;
+        input.sequence = firstSequence + i;
+        if (!packet.read(input.buttons))
+            return;
+        if (input.sequence <= client.lastQueued)
+            continue;
+
+        if (client.queueSize == INPUT_QUEUE) {
+            // Client is running ahead; drop the oldest input
+            client.queueHead = (client.queueHead + 1) % INPUT_QUEUE;
+            --client.queueSize;
+        }
+        client.queue[(client.queueHead + client.queueSize) % INPUT_QUEUE] = input;
+        ++client.queueSize;
+        client.lastQueued = input.sequence;
+    }
+}
+
+void GameServer::simulate() {
+    // Players: one queued input per tick each
+    livePlayers.clear();
+    for (Client& client : clients) {
+        if (!client.connected)
+            continue;
+
+        client.silentTime += NET_TICK;
+        if (client.silentTime > CLIENT_TIMEOUT) {
+            client.connected = false;
+            client.player.reset();
+            continue;
+        }
+
+        Player& player = *client.player;
+        if (player.getHealth() <= 0) {
+            client.respawnTimer += NET_TICK;
+            if (client.respawnTimer >= RESPAWN_TIME) {
+                client.respawnTimer = 0.0f;
+                player.SetHealth(10);
+                player.SetPosition(spawnPosition);
+            }
+        }
+
+        if (client.queueSize > 0) {
+            client.current = client.queue[client.queueHead];
+            client.queueHead = (client.queueHead + 1) % INPUT_QUEUE;
+            --client.queueSize;
+            client.lastProcessed = client.current.sequence;
+        }
+        NetStepPlayer(player, terrain, enemies, client.current, SCREEN_WIDTH);
+        player.throwProjectiles(projectiles, NET_TICK, client.current);
+
+        if (player.getHealth() > 0)
+            livePlayers.push_back(&player);
+    }
+
+    spawnHorde();
+
+    if (!livePlayers.empty()) {
+        // The shared pathfinding fields follow the player nearest the middle of the horde;
+        // each enemy still aims and shoots at whichever player is closest to it
+        sf::Vector2f centre(0, 0);
+        int alive = 0;
+        for (Enemy& enemy : enemies) {
+            if (enemy.isAlive()) {
+                centre += enemy.position();
+                ++alive;
+            }
+        }
+        if (alive)
+            centre /= static_cast<float>(alive);
+
+        enemyTargets.resize(enemies.size());
+        int focus = 0;
+        float focusDistance = -1.0f;
+        for (size_t p = 0; p < livePlayers.size(); ++p) {
+            sf::Vector2f offset = livePlayers[p]->position() - centre;
+            float distance = offset.x * offset.x + offset.y * offset.y;
+            if (focusDistance < 0 || distance < focusDistance) {
+                focusDistance = distance;
+                focus = static_cast<int>(p);
+            }
+        }
+        Player& focusPlayer = *livePlayers[focus];
+        flowField.setTarget(focusPlayer.position());
+        navGraph.setGoal(focusPlayer.position() + sf::Vector2f(0, focusPlayer.getBounds().height / 2));
+
+        for (size_t e = 0; e < enemies.size(); ++e) {
+            if (!enemies[e].isAlive())
+                continue;
+            sf::Vector2f position = enemies[e].position();
+            int nearest = 0;
+            float nearestDistance = -1.0f;
+            for (size_t p = 0; p < livePlayers.size(); ++p) {
+                sf::Vector2f offset = livePlayers[p]->position() - position;
+                float distance = offset.x * offset.x + offset.y * offset.y;
+                if (nearestDistance < 0 || distance < nearestDistance) {
+                    nearestDistance = distance;
+                    nearest = static_cast<int>(p);
+                }
+            }
+            enemyTargets[e] = nearest;
+        }
+
+        // One specialised kernel call per run of same-archetype enemies chasing the same player
+        Enemy* enemyData = enemies.data();
+        for (size_t first = 0; first < enemies.size();) {
+            size_t last = first + 1;
+            while (last < enemies.size() && enemies[last].archetype() == enemies[first].archetype() &&
+                enemyTargets[last] == enemyTargets[first])
+                ++last;
+
+            sf::Vector2f target = livePlayers[enemyTargets[first]]->position();
+            switch (enemies[first].archetype()) {
+            case EnemyArchetype::Walker:
+                Enemy::updateGroup<WalkerBehaviour>(enemyData + first, enemyData + last, NET_TICK, terrain,
+                    flowField, navGraph, projectiles, target, currency);
+                break;
+            case EnemyArchetype::Flyer:
+                Enemy::updateGroup<FlyerBehaviour>(enemyData + first, enemyData + last, NET_TICK, terrain,
+                    flowField, navGraph, projectiles, target, currency);
+                break;
+            case EnemyArchetype::Charger:
+                Enemy::updateGroup<ChargerBehaviour>(enemyData + first, enemyData + last, NET_TICK, terrain,
+                    flowField, navGraph, projectiles, target, currency);
+                break;
+            }
+            first = last;
+        }
+    }
+
+    projectiles.update(NET_TICK);
+    projectiles.resolveCollisions(enemies, terrain, livePlayers.data(), static_cast<int>(livePlayers.size()));
+}
+
+void GameServer::spawnHorde() {
+    // Revive a few dead slots per tick, walking the slots round-robin
+    int spawned = 0;
+    for (size_t checked = 0; checked < enemies.size() && spawned < SPAWNS_PER_TICK; ++checked) {
+        int slot = spawnCursor;
+        spawnCursor = (spawnCursor + 1) % static_cast<int>(enemies.size());
+        if (enemies[slot].isAlive())
+            continue;
+
+        // xorshift, good enough for spawn spots
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        EnemyState state = spawnStates[slot];
+        state.position.x = 40.0f + (rng % static_cast<sf::Uint32>(SCREEN_WIDTH - 80));
+        state.position.y = state.flying ? SCREEN_HEIGHT / 4 : SCREEN_HEIGHT / 2;
+        state.originalY = state.position.y;
+        state.alive = true;
+        enemies[slot].loadState(state);
+
+        // The slot's old id is free again. Ids wrap, so skip any a long-lived enemy
+        // still holds; the horde is far smaller than the id space, so this ends.
+        enemyIdInUse[enemyIds[slot]] = false;
+        while (enemyIdInUse[nextEnemyId])
+            nextEnemyId = nextEnemyId == 0xFFFF ? static_cast<sf::Uint16>(NET_MAX_CLIENTS) : nextEnemyId + 1;
+        enemyIds[slot] = nextEnemyId;
+        enemyIdInUse[nextEnemyId] = true;
+        nextEnemyId = nextEnemyId == 0xFFFF ? static_cast<sf::Uint16>(NET_MAX_CLIENTS) : nextEnemyId + 1;
+        ++spawned;
+    }
+}
+
+void GameServer::captureFrame() {
+    NetFrame& frame = history[tickNumber % NET_HISTORY];
+    frame.tick = tickNumber;
+    frame.entities.clear();
+    frame.projectiles.clear();
+
+    for (int slot = 0; slot < NET_MAX_CLIENTS; ++slot) {
+        if (!clients[slot].connected)
+            continue;
+        Player& player = *clients[slot].player;
+        NetEntity entity;
+        entity.id = static_cast<sf::Uint16>(slot);
+        entity.x = QuantizePosition(player.position().x);
+        entity.y = QuantizePosition(player.position().y);
+        entity.health = QuantizeHealth(player.getHealth());
+        entity.flags = (player.facingRight ? NET_FACING_RIGHT : 0) | (player.getWeapon().isAttacking ? NET_ATTACKING : 0);
+        frame.entities.push_back(entity);
+    }
+    size_t playerCount = frame.entities.size();
+
+    for (size_t e = 0; e < enemies.size(); ++e) {
+        Enemy& enemy = enemies[e];
+        if (!enemy.isAlive())
+            continue;
+        NetEntity entity;
+        entity.id = enemyIds[e];
+        entity.x = QuantizePosition(enemy.position().x);
+        entity.y = QuantizePosition(enemy.position().y);
+        entity.health = QuantizeHealth(enemy.getHealth());
+        entity.flags = enemyFlags[e] | (enemy.isFacingRight() ? NET_FACING_RIGHT : 0) | (enemy.isDying() ? NET_DYING : 0);
+        frame.entities.push_back(entity);
+    }
+    // Slots revive in any order, so enemy ids need sorting for the delta merge
+    std::sort(frame.entities.begin() + playerCount, frame.entities.end(),
+        [](const NetEntity& a, const NetEntity& b) { return a.id < b.id; });
+
+    int count = std::min(projectiles.count, NET_MAX_PROJECTILES);
+    for (int i = 0; i < count; ++i) {
+        NetProjectile projectile;
+        projectile.x = QuantizePosition(projectiles.posX[i]);
+        projectile.y = QuantizePosition(projectiles.posY[i]);
+        projectile.velocityX = static_cast<sf::Int16>(projectiles.velX[i]);
+        projectile.velocityY = static_cast<sf::Int16>(projectiles.velY[i]);
+        projectile.owner = static_cast<sf::Uint8>(projectiles.owner[i]);
+        frame.projectiles.push_back(projectile);
+    }
+}
+
+void GameServer::sendState(int slot) {
+    Client& client = clients[slot];
+    const NetFrame& current = history[tickNumber % NET_HISTORY];
+
+    // Delta against the newest frame the client has confirmed, if it is still in history
+    const NetFrame* baseline = nullptr;
+    if (client.ackTick != 0 && tickNumber - client.ackTick < NET_HISTORY &&
+        history[client.ackTick % NET_HISTORY].tick == client.ackTick)
+        baseline = &history[client.ackTick % NET_HISTORY];
+
+    fragmentBaseline = baseline ? baseline->tick : 0;
+    fragmentLastInput = client.lastProcessed;
+    fragmentsUsed = 0;
+    openFragment();
+
+    // The client's own player goes out in full and unquantised, so replaying inputs on top is exact
+    PlayerState self = PlayerState();
+    client.player->saveState(self);
+    NetBuffer& selfOut = room(sizeof(NetEntry) + sizeof(PlayerState));
+    selfOut.write(NetEntry::Self);
+    selfOut.write(self);
+
+    // Merge walk over both id-sorted lists: changed, new and removed entities
+    const size_t ENTITY_ENTRY_SIZE = 10;
+    size_t i = 0;
+    size_t j = 0;
+    size_t baseCount = baseline ? baseline->entities.size() : 0;
+    while (i < current.entities.size() || j < baseCount) {
+        if (j < baseCount && (i == current.entities.size() || baseline->entities[j].id < current.entities[i].id)) {
+            WriteEntityRemoval(room(ENTITY_ENTRY_SIZE), baseline->entities[j].id);
+            ++j;
+        }
+        else if (j < baseCount && baseline->entities[j].id == current.entities[i].id) {
+            WriteEntityDelta(room(ENTITY_ENTRY_SIZE), &baseline->entities[j], current.entities[i]);
+            ++i;
+            ++j;
+        }
+        else {
+            WriteEntityDelta(room(ENTITY_ENTRY_SIZE), nullptr, current.entities[i]);
+            ++i;
+        }
+    }
+
+    // Projectiles are short-lived, so they are resent each frame in as few entries as fit
+    const size_t PROJECTILE_SIZE = 9;
+    for (size_t p = 0; p < current.projectiles.size();) {
+        NetBuffer& out = room(sizeof(NetEntry) + 1 + PROJECTILE_SIZE);
+        size_t fit = (NET_MAX_PACKET - out.size() - sizeof(NetEntry) - 1) / PROJECTILE_SIZE;
+        size_t count = std::min(std::min(fit, current.projectiles.size() - p), static_cast<size_t>(255));
+        out.write(NetEntry::Projectiles);
+        out.write(static_cast<sf::Uint8>(count));
+        for (size_t k = p; k < p + count; ++k) {
+            const NetProjectile& projectile = current.projectiles[k];
+            out.write(projectile.x);
+            out.write(projectile.y);
+            out.write(projectile.velocityX);
+            out.write(projectile.velocityY);
+            out.write(projectile.owner);
+        }
+        p += count;
+    }
+
+    for (int f = 0; f < fragmentsUsed; ++f) {
+        NetBuffer& out = fragments[f];
+        out.bytes[FRAGMENT_COUNT_OFFSET] = static_cast<char>(fragmentsUsed);
+        socket.send(out.bytes.data(), out.size(), client.address, client.port);
+        counters.bytesSent += out.size();
+        counters.packetsSent++;
+    }
+}
+
+void GameServer::openFragment() {
+    if (fragmentsUsed == static_cast<int>(fragments.size()))
+        fragments.push_back(NetBuffer());
+    NetBuffer& out = fragments[fragmentsUsed];
+    out.clear();
+    out.write(NET_PROTOCOL_ID);
+    out.write(NetMessage::State);
+    out.write(tickNumber);
+    out.write(fragmentBaseline);
+    out.write(fragmentLastInput);
+    out.write(static_cast<sf::Uint8>(fragmentsUsed));
+    out.write(static_cast<sf::Uint8>(0)); // Fragment count, patched before sending
+    ++fragmentsUsed;
+}
+
+NetBuffer& GameServer::room(size_t bytes) {
+    // MAX_HORDE keeps a frame from ever needing more than MAX_FRAGMENTS
+    if (fragments[fragmentsUsed - 1].size() + bytes > NET_MAX_PACKET && fragmentsUsed < MAX_FRAGMENTS)
+        openFragment();
+    return fragments[fragmentsUsed - 1];
+}
+
+int GameServer::findClient(const sf::IpAddress& address, unsigned short port) const {
+    for (int slot = 0; slot < NET_MAX_CLIENTS; ++slot) {
+        const Client& client = clients[slot];
+        if (client.connected && client.port == port && client.address == address)
+            return slot;
+    }
+    return -1;
+}
+
+unsigned short GameServer::port() const {
+    return socket.getLocalPort();
+}
+
+int GameServer::clientCount() const {
+    int count = 0;
+    for (const Client& client : clients)
+        count += client.connected ? 1 : 0;
+    return count;
+}
+
+int GameServer::enemyCount() {
+    int count = 0;
+    for (Enemy& enemy : enemies)
+        count += enemy.isAlive() ? 1 : 0;
+    return count;
+}
+
+ServerStats& GameServer::stats() {
+    return counters;
+}
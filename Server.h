@@ -0,0 +1,110 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Network.hpp>
+#include <vector>
+#include <memory>
+#include "NetProtocol.h"
+#include "Projectile.h"
+#include "Terrain.h"
+#include "FlowField.h"
+#include "NavGraph.h"
+
+// Running totals a host can print and reset
+struct ServerStats {
+    int ticks = 0;
+    float totalTickTime = 0.0f;  // Seconds spent inside tick()
+    float maxTickTime = 0.0f;
+    size_t bytesSent = 0;
+    size_t packetsSent = 0;
+};
+
+// Headless authoritative simulation. Each fixed tick it drains client inputs,
+// steps every player and the horde, then sends each client the world as a
+// delta against the last frame that client acknowledged.
+class GameServer {
+public:
+    static const int INPUT_QUEUE = 16;      // Buffered inputs per client
+    static const int SPAWNS_PER_TICK = 8;   // Horde refill rate
+    static const int MAX_HORDE = 8192;      // Keeps a full frame well under 255 fragments
+    static const int MAX_FRAGMENTS = 255;
+
+    GameServer(float playerSpeed, int hordeSize);
+
+    // Member functions
+    bool start(unsigned short port);
+    void tick();
+
+    unsigned short port() const;
+    int clientCount() const;
+    int enemyCount();
+    ServerStats& stats();
+
+private:
+    struct Client {
+        bool connected = false;
+        sf::IpAddress address;
+        unsigned short port = 0;
+        std::unique_ptr<Player> player;
+        PlayerInput queue[INPUT_QUEUE];  // Ring of inputs not yet simulated
+        int queueHead = 0;
+        int queueSize = 0;
+        PlayerInput current;             // Repeated when no new input has arrived
+        sf::Uint32 lastQueued = 0;
+        sf::Uint32 lastProcessed = 0;
+        sf::Uint32 ackTick = 0;          // Newest frame the client has in full
+        float silentTime = 0.0f;
+        float respawnTimer = 0.0f;
+    };
+
+    void receive();
+    void handleHello(const sf::IpAddress& address, unsigned short port);
+    void handleInput(Client& client, NetBuffer& packet);
+    void simulate();
+    void spawnHorde();
+    void captureFrame();
+    void sendState(int slot);
+    void openFragment();
+    NetBuffer& room(size_t bytes);
+    int findClient(const sf::IpAddress& address, unsigned short port) const;
+
+    sf::UdpSocket socket;
+    float playerSpeed;
+    int hordeSize;
+    sf::Uint32 tickNumber;
+    int currency;                        // Shared by everyone on the server
+
+    // World
+    Terrain terrain;
+    FlowField flowField;
+    NavGraph navGraph;
+    sf::Vector2f spawnPosition;
+    // The horde is a fixed set of enemy slots built once; dead slots are revived
+    // in place with loadState, so enemies are never copied or reallocated
+    std::vector<Enemy> enemies;
+    std::vector<EnemyState> spawnStates;  // Fresh state for each slot
+    std::vector<sf::Uint16> enemyIds;     // Network id of the enemy in each slot
+    std::vector<sf::Uint8> enemyFlags;    // Archetype and texture bits of each slot
+    std::vector<int> enemyTargets;        // Index into livePlayers of the player each enemy chases
+    std::vector<bool> enemyIdInUse;       // By network id; ids live enemies hold are skipped on wrap
+    sf::Uint16 nextEnemyId;
+    int spawnCursor;
+    ProjectilePool projectiles;          // Large, so keep GameServer itself off the stack
+    std::vector<Client> clients;
+    std::vector<Player*> livePlayers;
+
+    // Networking scratch space
+    NetFrame history[NET_HISTORY];       // Frames by tick, the baselines for deltas
+    NetBuffer incoming;
+    NetBuffer outgoing;
+    std::vector<NetBuffer> fragments;    // Fragments of the frame being sent to one client
+    int fragmentsUsed;
+    sf::Uint32 fragmentBaseline;         // Header fields shared by those fragments
+    sf::Uint32 fragmentLastInput;
+
+    sf::Uint32 rng;
+    ServerStats counters;
+};
+
+#endif // SERVER_H
@@ -0,0 +1,363 @@
+#include "Snapshot.h"
+#include "GameRandom.h"
+#include <SFML/Graphics.hpp>
+#include <cstring>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+sf::Texture& TextureManager(const std::string& texturePath);
+
+// Enemy textures are saved (and sent over the network) as an index into this table
+static const char* ENEMY_TEXTURES[] = {
+    "Textures/Enemy1.png",
+    "Textures/Enemy2.png",
+    "Textures/Enemy3.png",
+    "Textures/Enemy4.png"
+};
+static_assert(sizeof(ENEMY_TEXTURES) / sizeof(ENEMY_TEXTURES[0]) == ENEMY_TEXTURE_COUNT, "Update ENEMY_TEXTURE_COUNT");
+
+sf::Texture& EnemyTexture(int id) {
+    // Resolved once so captures don't build path strings every time
+    static sf::Texture* textures[ENEMY_TEXTURE_COUNT] = {};
+    if (!textures[id])
+        textures[id] = &TextureManager(ENEMY_TEXTURES[id]);
+    return *textures[id];
+}
+
+template <class T>
+static void append(std::vector<char>& out, const T* data, size_t count) {
+    size_t bytes = sizeof(T) * count;
+    if (bytes == 0)
+        return;
+    size_t offset = out.size();
+    out.resize(offset + bytes);
+    std::memcpy(&out[offset], data, bytes);
+}
+
+template <class T>
+static bool take(const char*& cursor, const char* end, T* data, size_t count) {
+    size_t bytes = sizeof(T) * count;
+    if (static_cast<size_t>(end - cursor) < bytes)
+        return false;
+    if (bytes != 0)
+        std::memcpy(data, cursor, bytes);
+    cursor += bytes;
+    return true;
+}
+
+void WorldSnapshot::capture(const Player& player, const std::vector<Enemy>& enemies, const std::vector<Object>& objects,
+    const ProjectilePool& projectiles, const WaveDirector& director, int levelNumber, int currency) {
+    SnapshotHeader head = {};
+    std::memcpy(head.magic, "NSSV", 4);
+    head.version = VERSION;
+    head.playerStateSize = sizeof(PlayerState);
+    head.enemyStateSize = sizeof(EnemyState);
+    head.objectStateSize = sizeof(ObjectState);
+    head.levelNumber = levelNumber;
+    head.currency = currency;
+    head.rngState = GameRandomState();
+    head.itemCount = static_cast<sf::Uint32>(player.getItems().size());
+    head.enemyCount = static_cast<sf::Uint32>(enemies.size());
+    head.objectCount = static_cast<sf::Uint32>(objects.size());
+    head.projectileCount = static_cast<sf::Uint32>(projectiles.count);
+
+    PlayerState playerState = {};
+    player.saveState(playerState);
+    DirectorState directorState = {};
+    director.saveState(directorState);
+
+    // Room for the lists' capacity and a full projectile pool, so a horde growing
+    // into the room the arena reserved doesn't grow these on every new high
+    const size_t projectileBytes = sizeof(projectiles.posX[0]) + sizeof(projectiles.posY[0]) + sizeof(projectiles.velX[0]) +
+        sizeof(projectiles.velY[0]) + sizeof(projectiles.life[0]) + sizeof(projectiles.damage[0]) +
+        sizeof(projectiles.halfSize[0]) + sizeof(projectiles.owner[0]) + sizeof(projectiles.color[0]);
+    enemyStates.reserve(enemies.capacity());
+    objectStates.reserve(objects.capacity());
+    buffer.reserve(FIXED_SIZE + sizeof(ItemStack) * player.getItems().size() + sizeof(EnemyState) * enemies.capacity() +
+        sizeof(ObjectState) * objects.capacity() + projectileBytes * ProjectilePool::CAPACITY);
+
+    enemyStates.resize(enemies.size());
+    for (size_t i = 0; i < enemies.size(); ++i) {
+        EnemyState& state = enemyStates[i];
+        state = EnemyState();
+        enemies[i].saveState(state);
+    }
+
+    objectStates.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i) {
+        objectStates[i] = ObjectState();
+        objects[i].saveState(objectStates[i]);
+    }
+
+    // clear() keeps the capacity, so steady-state captures don't allocate
+    buffer.clear();
+    append(buffer, &head, 1);
+    append(buffer, &playerState, 1);
+    append(buffer, &directorState, 1);
+    append(buffer, player.getItems().data(), player.getItems().size());
+    append(buffer, enemyStates.data(), enemyStates.size());
+    append(buffer, objectStates.data(), objectStates.size());
+
+    // The projectile pool is already structure-of-arrays: copy each live range in one go
+    int count = projectiles.count;
+    append(buffer, projectiles.posX, count);
+    append(buffer, projectiles.posY, count);
+    append(buffer, projectiles.velX, count);
+    append(buffer, projectiles.velY, count);
+    append(buffer, projectiles.life, count);
+    append(buffer, projectiles.damage, count);
+    append(buffer, projectiles.halfSize, count);
+    append(buffer, projectiles.owner, count);
+    append(buffer, projectiles.color, count);
+
+    reinterpret_cast<SnapshotHeader*>(&buffer[0])->totalSize = static_cast<sf::Uint32>(buffer.size());
+}
+
+bool WorldSnapshot::restore(Player& player, std::vector<Enemy>& enemies, std::vector<Object>& objects,
+    ProjectilePool& projectiles, DirectorState& director, int& levelNumber, int& currency) const {
+    const SnapshotHeader* head = header();
+    if (!head)
+        return false;
+
+    const char* cursor = buffer.data() + sizeof(SnapshotHeader);
+    const char* end = buffer.data() + buffer.size();
+
+    PlayerState playerState;
+    if (!take(cursor, end, &playerState, 1) || !take(cursor, end, &director, 1))
+        return false;
+
+    // Items only change on purchase, so while rewinding they nearly always match
+    // and the player's stat modifiers can be left as they are
+    const std::vector<ItemStack>& owned = player.getItems();
+    if (static_cast<size_t>(end - cursor) < sizeof(ItemStack) * head->itemCount)
+        return false;
+    const ItemStack* stacks = reinterpret_cast<const ItemStack*>(cursor);
+    cursor += sizeof(ItemStack) * head->itemCount;
+    bool itemsMatch = owned.size() == head->itemCount &&
+        (owned.empty() || std::memcmp(owned.data(), stacks, sizeof(ItemStack) * owned.size()) == 0);
+    if (!itemsMatch) {
+        player.clearItems();
+        for (sf::Uint32 i = 0; i < head->itemCount; ++i) {
+            for (int unit = 0; unit < stacks[i].count && IsValidItem(stacks[i].id); ++unit)
+                player.addItem(stacks[i].id);
+        }
+    }
+    player.loadState(playerState);
+
+    // Enemies that still match (same texture and archetype) are restored in place;
+    // otherwise the list is rebuilt. Rewinding hits the fast path almost every frame.
+    const char* enemyData = cursor;
+    if (static_cast<size_t>(end - cursor) < sizeof(EnemyState) * head->enemyCount)
+        return false;
+    cursor += sizeof(EnemyState) * head->enemyCount;
+
+    bool reuseEnemies = enemies.size() == head->enemyCount;
+    for (sf::Uint32 i = 0; reuseEnemies && i < head->enemyCount; ++i) {
+        EnemyState state;
+        std::memcpy(&state, enemyData + i * sizeof(EnemyState), sizeof(EnemyState));
+        const EnemyKind& kind = GetEnemyKind(enemies[i].getKind());
+        reuseEnemies = kind.textureId == state.textureId &&
+            kind.archetype == (state.flying ? EnemyArchetype::Flyer : state.charging ? EnemyArchetype::Charger : EnemyArchetype::Walker);
+    }
+    if (!reuseEnemies) {
+        enemies.clear();
+        enemies.reserve(head->enemyCount);
+    }
+    for (sf::Uint32 i = 0; i < head->enemyCount; ++i) {
+        EnemyState state;
+        std::memcpy(&state, enemyData + i * sizeof(EnemyState), sizeof(EnemyState));
+        if (!reuseEnemies) {
+            enemies.push_back(Enemy(state.position, Enemy::kindOf(state)));
+        }
+        enemies[i].loadState(state);
+    }
+
+    bool reuseObjects = objects.size() == head->objectCount;
+    if (!reuseObjects) {
+        objects.clear();
+        objects.reserve(head->objectCount);
+    }
+    for (sf::Uint32 i = 0; i < head->objectCount; ++i) {
+        ObjectState state;
+        if (!take(cursor, end, &state, 1))
+            return false;
+        if (!reuseObjects)
+            objects.push_back(Object(state.position, TextureManager("Textures/Chest.png"), state.chest));
+        objects[i].loadState(state);
+    }
+
+    int count = static_cast<int>(head->projectileCount);
+    if (count > ProjectilePool::CAPACITY)
+        return false;
+    bool ok = take(cursor, end, projectiles.posX, count) &&
+        take(cursor, end, projectiles.posY, count) &&
+        take(cursor, end, projectiles.velX, count) &&
+        take(cursor, end, projectiles.velY, count) &&
+        take(cursor, end, projectiles.life, count) &&
+        take(cursor, end, projectiles.damage, count) &&
+        take(cursor, end, projectiles.halfSize, count) &&
+        take(cursor, end, projectiles.owner, count) &&
+        take(cursor, end, projectiles.color, count);
+    if (!ok) {
+        projectiles.clear();
+        return false;
+    }
+    std::fill(projectiles.dead, projectiles.dead + count, false);
+    projectiles.count = count;
+
+    levelNumber = head->levelNumber;
+    currency = head->currency;
+    SetGameRandomState(head->rngState);
+    return true;
+}
+
+void WorldSnapshot::sections(const char* data, SnapshotSection* out) {
+    SnapshotHeader head;
+    std::memcpy(&head, data, sizeof(head));
+    const size_t projectiles = head.projectileCount;
+
+    // Element size, element count, and whether the elements are entities, in capture order
+    const size_t layout[SECTION_COUNT][3] = {
+        { FIXED_SIZE, 1, 0 },
+        { sizeof(ItemStack), head.itemCount, 1 },
+        { sizeof(EnemyState), head.enemyCount, 1 },
+        { sizeof(ObjectState), head.objectCount, 1 },
+        { sizeof(ProjectilePool::posX[0]), projectiles, 0 },
+        { sizeof(ProjectilePool::posY[0]), projectiles, 0 },
+        { sizeof(ProjectilePool::velX[0]), projectiles, 0 },
+        { sizeof(ProjectilePool::velY[0]), projectiles, 0 },
+        { sizeof(ProjectilePool::life[0]), projectiles, 0 },
+        { sizeof(ProjectilePool::damage[0]), projectiles, 0 },
+        { sizeof(ProjectilePool::halfSize[0]), projectiles, 0 },
+        { sizeof(ProjectilePool::owner[0]), projectiles, 0 },
+        { sizeof(ProjectilePool::color[0]), projectiles, 0 },
+    };
+    sf::Uint32 offset = 0;
+    for (int i = 0; i < SECTION_COUNT; ++i) {
+        out[i].offset = offset;
+        out[i].size = static_cast<sf::Uint32>(layout[i][0] * layout[i][1]);
+        out[i].stride = layout[i][2] ? static_cast<sf::Uint32>(layout[i][0]) : 0;
+        offset += out[i].size;
+    }
+}
+
+const SnapshotHeader* WorldSnapshot::header() const {
+    if (buffer.size() < sizeof(SnapshotHeader))
+        return nullptr;
+
+    const SnapshotHeader* head = reinterpret_cast<const SnapshotHeader*>(buffer.data());
+    if (std::memcmp(head->magic, "NSSV", 4) != 0 || head->version != VERSION ||
+        head->totalSize != buffer.size() ||
+        head->playerStateSize != sizeof(PlayerState) ||
+        head->enemyStateSize != sizeof(EnemyState) ||
+        head->objectStateSize != sizeof(ObjectState)) {
+        std::cerr << "Snapshot is from an incompatible version" << std::endl;
+        return nullptr;
+    }
+    return head;
+}
+
+bool WorldSnapshot::saveToFile(const std::string& path) const {
+    if (buffer.empty())
+        return false;
+
+    // Write to a temporary file first so a crash mid-write never corrupts the last save
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(buffer.data(), buffer.size()))
+            return false;
+    }
+    std::remove(path.c_str());
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+bool WorldSnapshot::loadFromFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+
+    std::streamsize size = file.tellg();
+    file.seekg(0);
+    buffer.resize(static_cast<size_t>(size));
+    if (size <= 0 || !file.read(buffer.data(), size) || !header()) {
+        buffer.clear();
+        return false;
+    }
+    return true;
+}
+
+void WorldSnapshot::assign(const char* data, size_t size) {
+    buffer.assign(data, data + size);
+}
+
+bool WorldSnapshot::empty() const {
+    return buffer.empty();
+}
+
+const std::vector<char>& WorldSnapshot::data() const {
+    return buffer;
+}
+
+AutosaveWriter::AutosaveWriter(const std::string& path)
+    : path(path), hasPending(false), running(false) {}
+
+AutosaveWriter::~AutosaveWriter() {
+    stop();
+}
+
+void AutosaveWriter::start() {
+    if (running)
+        return;
+    running = true;
+    worker = std::thread(&AutosaveWriter::run, this);
+}
+
+void AutosaveWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_one();
+    if (worker.joinable())
+        worker.join();
+}
+
+void AutosaveWriter::request(const WorldSnapshot& snapshot) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.assign(snapshot.data().begin(), snapshot.data().end()); // Replaces any unwritten save
+        hasPending = true;
+    }
+    wake.notify_one();
+}
+
+void AutosaveWriter::run() {
+    std::vector<char> writing;
+    std::string temporary = path + ".tmp";
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return hasPending || !running; });
+            if (!hasPending && !running)
+                return;
+            writing.swap(pending);
+            hasPending = false;
+        }
+
+        // Same temp-then-rename dance as WorldSnapshot::saveToFile
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(writing.data(), writing.size());
+            if (!file) {
+                std::cerr << "Autosave failed" << std::endl;
+                continue;
+            }
+        }
+        std::remove(path.c_str());
+        std::rename(temporary.c_str(), path.c_str());
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "PlayerCharacter.h"
+#include "Enemy.h"
+#include "Object.h"
+#include "Projectile.h"
+#include "WaveDirector.h"
+
+// Shared enemy textures, addressed by a small id in snapshots and packets
+const int ENEMY_TEXTURE_COUNT = 4;
+sf::Texture& EnemyTexture(int id);
+
+// Fixed-size block at the start of every snapshot
+struct SnapshotHeader {
+    char magic[4];
+    sf::Uint32 version;
+    sf::Uint32 totalSize;
+    sf::Uint32 playerStateSize;   // Struct sizes guard against layout changes between builds
+    sf::Uint32 enemyStateSize;
+    sf::Uint32 objectStateSize;
+    sf::Int32 levelNumber;
+    sf::Int32 currency;
+    sf::Uint64 rngState;          // GameRandom, whole
+    sf::Uint32 itemCount;
+    sf::Uint32 enemyCount;
+    sf::Uint32 objectCount;
+    sf::Uint32 projectileCount;
+};
+
+// One block of a snapshot image. Entity blocks hold one state struct per
+// entity, so a delta can line entities up across ticks where some have died.
+struct SnapshotSection {
+    sf::Uint32 offset;
+    sf::Uint32 size;
+    sf::Uint32 stride;   // Bytes per entity, 0 for plain data
+};
+
+// Versioned binary image of the whole world. Entities are copied into plain
+// state structs that are written back to back into one reused buffer, so
+// capturing and restoring are a handful of memcpys with no per-field allocation.
+class WorldSnapshot {
+public:
+    static const sf::Uint32 VERSION = 5;  // 2: items saved as id/count stacks, 3: full RNG state, 4: timed buffs, 5: wave director
+    static const int SECTION_COUNT = 13;  // Header, player and director, items, enemies, objects, then each projectile array
+    static const sf::Uint32 FIXED_SIZE = sizeof(SnapshotHeader) + sizeof(PlayerState) + sizeof(DirectorState);  // The first section
+
+    // Where each section of an image lies; only the header has to be present
+    static void sections(const char* data, SnapshotSection* out);
+
+    // Member functions
+    void capture(const Player& player, const std::vector<Enemy>& enemies, const std::vector<Object>& objects,
+        const ProjectilePool& projectiles, const WaveDirector& director, int levelNumber, int currency);
+    bool restore(Player& player, std::vector<Enemy>& enemies, std::vector<Object>& objects,
+        ProjectilePool& projectiles, DirectorState& director, int& levelNumber, int& currency) const;  // The level's director loads director
+    bool saveToFile(const std::string& path) const;
+    bool loadFromFile(const std::string& path);
+    void assign(const char* data, size_t size);
+
+    bool empty() const;
+    const std::vector<char>& data() const;
+
+private:
+    const SnapshotHeader* header() const;
+
+    std::vector<char> buffer;
+    std::vector<EnemyState> enemyStates;   // Scratch space reused between captures
+    std::vector<ObjectState> objectStates;
+};
+
+// Writes snapshots to disk on a background thread. Only the newest pending
+// snapshot is kept, so a slow disk never queues up work or stalls a frame.
+class AutosaveWriter {
+public:
+    explicit AutosaveWriter(const std::string& path);
+    ~AutosaveWriter();
+
+    void start();
+    void stop();
+    void request(const WorldSnapshot& snapshot);
+
+private:
+    void run();
+
+    std::string path;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<char> pending;
+    bool hasPending;
+    bool running;
+};
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,56 @@
+#include "StaticLayer.h"
+#include <cmath>
+#include <algorithm>
+
+StaticLayer::StaticLayer() : tileCount(0), revision(0) {}
+
+void StaticLayer::rebuild(const std::vector<sf::Vertex>& vertices, const sf::FloatRect& area, sf::Uint32 newRevision) {
+    revision = newRevision;
+    int columns = static_cast<int>(std::ceil(area.width / SCREEN_WIDTH));
+    int rows = static_cast<int>(std::ceil(area.height / SCREEN_HEIGHT));
+    tileCount = static_cast<size_t>(std::max(0, columns * rows));
+    if (tiles.size() < tileCount)
+        tiles.resize(tileCount);
+
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            Tile& tile = tiles[row * columns + column];
+            if (!tile.texture) {
+                tile.texture.reset(new sf::RenderTexture());
+                tile.texture->create(static_cast<unsigned int>(SCREEN_WIDTH), static_cast<unsigned int>(SCREEN_HEIGHT));
+            }
+
+            // The last row and column only cover what is left of the area
+            float left = area.left + column * SCREEN_WIDTH;
+            float top = area.top + row * SCREEN_HEIGHT;
+            tile.bounds = sf::FloatRect(left, top,
+                std::min(SCREEN_WIDTH, area.left + area.width - left),
+                std::min(SCREEN_HEIGHT, area.top + area.height - top));
+
+            sf::RenderTexture& texture = *tile.texture;
+            texture.setView(sf::View(sf::FloatRect(left, top, SCREEN_WIDTH, SCREEN_HEIGHT)));
+            texture.clear(sf::Color::Transparent);
+            if (!vertices.empty())
+                texture.draw(vertices.data(), vertices.size(), sf::Quads);
+            texture.display();
+
+            tile.sprite.setTexture(texture.getTexture());
+            tile.sprite.setTextureRect(sf::IntRect(0, 0,
+                static_cast<int>(std::ceil(tile.bounds.width)), static_cast<int>(std::ceil(tile.bounds.height))));
+            tile.sprite.setPosition(left, top);
+        }
+    }
+}
+
+void StaticLayer::draw(sf::RenderTarget& target) const {
+    const sf::View& view = target.getView();
+    sf::FloatRect visible(view.getCenter() - view.getSize() / 2.0f, view.getSize());
+    for (size_t i = 0; i < tileCount; ++i) {
+        if (tiles[i].bounds.intersects(visible))
+            target.draw(tiles[i].sprite);
+    }
+}
+
+sf::Uint32 StaticLayer::getRevision() const {
+    return revision;
+}
@@ -0,0 +1,36 @@
+#ifndef STATICLAYER_H
+#define STATICLAYER_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <memory>
+#include "World.h"
+
+// Level geometry that never changes after load, rendered once into
+// off-screen textures and then drawn as one textured quad per tile. Tiles
+// are SCREEN_WIDTH by SCREEN_HEIGHT, so a room is a single tile and each
+// streamed chunk one more; only the tiles in view are drawn. Textures are created on first
+// use and reused by later rebuilds.
+class StaticLayer {
+public:
+    StaticLayer();
+
+    // Member functions
+    void rebuild(const std::vector<sf::Vertex>& vertices, const sf::FloatRect& area, sf::Uint32 revision);
+    void draw(sf::RenderTarget& target) const;  // Under the target's current view
+
+    sf::Uint32 getRevision() const;
+
+private:
+    struct Tile {
+        std::unique_ptr<sf::RenderTexture> texture;
+        sf::Sprite sprite;
+        sf::FloatRect bounds;
+    };
+
+    std::vector<Tile> tiles;
+    size_t tileCount;        // Tiles in use; any beyond are spare textures
+    sf::Uint32 revision;
+};
+
+#endif // STATICLAYER_H
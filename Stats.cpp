@@ -0,0 +1,145 @@
+#include "Stats.h"
+#include <algorithm>
+
+// Handles pack the slot in the low 16 bits and its generation above
+const int SLOT_BITS = 16;
+const int SLOT_MASK = (1 << SLOT_BITS) - 1;
+const int GENERATION_MASK = 0x7FFF;
+
+StatStack::StatStack() : clock(0.0f) {
+    for (int stat = 0; stat < STAT_COUNT; ++stat) {
+        base[stat] = stat == static_cast<int>(Stat::DamageMultiplier) ? 1.0f : 0.0f;
+        sum[stat] = 0.0f;
+        product[stat] = 1.0f;
+        zeroFactors[stat] = 0;
+        modifierCount[stat] = 0;
+        refresh(stat);
+    }
+}
+
+void StatStack::setBase(Stat stat, float value) {
+    base[static_cast<int>(stat)] = value;
+    refresh(static_cast<int>(stat));
+}
+
+StatStack::Handle StatStack::add(const StatModifier& modifier) {
+    int index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else {
+        if (static_cast<int>(slots.size()) > SLOT_MASK)
+            return INVALID_HANDLE;
+        index = static_cast<int>(slots.size());
+        slots.push_back(Slot());
+        slots.back().generation = 0;
+    }
+
+    Slot& slot = slots[index];
+    slot.modifier = modifier;
+    slot.active = true;
+
+    int stat = static_cast<int>(modifier.stat);
+    sum[stat] += modifier.add;
+    if (modifier.multiply == 0.0f)
+        ++zeroFactors[stat];
+    else
+        product[stat] *= modifier.multiply;
+    ++modifierCount[stat];
+    refresh(stat);
+
+    return (slot.generation << SLOT_BITS) | index;
+}
+
+StatStack::Handle StatStack::addTimed(const StatModifier& modifier, float duration) {
+    Handle handle = add(modifier);
+    if (handle == INVALID_HANDLE)
+        return handle;
+
+    Expiry expiry = { clock + duration, handle };
+    expiries.push_back(expiry);
+    std::push_heap(expiries.begin(), expiries.end(), [](const Expiry& a, const Expiry& b) {
+        return a.time > b.time;
+        });
+    return handle;
+}
+
+void StatStack::remove(Handle handle) {
+    int index = slotOf(handle);
+    if (index < 0)
+        return;
+
+    Slot& slot = slots[index];
+    int stat = static_cast<int>(slot.modifier.stat);
+    if (--modifierCount[stat] == 0) {
+        // Reset exactly so repeated add/remove can't leave rounding drift behind
+        sum[stat] = 0.0f;
+        product[stat] = 1.0f;
+        zeroFactors[stat] = 0;
+    }
+    else {
+        sum[stat] -= slot.modifier.add;
+        if (slot.modifier.multiply == 0.0f)
+            --zeroFactors[stat];
+        else
+            product[stat] /= slot.modifier.multiply;
+    }
+    refresh(stat);
+
+    slot.active = false;
+    slot.generation = (slot.generation + 1) & GENERATION_MASK;
+    freeSlots.push_back(index);
+}
+
+bool StatStack::update(float deltaTime) {
+    clock += deltaTime;
+
+    bool expired = false;
+    while (!expiries.empty() && expiries.front().time <= clock) {
+        Handle handle = expiries.front().handle;
+        std::pop_heap(expiries.begin(), expiries.end(), [](const Expiry& a, const Expiry& b) {
+            return a.time > b.time;
+            });
+        expiries.pop_back();
+
+        // Buffs removed early leave a stale entry behind; its handle no longer resolves
+        if (slotOf(handle) >= 0) {
+            remove(handle);
+            expired = true;
+        }
+    }
+    return expired;
+}
+
+void StatStack::clear() {
+    for (int stat = 0; stat < STAT_COUNT; ++stat) {
+        sum[stat] = 0.0f;
+        product[stat] = 1.0f;
+        zeroFactors[stat] = 0;
+        modifierCount[stat] = 0;
+        refresh(stat);
+    }
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (slots[i].active) {
+            slots[i].active = false;
+            slots[i].generation = (slots[i].generation + 1) & GENERATION_MASK;
+            freeSlots.push_back(static_cast<int>(i));
+        }
+    }
+    expiries.clear();
+}
+
+void StatStack::refresh(int stat) {
+    values[stat] = zeroFactors[stat] ? 0.0f : (base[stat] + sum[stat]) * product[stat];
+}
+
+int StatStack::slotOf(Handle handle) const {
+    if (handle < 0)
+        return -1;
+    int index = handle & SLOT_MASK;
+    if (index >= static_cast<int>(slots.size()) || !slots[index].active ||
+        slots[index].generation != (handle >> SLOT_BITS))
+        return -1;
+    return index;
+}
@@ -0,0 +1,74 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <vector>
+
+// Player stats that items and buffs can modify
+enum class Stat {
+    Damage,            // Flat damage per hit
+    DamageMultiplier,
+    Projectiles,       // Extra shuriken per volley
+    Count
+};
+
+// One entry on a StatStack. The stat's value is (base + sum of adds) * product of multiplies.
+struct StatModifier {
+    Stat stat;
+    float add;
+    float multiply;
+};
+
+// Aggregated stats under a stack of modifiers. Each stat keeps a running sum of
+// its adds and a running product of its multipliers, so adding or removing a
+// modifier is O(1) and reading a stat is a plain load. Timed modifiers sit in a
+// min-heap by expiry time, so update() only touches the ones that ran out.
+class StatStack {
+public:
+    typedef int Handle;
+    static const Handle INVALID_HANDLE = -1;
+
+    StatStack();
+
+    // Member functions
+    void setBase(Stat stat, float value);
+    Handle add(const StatModifier& modifier);
+    Handle addTimed(const StatModifier& modifier, float duration);
+    void remove(Handle handle);
+    bool update(float deltaTime);  // Expires timed modifiers, true if any ran out
+    float time() const { return clock; }  // Seconds of updates so far, the clock timed modifiers run on
+    void clear();                  // Drops every modifier, keeps the bases
+
+    float get(Stat stat) const { return values[static_cast<int>(stat)]; }
+
+private:
+    static const int STAT_COUNT = static_cast<int>(Stat::Count);
+
+    struct Slot {
+        StatModifier modifier;
+        int generation;   // Bumped on reuse, so stale handles are ignored
+        bool active;
+    };
+
+    struct Expiry {
+        float time;
+        Handle handle;
+    };
+
+    void refresh(int stat);
+    int slotOf(Handle handle) const;
+
+    // Per stat aggregates
+    float base[STAT_COUNT];
+    float sum[STAT_COUNT];
+    float product[STAT_COUNT];    // Product of the non-zero multipliers
+    int zeroFactors[STAT_COUNT];  // Multipliers of exactly zero, kept out of the product so removal can divide
+    int modifierCount[STAT_COUNT];
+    float values[STAT_COUNT];     // Cached (base + sum) * product
+
+    std::vector<Slot> slots;
+    std::vector<int> freeSlots;
+    std::vector<Expiry> expiries; // Heap, soonest first
+    float clock;
+};
+
+#endif // STATS_H
@@ -0,0 +1,154 @@
+#include "Telemetry.h"
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+static const char* const TIMING_NAMES[] = {
+    "frame", "input", "player", "enemies", "collision", "draw", "render", "present"
+};
+static const char* const COUNTER_NAMES[] = {
+    "enemies", "projectiles", "particles", "drawCalls", "culled", "textureSwitches", "allocations", "allocatedBytes"
+};
+static_assert(sizeof(TIMING_NAMES) / sizeof(TIMING_NAMES[0]) == static_cast<int>(Timing::Count), "Name every timing");
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == static_cast<int>(Counter::Count), "Name every counter");
+
+Histogram::Histogram() {
+    clear();
+}
+
+void Histogram::record(sf::Uint32 value) {
+    // Single writer, so plain load-then-store is enough
+    std::atomic<sf::Uint32>& bucket = counts[bucketOf(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    total.store(total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum.store(sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    if (value > largest.load(std::memory_order_relaxed))
+        largest.store(value, std::memory_order_relaxed);
+}
+
+void Histogram::clear() {
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+        counts[i].store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    largest.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+}
+
+sf::Uint32 Histogram::count() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+sf::Uint32 Histogram::percentile(float fraction) const {
+    sf::Uint32 samples = count();
+    if (samples == 0)
+        return 0;
+
+    // Rank of the sample wanted, counted from 1
+    sf::Uint64 rank = std::max<sf::Uint64>(1, static_cast<sf::Uint64>(fraction * samples + 0.5f));
+    sf::Uint64 seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += counts[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return std::min(upperEdge(i), max());
+    }
+    return max();
+}
+
+sf::Uint32 Histogram::max() const {
+    return largest.load(std::memory_order_relaxed);
+}
+
+double Histogram::mean() const {
+    sf::Uint32 samples = count();
+    return samples ? static_cast<double>(sum.load(std::memory_order_relaxed)) / samples : 0.0;
+}
+
+int Histogram::bucketOf(sf::Uint32 value) {
+    if (value < SUB_BUCKETS)
+        return static_cast<int>(value);
+
+    // Shift the value down until it lands in [SUB_BUCKETS / 2, SUB_BUCKETS)
+    int magnitude = 0;
+    while ((value >> magnitude) >= SUB_BUCKETS)
+        ++magnitude;
+    int bucket = SUB_BUCKETS + (magnitude - 1) * (SUB_BUCKETS / 2) + static_cast<int>(value >> magnitude) - SUB_BUCKETS / 2;
+    return std::min(bucket, BUCKET_COUNT - 1);
+}
+
+sf::Uint32 Histogram::upperEdge(int bucket) {
+    if (bucket < SUB_BUCKETS)
+        return static_cast<sf::Uint32>(bucket);
+    int magnitude = (bucket - SUB_BUCKETS) / (SUB_BUCKETS / 2) + 1;
+    sf::Uint32 step = (bucket - SUB_BUCKETS) % (SUB_BUCKETS / 2) + SUB_BUCKETS / 2;
+    return ((step + 1) << magnitude) - 1;
+}
+
+Telemetry::Scope::Scope(Timing timing) : timing(timing) {}
+
+Telemetry::Scope::~Scope() {
+    GameTelemetry().record(timing, clock.getElapsedTime());
+    if (AllocationTracker::isEnabled())
+        GameTelemetry().recordAllocations(timing, allocations.allocated());
+}
+
+void Telemetry::record(Timing timing, sf::Time time) {
+    sf::Int64 micros = std::max<sf::Int64>(0, time.asMicroseconds());
+    timings[static_cast<int>(timing)].record(static_cast<sf::Uint32>(std::min<sf::Int64>(micros, 0x7FFFFFFF)));
+}
+
+void Telemetry::recordAllocations(Timing timing, const AllocationCount& allocated) {
+    allocations[static_cast<int>(timing)].record(static_cast<sf::Uint32>(std::min<sf::Uint64>(allocated.count, 0x7FFFFFFF)));
+}
+
+void Telemetry::sample(Counter counter, int value) {
+    counters[static_cast<int>(counter)].record(static_cast<sf::Uint32>(std::max(0, value)));
+}
+
+void Telemetry::clear() {
+    for (Histogram& histogram : timings)
+        histogram.clear();
+    for (Histogram& histogram : allocations)
+        histogram.clear();
+    for (Histogram& histogram : counters)
+        histogram.clear();
+}
+
+static void WriteHistogram(std::ostream& out, const char* name, const Histogram& histogram, bool last) {
+    out << "    \"" << name << "\": { \"count\": " << histogram.count()
+        << ", \"mean\": " << std::fixed << std::setprecision(1) << histogram.mean()
+        << ", \"p50\": " << histogram.percentile(0.50f)
+        << ", \"p95\": " << histogram.percentile(0.95f)
+        << ", \"p99\": " << histogram.percentile(0.99f)
+        << ", \"max\": " << histogram.max() << " }" << (last ? "\n" : ",\n");
+}
+
+void Telemetry::writeJson(std::ostream& out) const {
+    const int timingCount = static_cast<int>(Timing::Count);
+    const int counterCount = static_cast<int>(Counter::Count);
+
+    out << "{\n  \"timingsMicroseconds\": {\n";
+    for (int i = 0; i < timingCount; ++i)
+        WriteHistogram(out, TIMING_NAMES[i], timings[i], i == timingCount - 1);
+    out << "  },\n  \"counters\": {\n";
+    for (int i = 0; i < counterCount; ++i)
+        WriteHistogram(out, COUNTER_NAMES[i], counters[i], i == counterCount - 1);
+    out << "  },\n  \"allocationsPerScope\": {\n";
+    for (int i = 0; i < timingCount; ++i)
+        WriteHistogram(out, TIMING_NAMES[i], allocations[i], i == timingCount - 1);
+    out << "  }\n}\n";
+}
+
+bool Telemetry::writeJson(const std::string& path) const {
+    std::ofstream file(path, std::ios::trunc);
+    writeJson(file);
+    return static_cast<bool>(file);
+}
+
+const Histogram& Telemetry::allocationsIn(Timing timing) const {
+    return allocations[static_cast<int>(timing)];
+}
+
+Telemetry& GameTelemetry() {
+    static Telemetry telemetry;
+    return telemetry;
+}
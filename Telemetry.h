@@ -0,0 +1,107 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <string>
+#include <ostream>
+#include "AllocationTracker.h"
+
+// Timed parts of a frame
+enum class Timing {
+    Frame,      // Whole simulation tick, sleep included
+    Input,
+    Player,
+    Enemies,
+    Collision,  // Projectile integration and hits
+    Draw,       // Recording the world into a render frame
+    Render,     // Render thread: static layer, queue flush and HUD
+    Present,    // Render thread: display(), vsync wait included
+    Count
+};
+
+// Per-frame samples
+enum class Counter {
+    Enemies,
+    Projectiles,
+    Particles,
+    DrawCalls,
+    Culled,
+    TextureSwitches,
+    Allocations,      // Simulation tick, only while allocation tracking is on
+    AllocatedBytes,
+    Count
+};
+
+// Fixed-size log-linear histogram, HDR style. Values below SUB_BUCKETS are
+// counted exactly; above that each power of two is split into SUB_BUCKETS / 2
+// buckets, so any value is reported within about 3% using a few KB whatever
+// the range. Each histogram has one writer; counts are relaxed atomics so
+// another thread can read them while it records.
+class Histogram {
+public:
+    static const int SUB_BUCKETS = 64;
+    static const int MAGNITUDES = 26;   // Values up to 2^31
+    static const int BUCKET_COUNT = SUB_BUCKETS + MAGNITUDES * SUB_BUCKETS / 2;
+
+    Histogram();
+
+    // Member functions
+    void record(sf::Uint32 value);
+    void clear();
+
+    sf::Uint32 count() const;
+    sf::Uint32 percentile(float fraction) const;  // Upper edge of the bucket holding it
+    sf::Uint32 max() const;
+    double mean() const;
+
+private:
+    static int bucketOf(sf::Uint32 value);
+    static sf::Uint32 upperEdge(int bucket);
+
+    std::atomic<sf::Uint32> counts[BUCKET_COUNT];
+    std::atomic<sf::Uint32> total;
+    std::atomic<sf::Uint32> largest;
+    std::atomic<sf::Uint64> sum;
+};
+
+// Frame timings and counters for the running game. Timings are kept in
+// microseconds. Recording is a clock read and a couple of relaxed stores,
+// cheap enough to leave on in release builds. While allocation tracking is
+// on, each timed scope also records how many allocations it made.
+class Telemetry {
+public:
+    // Times its enclosing block
+    class Scope {
+    public:
+        explicit Scope(Timing timing);
+        ~Scope();
+
+    private:
+        Timing timing;
+        sf::Clock clock;
+        AllocationTracker::Scope allocations;
+    };
+
+    // Member functions
+    void record(Timing timing, sf::Time time);
+    void recordAllocations(Timing timing, const AllocationCount& allocated);
+    void sample(Counter counter, int value);
+    void clear();
+
+    void writeJson(std::ostream& out) const;
+    bool writeJson(const std::string& path) const;
+
+    const Histogram& allocationsIn(Timing timing) const;
+
+private:
+    Histogram timings[static_cast<int>(Timing::Count)];
+    Histogram allocations[static_cast<int>(Timing::Count)];
+    Histogram counters[static_cast<int>(Counter::Count)];
+};
+
+// Telemetry for the game window; the simulation and render threads each
+// record their own timings into it
+Telemetry& GameTelemetry();
+
+#endif // TELEMETRY_H
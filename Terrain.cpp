@@ -0,0 +1,144 @@
+#include "Terrain.h"
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+
+// Shared by every terrain, so two levels never hand the renderer the same revision
+static std::atomic<sf::Uint32> lastRevision(0);
+
+Terrain::Terrain() : origin(0, 0), columns(0), rows(0), rowWords(0), revision(0) {}
+
+void Terrain::build(const std::vector<Ground>& grounds, const sf::FloatRect& tiledArea) {
+    area = tiledArea;
+    revision = ++lastRevision;
+    origin = sf::Vector2f(area.left, area.top);
+    columns = static_cast<int>(std::ceil(area.width / TILE_SIZE));
+    rows = static_cast<int>(std::ceil(area.height / TILE_SIZE));
+    rowWords = (columns + 63) / 64;
+    bits.assign(rowWords * rows, 0);
+    solids.clear();
+    solidFirstColumn.clear();
+    vertices.clear();
+
+    for (const Ground& ground : grounds) {
+        sf::FloatRect bounds = ground.getBounds();
+        solids.push_back(bounds);
+
+        // Every tile the rectangle touches, clipped to the area
+        float left = (bounds.left - origin.x) / TILE_SIZE;
+        float top = (bounds.top - origin.y) / TILE_SIZE;
+        float right = (bounds.left + bounds.width - origin.x) / TILE_SIZE;
+        float bottom = (bounds.top + bounds.height - origin.y) / TILE_SIZE;
+        fill(std::max(0, static_cast<int>(std::floor(left))),
+            std::max(0, static_cast<int>(std::floor(top))),
+            std::min(columns - 1, static_cast<int>(std::ceil(right)) - 1),
+            std::min(rows - 1, static_cast<int>(std::ceil(bottom)) - 1));
+
+        sf::Vector2f corner(bounds.left, bounds.top);
+        vertices.push_back(sf::Vertex(corner, GROUND_COLOR));
+        vertices.push_back(sf::Vertex(corner + sf::Vector2f(bounds.width, 0), GROUND_COLOR));
+        vertices.push_back(sf::Vertex(corner + sf::Vector2f(bounds.width, bounds.height), GROUND_COLOR));
+        vertices.push_back(sf::Vertex(corner + sf::Vector2f(0, bounds.height), GROUND_COLOR));
+    }
+
+    // Column index: count the grounds each column holds, then scatter their indices
+    columnStart.assign(columns + 1, 0);
+    for (const sf::FloatRect& bounds : solids) {
+        solidFirstColumn.push_back(columnOf(bounds.left));
+        for (int column = solidFirstColumn.back(); column <= columnOf(bounds.left + bounds.width); ++column)
+            columnStart[column + 1]++;
+    }
+    for (int column = 0; column < columns; ++column)
+        columnStart[column + 1] += columnStart[column];
+    columnSolids.resize(columnStart[columns]);
+    std::vector<int> cursor(columnStart.begin(), columnStart.end() - 1);
+    for (size_t i = 0; i < solids.size(); ++i) {
+        for (int column = solidFirstColumn[i]; column <= columnOf(solids[i].left + solids[i].width); ++column)
+            columnSolids[cursor[column]++] = static_cast<int>(i);
+    }
+}
+
+bool Terrain::isSolid(const sf::Vector2f& point) const {
+    float x = (point.x - origin.x) / TILE_SIZE;
+    float y = (point.y - origin.y) / TILE_SIZE;
+    if (x < 0 || y < 0 || x >= columns || y >= rows)
+        return false;
+    int column = static_cast<int>(x);
+    int row = static_cast<int>(y);
+    return (bits[row * rowWords + (column >> 6)] >> (column & 63)) & 1;
+}
+
+bool Terrain::overlaps(const sf::FloatRect& box) const {
+    int left = std::max(0, static_cast<int>(std::floor((box.left - origin.x) / TILE_SIZE)));
+    int top = std::max(0, static_cast<int>(std::floor((box.top - origin.y) / TILE_SIZE)));
+    int right = std::min(columns - 1, static_cast<int>(std::floor((box.left + box.width - origin.x) / TILE_SIZE)));
+    int bottom = std::min(rows - 1, static_cast<int>(std::floor((box.top + box.height - origin.y) / TILE_SIZE)));
+    if (left > right || top > bottom)
+        return false;
+
+    // Test whole words, masked to the columns the box covers
+    int firstWord = left >> 6;
+    int lastWord = right >> 6;
+    for (int row = top; row <= bottom; ++row) {
+        const sf::Uint64* line = &bits[row * rowWords];
+        for (int word = firstWord; word <= lastWord; ++word) {
+            sf::Uint64 mask = ~0ull;
+            if (word == firstWord)
+                mask &= ~0ull << (left & 63);
+            if (word == lastWord && (right & 63) != 63)
+                mask &= (1ull << ((right & 63) + 1)) - 1;
+            if (line[word] & mask)
+                return true;
+        }
+    }
+    return false;
+}
+
+const std::vector<sf::FloatRect>& Terrain::rectsNear(const sf::FloatRect& box) const {
+    // Per thread, since balance runs and the server step bodies on several
+    thread_local std::vector<sf::FloatRect> near;
+    near.clear();
+    near.reserve(solids.size()); // The most it can hold, so the first crowded box doesn't grow it mid-room
+    if (columns == 0 || !overlaps(box))
+        return near;
+
+    int first = columnOf(box.left);
+    int last = columnOf(box.left + box.width);
+    for (int column = first; column <= last; ++column) {
+        for (int k = columnStart[column]; k < columnStart[column + 1]; ++k) {
+            int i = columnSolids[k];
+            // A ground spanning columns is only taken in the first one the box shares with it
+            if (column > first && solidFirstColumn[i] < column)
+                continue;
+            const sf::FloatRect& ground = solids[i];
+            if (ground.top <= box.top + box.height && ground.top + ground.height >= box.top)
+                near.push_back(ground);
+        }
+    }
+    return near;
+}
+
+const std::vector<sf::Vertex>& Terrain::getVertices() const {
+    return vertices;
+}
+
+const sf::FloatRect& Terrain::getArea() const {
+    return area;
+}
+
+sf::Uint32 Terrain::getRevision() const {
+    return revision;
+}
+
+int Terrain::columnOf(float x) const {
+    int column = static_cast<int>(std::floor((x - origin.x) / TILE_SIZE));
+    return std::max(0, std::min(columns - 1, column));
+}
+
+void Terrain::fill(int left, int top, int right, int bottom) {
+    for (int row = top; row <= bottom; ++row) {
+        sf::Uint64* line = &bits[row * rowWords];
+        for (int column = left; column <= right; ++column)
+            line[column >> 6] |= 1ull << (column & 63);
+    }
+}
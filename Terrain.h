@@ -0,0 +1,51 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "Ground.h"
+
+// Tile view of a level's grounds. Occupancy is a packed bitmap, one bit per
+// tile and 64 tiles per word, so a point probe is a single bit lookup and a
+// small box touches a handful of words however many grounds there are.
+// Grounds are rasterised conservatively: a tile is solid if any ground
+// covers part of it, so probes can report ground up to one tile early. The
+// ground rectangles are kept for exact body collision, indexed by the tile
+// columns they span, and their quads are prebuilt for the renderer, which
+// caches them until the revision changes.
+class Terrain {
+public:
+    static const int TILE_SIZE = 8;
+
+    Terrain();
+
+    // Member functions
+    void build(const std::vector<Ground>& grounds, const sf::FloatRect& area);
+    bool isSolid(const sf::Vector2f& point) const;
+    bool overlaps(const sf::FloatRect& box) const;
+    // Grounds in the box's columns that reach its height, none unless it overlaps a
+    // solid tile. Valid until the next call on the same thread.
+    const std::vector<sf::FloatRect>& rectsNear(const sf::FloatRect& box) const;
+    const std::vector<sf::Vertex>& getVertices() const;
+    const sf::FloatRect& getArea() const;
+    sf::Uint32 getRevision() const;  // Unique per build, 0 before the first
+
+private:
+    void fill(int left, int top, int right, int bottom);  // Inclusive tile range
+    int columnOf(float x) const;                          // Clamped to the grid
+
+    sf::FloatRect area;
+    sf::Vector2f origin;   // World position of tile 0,0
+    int columns;
+    int rows;
+    int rowWords;          // 64-bit words per row
+    std::vector<sf::Uint64> bits;
+    std::vector<sf::FloatRect> solids;
+    std::vector<int> solidFirstColumn;
+    std::vector<int> columnStart;    // Per column offset into columnSolids
+    std::vector<int> columnSolids;   // Indices into solids, by column
+    std::vector<sf::Vertex> vertices;
+    sf::Uint32 revision;
+};
+
+#endif // TERRAIN_H
@@ -0,0 +1,218 @@
+#include "Tuning.h"
+#include "Item.cpp"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+static Tuning& CurrentTuning() {
+    static Tuning tuning;
+    return tuning;
+}
+
+const Tuning& GameTuning() {
+    return CurrentTuning();
+}
+
+// One named value in a tuning struct; exactly one of the members is set
+template <typename T>
+struct TuningField {
+    const char* name;
+    float T::*real;
+    int T::*whole;
+};
+
+static const TuningField<PlayerTuning> PLAYER_FIELDS[] = {
+    { "movementSpeed", &PlayerTuning::movementSpeed, nullptr },
+    { "gravity", &PlayerTuning::gravity, nullptr },
+    { "dashDistance", &PlayerTuning::dashDistance, nullptr },
+    { "dashTime", &PlayerTuning::dashTime, nullptr },
+    { "dashCooldown", &PlayerTuning::dashCooldown, nullptr },
+    { "throwCooldown", &PlayerTuning::throwCooldown, nullptr },
+    { "shurikenSpeed", &PlayerTuning::shurikenSpeed, nullptr },
+    { "shurikenSpread", &PlayerTuning::shurikenSpread, nullptr },
+    { "knockbackDuration", &PlayerTuning::knockbackDuration, nullptr },
+    { "knockbackDistance", &PlayerTuning::knockbackDistance, nullptr },
+    { "knockbackArcHeight", &PlayerTuning::knockbackArcHeight, nullptr }
+};
+
+static const TuningField<EnemyTuning> ENEMY_FIELDS[] = {
+    { "chargeSpeedMultiplier", &EnemyTuning::chargeSpeedMultiplier, nullptr },
+    { "chargeDuration", &EnemyTuning::chargeDuration, nullptr },
+    { "chargeCooldown", &EnemyTuning::chargeCooldown, nullptr },
+    { "chargeTelegraphDuration", &EnemyTuning::chargeTelegraphDuration, nullptr },
+    { "hitRotationSpeed", &EnemyTuning::hitRotationSpeed, nullptr },
+    { "hitBounceHeight", &EnemyTuning::hitBounceHeight, nullptr },
+    { "shootInterval", &EnemyTuning::shootInterval, nullptr },
+    { "projectileSpeed", &EnemyTuning::projectileSpeed, nullptr },
+    { "projectileLifetime", &EnemyTuning::projectileLifetime, nullptr }
+};
+
+static const TuningField<LevelTuning> LEVEL_FIELDS[] = {
+    { "firstWaveSize", nullptr, &LevelTuning::firstWaveSize },
+    { "waveSizeGrowth", nullptr, &LevelTuning::waveSizeGrowth },
+    { "healthGrowth", &LevelTuning::healthGrowth, nullptr },
+    { "speedGrowth", &LevelTuning::speedGrowth, nullptr },
+    { "maxSpeedScale", &LevelTuning::maxSpeedScale, nullptr },
+    { "firstSpawnInterval", &LevelTuning::firstSpawnInterval, nullptr },
+    { "spawnIntervalDecay", &LevelTuning::spawnIntervalDecay, nullptr },
+    { "minSpawnInterval", &LevelTuning::minSpawnInterval, nullptr },
+    { "waveBreak", &LevelTuning::waveBreak, nullptr },
+    { "overBudget", &LevelTuning::overBudget, nullptr },
+    { "underBudget", &LevelTuning::underBudget, nullptr }
+};
+
+static std::string Trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos)
+        return "";
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+// The whole value must be a number; "12abc" is a typo, not 12
+template <typename Number>
+static bool ParseNumber(const std::string& text, Number& value) {
+    std::istringstream stream(text);
+    stream >> value;
+    return !stream.fail() && stream.eof();
+}
+
+template <typename T, size_t N>
+static bool SetField(T& tuning, const TuningField<T> (&fields)[N], const std::string& key, const std::string& value) {
+    for (const TuningField<T>& field : fields) {
+        if (key != field.name)
+            continue;
+        if (field.real)
+            return ParseNumber(value, tuning.*field.real);
+        return ParseNumber(value, tuning.*field.whole);
+    }
+    return false;
+}
+
+// "Item Name.field"; the name must already be in the catalog
+static bool SetItemField(std::vector<Item>& catalog, const std::string& key, const std::string& value) {
+    size_t dot = key.rfind('.');
+    if (dot == std::string::npos)
+        return false;
+    std::string name = key.substr(0, dot);
+    std::string field = key.substr(dot + 1);
+
+    for (Item& item : catalog) {
+        if (item.getName() != name)
+            continue;
+        int damage = item.getDamage();
+        int health = item.getHealth();
+        float damageMultiplier = item.getDamageMultiplier();
+        int price = item.getPrice();
+        int projectiles = item.getProjectiles();
+        float duration = item.getDuration();
+        bool parsed =
+            field == "damage" ? ParseNumber(value, damage) :
+            field == "health" ? ParseNumber(value, health) :
+            field == "damageMultiplier" ? ParseNumber(value, damageMultiplier) :
+            field == "price" ? ParseNumber(value, price) :
+            field == "projectiles" ? ParseNumber(value, projectiles) :
+            field == "duration" ? ParseNumber(value, duration) :
+            false;
+        if (parsed)
+            item = Item(name, damage, health, damageMultiplier, price, projectiles, duration);
+        return parsed;
+    }
+    return false;
+}
+
+TuningFiles::FileVersion TuningFiles::versionOf(const std::string& path) {
+    FileVersion version = {};
+    std::error_code error;
+    version.modified = std::filesystem::last_write_time(path, error);
+    if (error)
+        return version;
+    version.size = std::filesystem::file_size(path, error);
+    version.exists = !error;
+    return version;
+}
+
+TuningFiles::TuningFiles(const std::string& directory) {
+    const std::pair<Section, const char*> names[] = {
+        { Section::Player, "player.cfg" },
+        { Section::Enemy, "enemy.cfg" },
+        { Section::Level, "level.cfg" },
+        { Section::Items, "items.cfg" }
+    };
+    for (const auto& name : names) {
+        Watched file = { name.first, directory + "/" + name.second, FileVersion() };
+        files.push_back(file);
+    }
+}
+
+bool TuningFiles::loadAll() {
+    bool changed = false;
+    for (Watched& file : files) {
+        file.version = versionOf(file.path);
+        if (file.version.exists)
+            changed |= reload(file);
+    }
+    pollClock.restart();
+    return changed;
+}
+
+bool TuningFiles::poll() {
+    if (pollClock.getElapsedTime().asMilliseconds() < POLL_MILLISECONDS)
+        return false;
+    pollClock.restart();
+
+    bool changed = false;
+    for (Watched& file : files) {
+        FileVersion version = versionOf(file.path);
+        if (version == file.version)
+            continue;
+        // A deleted file leaves its last values in place
+        file.version = version;
+        if (version.exists)
+            changed |= reload(file);
+    }
+    return changed;
+}
+
+bool TuningFiles::reload(Watched& file) {
+    std::ifstream input(file.path);
+    if (!input)
+        return false; // Probably mid-save; the next change retries
+
+    // Staged copies; nothing in force is touched until every line has parsed
+    Tuning staged = CurrentTuning();
+    std::vector<Item> stagedItems = ItemCatalog();
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        line = Trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+
+        size_t equals = line.find('=');
+        bool parsed = false;
+        if (equals != std::string::npos) {
+            std::string key = Trim(line.substr(0, equals));
+            std::string value = Trim(line.substr(equals + 1));
+            switch (file.section) {
+            case Section::Player: parsed = SetField(staged.player, PLAYER_FIELDS, key, value); break;
+            case Section::Enemy: parsed = SetField(staged.enemy, ENEMY_FIELDS, key, value); break;
+            case Section::Level: parsed = SetField(staged.level, LEVEL_FIELDS, key, value); break;
+            case Section::Items: parsed = SetItemField(stagedItems, key, value); break;
+            }
+        }
+        if (!parsed) {
+            std::cerr << file.path << ":" << lineNumber << ": not applied, can't read \"" << line << "\"" << std::endl;
+            return false;
+        }
+    }
+
+    if (file.section == Section::Items)
+        EditableItemCatalog() = stagedItems;
+    else
+        CurrentTuning() = staged;
+    std::cout << "Tuning reloaded from " << file.path << std::endl;
+    return true;
+}
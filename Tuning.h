@@ -0,0 +1,107 @@
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+// Balance values read from the files in Tuning/. Each struct is one file and
+// its defaults are the shipped values, so a missing file or key changes nothing.
+struct PlayerTuning {
+    float movementSpeed = 500.0f;
+    float gravity = 10.0f;
+    float dashDistance = 200.0f;
+    float dashTime = 0.1f;
+    float dashCooldown = 0.3f;
+    float throwCooldown = 0.4f;
+    float shurikenSpeed = 900.0f;
+    float shurikenSpread = 120.0f;     // Vertical speed step between shuriken in one volley
+    float knockbackDuration = 0.5f;
+    float knockbackDistance = 200.0f;
+    float knockbackArcHeight = 100.0f;
+};
+
+struct EnemyTuning {
+    float chargeSpeedMultiplier = 4.0f;
+    float chargeDuration = 1.0f;
+    float chargeCooldown = 2.0f;
+    float chargeTelegraphDuration = 1.0f;
+    float hitRotationSpeed = 720.0f;   // Degrees per second
+    float hitBounceHeight = 50.0f;
+    float shootInterval = 2.5f;
+    float projectileSpeed = 300.0f;
+    float projectileLifetime = 4.0f;
+};
+
+// Survivor waves and the performance budget behind them
+struct LevelTuning {
+    int firstWaveSize = 5;
+    int waveSizeGrowth = 3;            // Extra enemies per wave
+    float healthGrowth = 0.2f;         // Extra share of base health per wave
+    float speedGrowth = 0.04f;
+    float maxSpeedScale = 1.6f;
+    float firstSpawnInterval = 1.0f;   // Seconds between arrivals
+    float spawnIntervalDecay = 0.9f;   // Per wave
+    float minSpawnInterval = 0.15f;
+    float waveBreak = 3.0f;
+    float overBudget = 0.9f;           // Load above which the enemy cap is cut
+    float underBudget = 0.6f;          // Load below which it may grow
+};
+
+struct Tuning {
+    PlayerTuning player;
+    EnemyTuning enemy;
+    LevelTuning level;
+};
+
+// The values in force. Only TuningFiles writes them, between ticks.
+const Tuning& GameTuning();
+
+// Watches the tuning files by modification time. A file that changed is
+// parsed on its own into a copy of the current values, and only copied over
+// them once the whole file has parsed, so a half-saved or mistyped file never
+// applies partly. Items are tuned by name, e.g. "Flaming Sword.price = 90".
+class TuningFiles {
+public:
+    static const int POLL_MILLISECONDS = 500;
+
+    explicit TuningFiles(const std::string& directory);
+
+    // Member functions
+    bool loadAll();  // Reads every file now; true if any value changed
+    bool poll();     // Rereads files changed since the last look; at most every POLL_MILLISECONDS
+
+private:
+    enum class Section {
+        Player,
+        Enemy,
+        Level,
+        Items
+    };
+
+    // What a file looked like on the last look. Size is compared too, as two
+    // saves can land within the file system's timestamp resolution.
+    struct FileVersion {
+        std::filesystem::file_time_type modified;
+        std::uintmax_t size;
+        bool exists;
+
+        bool operator==(const FileVersion& other) const = default;
+    };
+
+    struct Watched {
+        Section section;
+        std::string path;
+        FileVersion version;
+    };
+
+    static FileVersion versionOf(const std::string& path);
+
+    bool reload(Watched& file);
+
+    std::vector<Watched> files;
+    sf::Clock pollClock;
+};
+
+#endif // TUNING_H
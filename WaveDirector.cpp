@@ -0,0 +1,232 @@
+#include "WaveDirector.h"
+#include "Tuning.h"
+#include "GameRandom.h"
+#include "Snapshot.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// Budget steering
+const float COST_SMOOTHING = 0.05f;  // Share of each new report in the smoothed cost
+const int CUT_SETTLE_FRAMES = 60;    // Time for the smoothed cost to show the effect of a cut
+const int GROW_SETTLE_FRAMES = 30;
+
+// Placement. The difficulty curve and budget thresholds are in Tuning/level.cfg.
+const float SAFE_DISTANCE = 200.0f;          // Nothing drops in this close to the player
+const float EDGE_MARGIN = 100.0f;
+
+// Same enemies as the campaign rooms; chargers and flyers join in later waves
+const WaveArchetype ARCHETYPES[] = {
+    { WALKER_KIND, 1, 4, 0.5f },
+    { WEAK_WALKER_KIND, 1, 3, 0.5f },
+    { FLYER_KIND, 2, 3, 0.25f },
+    { CHARGER_KIND, 3, 2, 0.75f }
+};
+
+PerformanceBudget::PerformanceBudget(float simSeconds, float renderSeconds)
+    : simBudget(simSeconds), renderBudget(renderSeconds), simCost(0), renderCost(0),
+    cap(START_ENEMIES), settleFrames(0) {}
+
+void PerformanceBudget::report(sf::Time simTime, sf::Time renderTime, int enemiesAlive) {
+    simCost += (simTime.asSeconds() - simCost) * COST_SMOOTHING;
+    renderCost += (renderTime.asSeconds() - renderCost) * COST_SMOOTHING;
+    if (settleFrames > 0) {
+        --settleFrames;
+        return;
+    }
+
+    const LevelTuning& tuning = GameTuning().level;
+    float current = load();
+    if (current > tuning.overBudget && cap > MIN_ENEMIES) {
+        cap = std::max(MIN_ENEMIES, cap * 3 / 4);
+        settleFrames = CUT_SETTLE_FRAMES;
+    }
+    else if (current < tuning.underBudget && enemiesAlive >= cap * 3 / 4 && cap < MAX_ENEMIES) {
+        // Only grow once the enemies fill most of the cap, so the headroom has been measured
+        cap = std::min(MAX_ENEMIES, cap + std::max(1, cap / 16));
+        settleFrames = GROW_SETTLE_FRAMES;
+    }
+}
+
+int PerformanceBudget::enemyCap() const {
+    return cap;
+}
+
+float PerformanceBudget::load() const {
+    return std::max(simCost / simBudget, renderCost / renderBudget);
+}
+
+WaveDirector::WaveDirector()
+    : active(false), waveNumber(0), toSpawn(0), spawnInterval(GameTuning().level.firstSpawnInterval),
+    random(1), phase(WavePhase::Break), phaseElapsed(0), liveEnemies(nullptr), enemyCap(0), spawned(false) {}
+
+WaveDirector::WaveDirector(const WaveDirector& other) : WaveDirector() {
+    *this = other;
+}
+
+WaveDirector& WaveDirector::operator=(const WaveDirector& other) {
+    if (this != &other) {
+        DirectorState state;
+        other.saveState(state);
+        loadState(state, other.arena);
+    }
+    return *this;
+}
+
+void WaveDirector::start(const sf::FloatRect& area) {
+    scripts.clear();
+    active = true;
+    arena = area;
+    waveNumber = 0;
+    toSpawn = 0;
+    random = GameRandom() | 1; // xorshift needs a non-zero state
+    phase = WavePhase::Break;
+    phaseElapsed = 0;
+
+    // Load every archetype's texture now rather than on its first arrival mid-wave
+    for (const WaveArchetype& archetype : ARCHETYPES)
+        EnemyTexture(GetEnemyKind(archetype.kind).textureId);
+}
+
+void WaveDirector::stop() {
+    active = false;
+    waveNumber = 0;
+    scripts.clear();
+}
+
+void WaveDirector::saveState(DirectorState& state) const {
+    state.waveNumber = waveNumber;
+    state.toSpawn = toSpawn;
+    state.spawnInterval = spawnInterval;
+    state.phaseElapsed = phaseElapsed;
+    state.random = random;
+    state.phase = phase;
+    state.active = active;
+}
+
+void WaveDirector::loadState(const DirectorState& state, const sf::FloatRect& area) {
+    // The script is rebuilt from the phase on the next update, when it has the enemies to look at
+    scripts.clear();
+    arena = area;
+    active = state.active;
+    waveNumber = state.waveNumber;
+    toSpawn = state.toSpawn;
+    spawnInterval = state.spawnInterval;
+    phaseElapsed = state.phaseElapsed;
+    random = state.random;
+    phase = state.phase;
+}
+
+bool WaveDirector::update(float deltaTime, std::vector<Enemy>& enemies, const sf::Vector2f& player, int enemyCap) {
+    if (!active)
+        return false;
+
+    // The script reads these while it runs in this update
+    liveEnemies = &enemies;
+    playerPosition = player;
+    this->enemyCap = enemyCap;
+    spawned = false;
+    phaseElapsed += deltaTime;
+    // Nothing waits on it during breaks or while the wave is still arriving
+    if (toSpawn == 0 && enemies.empty())
+        scripts.raise(waveCleared);
+    scripts.update(deltaTime);
+
+    // Started, copied or restored since the last update: carry on from the phase
+    // at the same point in the tick the old script would have woken
+    if (scripts.running() == 0)
+        scripts.start(run());
+    liveEnemies = nullptr;
+    return spawned;
+}
+
+// Runs from the current phase, with phaseElapsed already spent in it. Waits are
+// timed on phaseElapsed rather than the scheduler's clock, so a restored
+// director wakes on exactly the tick the original would have.
+Script WaveDirector::run() {
+    const LevelTuning& tuning = GameTuning().level;
+    for (bool resumed = true;; resumed = false) {
+        switch (phase) {
+        case WavePhase::Break:
+            // The arena starts empty, so every wave, the first included, opens with a breather
+            co_await scripts.until([this, &tuning] { return phaseElapsed >= tuning.waveBreak; });
+            beginWave();
+            enter(toSpawn > 0 ? WavePhase::Arriving : WavePhase::Fighting);
+            break;
+        case WavePhase::Arriving:
+            // One arrival per interval, held back while the enemy cap is full
+            co_await scripts.until([this] { return static_cast<int>(liveEnemies->size()) < enemyCap; });
+            spawn(*liveEnemies, playerPosition);
+            spawned = true;
+            enter(--toSpawn > 0 ? WavePhase::Interval : WavePhase::Fighting);
+            break;
+        case WavePhase::Interval:
+            co_await scripts.until([this] { return phaseElapsed >= spawnInterval; });
+            enter(WavePhase::Arriving);
+            break;
+        case WavePhase::Fighting:
+            // Wave still being fought. A restored script may find it over already, missing this update's raise.
+            if (!resumed || toSpawn > 0 || !liveEnemies->empty())
+                co_await scripts.waitFor(waveCleared);
+            enter(WavePhase::Break);
+            break;
+        }
+    }
+}
+
+void WaveDirector::enter(WavePhase next) {
+    phase = next;
+    phaseElapsed = 0;
+}
+
+bool WaveDirector::isActive() const {
+    return active;
+}
+
+int WaveDirector::wave() const {
+    return active ? waveNumber : 0;
+}
+
+void WaveDirector::beginWave() {
+    const LevelTuning& tuning = GameTuning().level;
+    ++waveNumber;
+    toSpawn = tuning.firstWaveSize + tuning.waveSizeGrowth * (waveNumber - 1);
+    spawnInterval = std::max(tuning.minSpawnInterval, tuning.firstSpawnInterval * std::pow(tuning.spawnIntervalDecay, waveNumber - 1.0f));
+}
+
+void WaveDirector::spawn(std::vector<Enemy>& enemies, const sf::Vector2f& player) {
+    // Weighted pick among the archetypes this wave has unlocked
+    int total = 0;
+    for (const WaveArchetype& archetype : ARCHETYPES) {
+        if (archetype.firstWave <= waveNumber)
+            total += archetype.weight;
+    }
+    int pick = static_cast<int>(nextRandom() % total);
+    const WaveArchetype* chosen = &ARCHETYPES[0];
+    for (const WaveArchetype& archetype : ARCHETYPES) {
+        if (archetype.firstWave > waveNumber)
+            continue;
+        chosen = &archetype;
+        pick -= archetype.weight;
+        if (pick < 0)
+            break;
+    }
+
+    // Somewhere across the arena, but never right on top of the player
+    float x = arena.left + EDGE_MARGIN + nextRandom() % static_cast<sf::Uint32>(arena.width - 2 * EDGE_MARGIN);
+    if (std::abs(x - player.x) < SAFE_DISTANCE)
+        x += x < arena.left + arena.width / 2 ? arena.width / 2 : -arena.width / 2;
+    sf::Vector2f position(x, arena.top + arena.height * chosen->dropHeight);
+
+    const LevelTuning& tuning = GameTuning().level;
+    float healthScale = 1.0f + tuning.healthGrowth * (waveNumber - 1);
+    float speedScale = std::min(tuning.maxSpeedScale, 1.0f + tuning.speedGrowth * (waveNumber - 1));
+    enemies.push_back(Enemy(position, ScaledEnemyKind(chosen->kind, speedScale, healthScale)));
+}
+
+sf::Uint32 WaveDirector::nextRandom() {
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    return random;
+}
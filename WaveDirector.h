@@ -0,0 +1,111 @@
+#ifndef WAVEDIRECTOR_H
+#define WAVEDIRECTOR_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "Enemy.h"
+#include "Script.h"
+
+// One kind of enemy the director can send
+struct WaveArchetype {
+    EnemyKindId kind;   // Scaled up from wave to wave
+    int firstWave;      // Held back until this wave
+    int weight;         // Share of each wave once it is in the mix
+    float dropHeight;   // Fraction of the arena height it enters at
+};
+
+// Where the wave script stands
+enum class WavePhase : sf::Uint8 {
+    Break = 1,   // Breather before the next wave
+    Arriving,    // Next arrival waits for room under the enemy cap
+    Interval,    // Between two arrivals
+    Fighting     // All sent, waiting for the last to go
+};
+
+// Plain copy of the director's state, used by world snapshots
+struct DirectorState {
+    sf::Int32 waveNumber;
+    sf::Int32 toSpawn;
+    float spawnInterval;
+    float phaseElapsed;
+    sf::Uint32 random;
+    WavePhase phase;
+    bool active;
+};
+
+// Caps how many enemies may be alive at once so the game holds its frame
+// rate. Simulation and render costs are smoothed and compared with their own
+// budgets; the worse of the two steers the cap, which is cut sharply when
+// over budget and grown a little at a time while there is headroom and the
+// enemies are actually pressing against it.
+class PerformanceBudget {
+public:
+    static const int MIN_ENEMIES = 8;
+    static const int MAX_ENEMIES = 1000;
+    static const int START_ENEMIES = 64;
+
+    PerformanceBudget(float simSeconds, float renderSeconds);
+
+    // Member functions
+    void report(sf::Time simTime, sf::Time renderTime, int enemiesAlive);
+    int enemyCap() const;
+    float load() const;  // Worse smoothed cost over its budget; 1 is exactly at budget
+
+private:
+    float simBudget;
+    float renderBudget;
+    float simCost;       // Smoothed, in seconds
+    float renderCost;
+    int cap;
+    int settleFrames;    // Reports to wait before the cap may move again
+};
+
+// Survivor mode: endless waves in one arena. Each wave is bigger, tougher and
+// quicker than the last, drawn by weight from the archetype table. A wave's
+// enemies arrive one at a time and only while the cap allows, so a slower
+// machine faces fewer enemies at once rather than a slower game. The pacing
+// is a script, so between arrivals and during breaks it costs a comparison a
+// tick. Only its phase and the time spent in it matter: copies and restored
+// states get a fresh script that picks up there on their next update.
+class WaveDirector {
+public:
+    WaveDirector();
+    WaveDirector(const WaveDirector& other);
+    WaveDirector& operator=(const WaveDirector& other);
+
+    // Member functions
+    void start(const sf::FloatRect& arena);
+    void stop();
+    bool update(float deltaTime, std::vector<Enemy>& enemies, const sf::Vector2f& player, int enemyCap);  // True when enemies were added
+    void saveState(DirectorState& state) const;
+    void loadState(const DirectorState& state, const sf::FloatRect& arena);
+
+    bool isActive() const;
+    int wave() const;  // 0 when inactive
+
+private:
+    Script run();
+    void enter(WavePhase next);
+    void beginWave();
+    void spawn(std::vector<Enemy>& enemies, const sf::Vector2f& player);
+    sf::Uint32 nextRandom();
+
+    bool active;
+    sf::FloatRect arena;
+    int waveNumber;
+    int toSpawn;         // Still to arrive this wave
+    float spawnInterval;
+    sf::Uint32 random;
+    WavePhase phase;
+    float phaseElapsed;       // Seconds in phase; the script's waits are timed on it
+    ScriptEvent waveCleared;  // The last of a fully sent wave is gone
+    ScriptScheduler scripts;
+
+    // Set for the length of each update
+    std::vector<Enemy>* liveEnemies;
+    sf::Vector2f playerPosition;
+    int enemyCap;
+    bool spawned;
+};
+
+#endif // WAVEDIRECTOR_H
@@ -5,32 +5,29 @@
 #include "Weapon.h"
 #include "Enemy.h"
 
-Weapon::Weapon(sf::Texture& texture, const sf::Vector2f& position) : texture(texture) {
-    sprite.setTexture(this->texture);
+Weapon::Weapon(sf::Texture& texture, const sf::Vector2f& position) {
+    sprite.setTexture(texture);
     sprite.setPosition(position);
     isAttacking = false;
 }
 
-void Weapon::draw(sf::RenderWindow& window){
-    window.draw(sprite);
+void Weapon::draw(RenderQueue& queue){
+    queue.submit(RenderLayer::Player, sprite);
 }
 
-void Weapon::update(const sf::Vector2f& playerPosition, float width, bool facingRight, float deltaTime) {
-    static float swingAngle = 0.0f;
+void Weapon::update(const sf::Vector2f& playerPosition, float width, bool facingRight, float deltaTime, bool attackHeld) {
     static const float SWING_SPEED = 540.0f;  // Degrees per second
     static const float START_ANGLE = 0.0f;
     static const float END_ANGLE = 90.0f;
     static const float COOLDOWN_DURATION = 0.5f;
-    static float cooldownTimer = 0.0f;
-    static bool animationInProgress = false;
 
     // Update cooldown timer
     if (cooldownTimer > 0) {
         cooldownTimer -= deltaTime;
     }
 
-    // Detect mouse click
-    bool mousePressed = sf::Mouse::isButtonPressed(sf::Mouse::Left) || sf::Keyboard::isKeyPressed(sf::Keyboard::J) || sf::Keyboard::isKeyPressed(sf::Keyboard::X);
+    // Attack button (mouse, J or X locally)
+    bool mousePressed = attackHeld;
 
     // Handle new or held click
     if (mousePressed && cooldownTimer <= 0.0f) {
@@ -84,6 +81,20 @@ void Weapon::checkCollision(std::vector<Enemy>& enemies, float damage, bool faci
         }
     }
 }
+void Weapon::saveState(WeaponState& state) const {
+    state.swingAngle = swingAngle;
+    state.cooldownTimer = cooldownTimer;
+    state.animationInProgress = animationInProgress;
+    state.isAttacking = isAttacking;
+}
+
+void Weapon::loadState(const WeaponState& state) {
+    swingAngle = state.swingAngle;
+    cooldownTimer = state.cooldownTimer;
+    animationInProgress = state.animationInProgress;
+    isAttacking = state.isAttacking;
+}
+
 sf::FloatRect Weapon::getBounds() {
     return sprite.getGlobalBounds();
 }
\ No newline at end of file
@@ -3,26 +3,41 @@
 
 #include <SFML/Graphics.hpp>
 #include "Enemy.h"
+#include "RenderQueue.h"
 #include <vector>
 
+// Swing state of a weapon, used by world snapshots
+struct WeaponState {
+	float swingAngle;
+	float cooldownTimer;
+	bool animationInProgress;
+	bool isAttacking;
+};
+
 class Weapon
 {
 public:
 	Weapon(sf::Texture& texture, const sf::Vector2f& position);
 
-	void draw(sf::RenderWindow& window);
-	void update(const sf::Vector2f& playerPosition, float width, bool facingRight,float deltaTime);
+	void draw(RenderQueue& queue);
+	void update(const sf::Vector2f& playerPosition, float width, bool facingRight,float deltaTime, bool attackHeld);
 	void checkCollision(std::vector<Enemy>& enemies, float damage, bool facingRight);
 	void setDamageMultiplier(float multiplier);
+	void saveState(WeaponState& state) const;
+	void loadState(const WeaponState& state);
 
 	sf::FloatRect getBounds();
 
 	bool isAttacking;
 private:
 	sf::Sprite sprite;
-	sf::Texture texture;
 	sf::Clock frameClock;
 	float damageMultiplier = 1.0f;
+
+	// Swing state (per weapon, so several can exist at once)
+	float swingAngle = 0.0f;
+	float cooldownTimer = 0.0f;
+	bool animationInProgress = false;
 };
 
 #endif // WEAPON_H
@@ -0,0 +1,7 @@
+#include "World.h"
+
+sf::FloatRect& WorldBounds() {
+    // Per thread, so balance workers can each be in a different level
+    static thread_local sf::FloatRect bounds(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    return bounds;
+}
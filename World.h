@@ -0,0 +1,15 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <SFML/Graphics.hpp>
+
+// Size of the window, and of one screen-sized room
+const float SCREEN_WIDTH = 1280;
+const float SCREEN_HEIGHT = 720;
+
+// Playable area of the current level. Rooms are exactly one screen; streamed
+// levels are many screens wide. Whoever loads a level sets it; enemies,
+// projectiles and the room exits read it.
+sf::FloatRect& WorldBounds();
+
+#endif // WORLD_H
@@ -0,0 +1,185 @@
+#include "WorldStream.h"
+#include "Snapshot.h"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+
+// Small xorshift so chunk generation never touches GameRandom and is the same every visit
+static sf::Uint32 NextRandom(sf::Uint32& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+WorldStream::WorldStream()
+    : seed(0), chunkCount(0), chunkWidth(0), height(0), firstActive(0), lastActive(-1) {}
+
+void WorldStream::reset(sf::Uint32 levelSeed, int chunks, float width, float worldHeight) {
+    seed = levelSeed;
+    chunkCount = chunks;
+    chunkWidth = width;
+    height = worldHeight;
+    firstActive = 0;
+    lastActive = -1;
+    visited.assign(chunkCount, false);
+    frozen.clear();
+}
+
+bool WorldStream::update(const sf::Vector2f& focus, std::vector<Ground>& grounds, std::vector<Enemy>& enemies) {
+    if (!isStreaming())
+        return false;
+
+    int centre = chunkAt(focus.x);
+    int first = std::max(0, centre - ACTIVE_RADIUS);
+    int last = std::min(chunkCount - 1, centre + ACTIVE_RADIUS);
+    if (first == firstActive && last == lastActive) {
+        // Same window: only catch enemies that wandered out of it
+        freeze(enemies);
+        return false;
+    }
+
+    firstActive = first;
+    lastActive = last;
+    freeze(enemies);
+
+    // Geometry is cheap to regenerate, so the loaded set is rebuilt from scratch
+    grounds.clear();
+    for (int chunk = first; chunk <= last; ++chunk)
+        load(chunk, grounds, enemies);
+    return true;
+}
+
+void WorldStream::resume(const sf::Vector2f& focus, std::vector<Ground>& grounds, std::vector<Enemy>& enemies) {
+    int centre = chunkAt(focus.x);
+    firstActive = std::max(0, centre - ACTIVE_RADIUS);
+    lastActive = std::min(chunkCount - 1, centre + ACTIVE_RADIUS);
+    freeze(enemies);
+
+    // The restored enemies stand in for whatever was frozen or still to spawn here.
+    // Anything frozen further out survives, which is as much as a snapshot of the
+    // loaded chunks can promise.
+    grounds.clear();
+    for (int chunk = firstActive; chunk <= lastActive; ++chunk) {
+        frozen.erase(chunk);
+        visited[chunk] = true;
+        load(chunk, grounds, enemies);
+    }
+    for (int chunk = 0; chunk < firstActive; ++chunk)
+        visited[chunk] = true;
+}
+
+bool WorldStream::isStreaming() const {
+    return chunkCount > 0;
+}
+
+sf::FloatRect WorldStream::worldArea() const {
+    return sf::FloatRect(0, 0, chunkCount * chunkWidth, height);
+}
+
+sf::FloatRect WorldStream::activeArea() const {
+    if (firstActive > lastActive)
+        return sf::FloatRect(0, 0, 0, 0);
+    return sf::FloatRect(firstActive * chunkWidth, 0, (lastActive - firstActive + 1) * chunkWidth, height);
+}
+
+int WorldStream::frozenEnemies() const {
+    int total = 0;
+    for (const auto& chunk : frozen)
+        total += static_cast<int>(chunk.second.size());
+    return total;
+}
+
+float WorldStream::chunkLeft(float x) const {
+    return chunkAt(x) * chunkWidth;
+}
+
+int WorldStream::chunkAt(float x) const {
+    int chunk = static_cast<int>(std::floor(x / chunkWidth));
+    return std::max(0, std::min(chunkCount - 1, chunk));
+}
+
+void WorldStream::freeze(std::vector<Enemy>& enemies) {
+    EnemyState state;
+    enemies.erase(std::remove_if(enemies.begin(), enemies.end(), [&](Enemy& enemy) {
+        int chunk = chunkAt(enemy.position().x);
+        if (chunk >= firstActive && chunk <= lastActive)
+            return false;
+        // Dying enemies just finish off-screen
+        if (enemy.isAlive() && !enemy.isDying()) {
+            state = EnemyState();
+            enemy.saveState(state);
+            frozen[chunk].push_back(state);
+        }
+        return true;
+        }), enemies.end());
+}
+
+void WorldStream::load(int chunk, std::vector<Ground>& grounds, std::vector<Enemy>& enemies) {
+    sf::Uint32 random = seed ^ (static_cast<sf::Uint32>(chunk + 1) * 0x9E3779B9u);
+    NextRandom(random);
+    float left = chunk * chunkWidth;
+    float floorY = height * 7 / 8;
+
+    // Floor, with a gap in some chunks. The first and last chunks are always solid,
+    // and a gap never touches a chunk edge, so each chunk starts on firm ground.
+    if (chunk == 0 || chunk == chunkCount - 1 || NextRandom(random) % 3 == 0) {
+        grounds.push_back(Ground(left, floorY, chunkWidth, height));
+    }
+    else {
+        float gap = 120.0f + NextRandom(random) % 100;
+        float gapStart = 200.0f + NextRandom(random) % static_cast<sf::Uint32>(chunkWidth - 400.0f - gap);
+        grounds.push_back(Ground(left, floorY, gapStart, height));
+        grounds.push_back(Ground(left + gapStart + gap, floorY, chunkWidth - gapStart - gap, height));
+    }
+
+    // Up to two floating platforms
+    int platforms = NextRandom(random) % 3;
+    for (int i = 0; i < platforms; ++i) {
+        float width = 200.0f + NextRandom(random) % 200;
+        float x = left + 100.0f + NextRandom(random) % static_cast<sf::Uint32>(chunkWidth - 200.0f - width);
+        float y = height * (0.45f + (NextRandom(random) % 20) / 100.0f);
+        grounds.push_back(Ground(x, y, width, height / 16));
+    }
+
+    // Enemies: the ones frozen here come back, otherwise a first visit spawns fresh ones
+    std::map<int, std::vector<EnemyState>>::iterator stored = frozen.find(chunk);
+    if (stored != frozen.end()) {
+        for (const EnemyState& state : stored->second) {
+            enemies.push_back(Enemy(state.position, Enemy::kindOf(state)));
+            enemies.back().loadState(state);
+        }
+        frozen.erase(stored);
+    }
+    else if (!visited[chunk]) {
+        spawn(chunk, enemies);
+    }
+    visited[chunk] = true;
+}
+
+void WorldStream::spawn(int chunk, std::vector<Enemy>& enemies) const {
+    if (chunk == 0)
+        return; // Let the player find their feet
+
+    // Same mix and stats as the campaign rooms
+    sf::Uint32 random = seed ^ (static_cast<sf::Uint32>(chunk + 1) * 0x85EBCA6Bu);
+    NextRandom(random);
+    int count = 1 + NextRandom(random) % 3;
+    for (int i = 0; i < count; ++i) {
+        float x = chunk * chunkWidth + 200.0f + NextRandom(random) % static_cast<sf::Uint32>(chunkWidth - 400.0f);
+        switch (NextRandom(random) % 4) {
+        case 0:
+            enemies.push_back(Enemy(sf::Vector2f(x, height / 2), WALKER_KIND));
+            break;
+        case 1:
+            enemies.push_back(Enemy(sf::Vector2f(x, height / 2), WEAK_WALKER_KIND));
+            break;
+        case 2:
+            enemies.push_back(Enemy(sf::Vector2f(x, height / 4), FLYER_KIND));
+            break;
+        default:
+            enemies.push_back(Enemy(sf::Vector2f(x, height * 3 / 4), CHARGER_KIND));
+            break;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef WORLDSTREAM_H
+#define WORLDSTREAM_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <map>
+#include "Ground.h"
+#include "Enemy.h"
+
+// A level many screens wide, cut into screen-wide chunks. Only the chunks
+// around the focus (the player) are loaded: their geometry is in the grounds
+// list and their enemies are simulated. Everything else is frozen. Chunk
+// layouts and first spawns are generated from the level seed and the chunk
+// index, so an unloaded chunk costs nothing unless enemies were left in it,
+// in which case only their EnemyStates are kept.
+class WorldStream {
+public:
+    static const int ACTIVE_RADIUS = 1;  // Chunks either side of the focus chunk that are loaded
+
+    WorldStream();
+
+    // Member functions
+    void reset(sf::Uint32 seed, int chunkCount, float chunkWidth, float height);
+    bool update(const sf::Vector2f& focus, std::vector<Ground>& grounds, std::vector<Enemy>& enemies);
+    void resume(const sf::Vector2f& focus, std::vector<Ground>& grounds, std::vector<Enemy>& enemies);
+
+    bool isStreaming() const;
+    sf::FloatRect worldArea() const;   // The whole level
+    sf::FloatRect activeArea() const;  // The loaded chunks
+    int frozenEnemies() const;
+    float chunkLeft(float x) const;
+
+private:
+    int chunkAt(float x) const;
+    void freeze(std::vector<Enemy>& enemies);
+    void load(int chunk, std::vector<Ground>& grounds, std::vector<Enemy>& enemies);
+    void spawn(int chunk, std::vector<Enemy>& enemies) const;
+
+    sf::Uint32 seed;
+    int chunkCount;
+    float chunkWidth;
+    float height;
+    int firstActive;   // Loaded chunk range, inclusive; firstActive > lastActive when nothing is loaded
+    int lastActive;
+    std::vector<bool> visited;                     // Chunks whose first spawns have happened
+    std::map<int, std::vector<EnemyState>> frozen; // Enemies left behind, by chunk
+};
+
+#endif // WORLDSTREAM_H